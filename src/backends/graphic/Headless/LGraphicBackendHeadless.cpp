@@ -0,0 +1,1161 @@
+#include <LLog.h>
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <drm_fourcc.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <string>
+
+#include <LGraphicBackend.h>
+#include <private/LCompositorPrivate.h>
+#include <private/LSeatPrivate.h>
+#include <private/LOutputPrivate.h>
+#include <private/LOutputModePrivate.h>
+#include <private/LTexturePrivate.h>
+
+#include <LTime.h>
+
+using namespace Louvre;
+using namespace std;
+
+#define BKND_NAME "HEADLESS BACKEND"
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+
+/* Default virtual outputs layout if LOUVRE_HEADLESS_OUTPUTS is not set */
+#define HEADLESS_DEFAULT_OUTPUTS "1920x1080@60"
+
+/* Assumed DPI used to report a physical size for virtual outputs */
+#define HEADLESS_DPI 96
+
+/* Maximum number of buffers (triple buffering) */
+#define HEADLESS_MAX_BUFFERS 3
+
+enum OutputRequest
+{
+    NoRequest,
+    ChangeModeRequest,
+    UninitializeRequest
+};
+
+struct Backend
+{
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLConfig config = nullptr;
+    list<LOutput*>connectedOutputs;
+    list<LDMAFormat*>dmaFormats;
+    UInt32 buffersCount = 2;
+    bool hasUnpackSubimage = false;
+    bool hasBGRA = false;
+
+    PFNEGLQUERYWAYLANDBUFFERWL eglQueryWaylandBufferWL = nullptr;
+    PFNEGLCREATEIMAGEKHRPROC eglCreateImageKHR = nullptr;
+    PFNEGLDESTROYIMAGEKHRPROC eglDestroyImageKHR = nullptr;
+    PFNGLEGLIMAGETARGETTEXTURE2DOESPROC glEGLImageTargetTexture2DOES = nullptr;
+
+    // Context of the SHM upload thread, the PBO is only used if it is a GLES 3.0 context
+    EGLContext uploadContext = EGL_NO_CONTEXT;
+    GLuint uploadPBO = 0;
+    PFNGLMAPBUFFERRANGEEXTPROC glMapBufferRange = nullptr;
+    PFNGLUNMAPBUFFEROESPROC glUnmapBuffer = nullptr;
+};
+
+struct OutputMode
+{
+    LSize size;
+
+    // Refresh rate in Hz, 0 means unthrottled
+    Int32 refreshRate;
+    bool preferred;
+};
+
+struct Output
+{
+    string name;
+    LSize physicalSize;
+    list<LOutputMode*>modes;
+    LOutputMode *currentMode = nullptr;
+    LOutputMode *pendingMode = nullptr;
+
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLSurface surfaces[HEADLESS_MAX_BUFFERS];
+    UInt32 buffersCount = 0;
+    UInt32 currentBuffer = 0;
+
+    // Frame each surface was last rendered, 0 if never (buffer age)
+    UInt64 surfaceFrames[HEADLESS_MAX_BUFFERS];
+    UInt64 frame = 0;
+
+    thread renderThread;
+    mutex mtx;
+    condition_variable cond;
+    bool repaintRequested = false;
+    OutputRequest request = NoRequest;
+    bool requestDone = false;
+    bool initialized = false;
+    bool initFailed = false;
+};
+
+struct Texture
+{
+    GLuint id = 0;
+    GLenum target = GL_TEXTURE_2D;
+    EGLImageKHR image = EGL_NO_IMAGE_KHR;
+};
+
+static Backend *backend()
+{
+    return (Backend*)LCompositor::compositor()->imp()->graphicBackendData;
+}
+
+static bool hasExtension(const char *extensions, const char *extension)
+{
+    if (!extensions)
+        return false;
+
+    size_t len = strlen(extension);
+    const char *it = extensions;
+
+    while ((it = strstr(it, extension)))
+    {
+        if ((it == extensions || it[-1] == ' ') && (it[len] == ' ' || it[len] == '\0'))
+            return true;
+
+        it += len;
+    }
+
+    return false;
+}
+
+/* Parses a list of outputs separated by ';', each with a list of modes
+ * separated by ',' e.g. "1920x1080@60,1280x720@60;2560x1440@144".
+ * The first mode of each output is the preferred one. */
+static void parseOutputs(Backend *bknd, LCompositor *compositor, const char *layout)
+{
+    string str = layout;
+    size_t outputStart = 0;
+
+    while (outputStart <= str.size())
+    {
+        size_t outputEnd = str.find(';', outputStart);
+
+        if (outputEnd == string::npos)
+            outputEnd = str.size();
+
+        string outputStr = str.substr(outputStart, outputEnd - outputStart);
+        outputStart = outputEnd + 1;
+
+        LOutput *output = nullptr;
+        Output *bkndOutput = nullptr;
+        size_t modeStart = 0;
+
+        while (modeStart <= outputStr.size())
+        {
+            size_t modeEnd = outputStr.find(',', modeStart);
+
+            if (modeEnd == string::npos)
+                modeEnd = outputStr.size();
+
+            string modeStr = outputStr.substr(modeStart, modeEnd - modeStart);
+            modeStart = modeEnd + 1;
+
+            Int32 w = 0, h = 0, hz = 60;
+
+            if (modeStr.empty())
+                continue;
+
+            if (sscanf(modeStr.c_str(), "%dx%d@%d", &w, &h, &hz) < 2 || w <= 0 || h <= 0 || hz < 0)
+            {
+                LLog::error("[%s] Invalid output mode \"%s\". Ignoring it.", BKND_NAME, modeStr.c_str());
+                continue;
+            }
+
+            if (!output)
+            {
+                output = compositor->createOutputRequest();
+                bkndOutput = new Output();
+                bkndOutput->name = "HEADLESS-" + to_string(bknd->connectedOutputs.size() + 1);
+                bkndOutput->physicalSize.setW((w * 254) / (HEADLESS_DPI * 10));
+                bkndOutput->physicalSize.setH((h * 254) / (HEADLESS_DPI * 10));
+                output->imp()->graphicBackendData = bkndOutput;
+            }
+
+            LOutputMode *outputMode = new LOutputMode(output);
+            OutputMode *bkndOutputMode = new OutputMode();
+            bkndOutputMode->size.setW(w);
+            bkndOutputMode->size.setH(h);
+            bkndOutputMode->refreshRate = hz;
+            bkndOutputMode->preferred = bkndOutput->modes.empty();
+            outputMode->imp()->graphicBackendData = bkndOutputMode;
+            bkndOutput->modes.push_back(outputMode);
+        }
+
+        if (output)
+        {
+            bkndOutput->currentMode = bkndOutput->modes.front();
+            output->imp()->updateRect();
+            bknd->connectedOutputs.push_back(output);
+        }
+    }
+}
+
+static void destroyOutput(LOutput *output)
+{
+    Output *bkndOutput = (Output*)output->imp()->graphicBackendData;
+
+    while (!bkndOutput->modes.empty())
+    {
+        LOutputMode *mode = bkndOutput->modes.back();
+        delete (OutputMode*)mode->imp()->graphicBackendData;
+        delete mode;
+        bkndOutput->modes.pop_back();
+    }
+
+    LCompositor::compositor()->destroyOutputRequest(output);
+    delete output;
+    delete bkndOutput;
+}
+
+static bool createSurfaces(Backend *bknd, Output *bkndOutput)
+{
+    OutputMode *mode = (OutputMode*)bkndOutput->currentMode->imp()->graphicBackendData;
+
+    const EGLint attribs[] =
+    {
+        EGL_WIDTH, mode->size.w(),
+        EGL_HEIGHT, mode->size.h(),
+        EGL_NONE
+    };
+
+    for (UInt32 i = 0; i < bkndOutput->buffersCount; i++)
+    {
+        bkndOutput->surfaces[i] = eglCreatePbufferSurface(bknd->display, bknd->config, attribs);
+
+        if (bkndOutput->surfaces[i] == EGL_NO_SURFACE)
+        {
+            LLog::error("[%s] Failed to create pbuffer surface for output %s.", BKND_NAME, bkndOutput->name.c_str());
+
+            for (UInt32 j = 0; j < i; j++)
+            {
+                eglDestroySurface(bknd->display, bkndOutput->surfaces[j]);
+                bkndOutput->surfaces[j] = EGL_NO_SURFACE;
+            }
+
+            return false;
+        }
+    }
+
+    bkndOutput->currentBuffer = 0;
+    memset(bkndOutput->surfaceFrames, 0, sizeof(bkndOutput->surfaceFrames));
+    return true;
+}
+
+static void destroySurfaces(Backend *bknd, Output *bkndOutput)
+{
+    eglMakeCurrent(bknd->display, EGL_NO_SURFACE, EGL_NO_SURFACE, bkndOutput->context);
+
+    for (UInt32 i = 0; i < bkndOutput->buffersCount; i++)
+    {
+        if (bkndOutput->surfaces[i] != EGL_NO_SURFACE)
+        {
+            eglDestroySurface(bknd->display, bkndOutput->surfaces[i]);
+            bkndOutput->surfaces[i] = EGL_NO_SURFACE;
+        }
+    }
+}
+
+static void makeCurrent(Backend *bknd, Output *bkndOutput)
+{
+    EGLSurface surface = bkndOutput->surfaces[bkndOutput->currentBuffer];
+    eglMakeCurrent(bknd->display, surface, surface, bkndOutput->context);
+}
+
+/* Each virtual output is driven by its own thread, emulating a vblank timer
+ * at the refresh rate of its current mode. */
+static void renderLoop(Backend *bknd, LOutput *output)
+{
+    Output *bkndOutput = (Output*)output->imp()->graphicBackendData;
+
+    static const EGLint contextAttribs[] =
+    {
+        EGL_CONTEXT_CLIENT_VERSION, 2,
+        EGL_NONE
+    };
+
+    bkndOutput->context = eglCreateContext(bknd->display, bknd->config, bknd->context, contextAttribs);
+
+    if (bkndOutput->context == EGL_NO_CONTEXT || !createSurfaces(bknd, bkndOutput))
+    {
+        LLog::error("[%s] Failed to initialize output %s.", BKND_NAME, bkndOutput->name.c_str());
+
+        if (bkndOutput->context != EGL_NO_CONTEXT)
+            eglDestroyContext(bknd->display, bkndOutput->context);
+
+        bkndOutput->context = EGL_NO_CONTEXT;
+        unique_lock<mutex> lock(bkndOutput->mtx);
+        bkndOutput->initFailed = true;
+        bkndOutput->cond.notify_all();
+        return;
+    }
+
+    makeCurrent(bknd, bkndOutput);
+    output->imp()->backendInitializeGL();
+
+    chrono::steady_clock::time_point lastFlip = chrono::steady_clock::now();
+
+    {
+        unique_lock<mutex> lock(bkndOutput->mtx);
+        bkndOutput->initialized = true;
+        bkndOutput->cond.notify_all();
+    }
+
+    while (true)
+    {
+        OutputRequest request;
+
+        {
+            unique_lock<mutex> lock(bkndOutput->mtx);
+
+            bkndOutput->cond.wait(lock, [bkndOutput]{
+                return bkndOutput->repaintRequested || bkndOutput->request != NoRequest;
+            });
+
+            if (bkndOutput->request == NoRequest)
+            {
+                OutputMode *mode = (OutputMode*)bkndOutput->currentMode->imp()->graphicBackendData;
+
+                // Wait for the next virtual vblank
+                if (mode->refreshRate > 0)
+                {
+                    chrono::steady_clock::time_point nextFlip = lastFlip + chrono::nanoseconds(1000000000 / mode->refreshRate);
+
+                    bkndOutput->cond.wait_until(lock, nextFlip, [bkndOutput]{
+                        return bkndOutput->request != NoRequest;
+                    });
+                }
+            }
+
+            request = bkndOutput->request;
+
+            if (request == NoRequest)
+                bkndOutput->repaintRequested = false;
+        }
+
+        if (request == UninitializeRequest)
+        {
+            output->imp()->backendUninitializeGL();
+            destroySurfaces(bknd, bkndOutput);
+            eglMakeCurrent(bknd->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(bknd->display, bkndOutput->context);
+            bkndOutput->context = EGL_NO_CONTEXT;
+
+            unique_lock<mutex> lock(bkndOutput->mtx);
+            bkndOutput->request = NoRequest;
+            bkndOutput->requestDone = true;
+            bkndOutput->cond.notify_all();
+            return;
+        }
+        else if (request == ChangeModeRequest)
+        {
+            LOutputMode *prevMode = bkndOutput->currentMode;
+            destroySurfaces(bknd, bkndOutput);
+            bkndOutput->currentMode = bkndOutput->pendingMode;
+
+            if (!createSurfaces(bknd, bkndOutput))
+            {
+                bkndOutput->currentMode = prevMode;
+                createSurfaces(bknd, bkndOutput);
+            }
+
+            makeCurrent(bknd, bkndOutput);
+            output->imp()->updateRect();
+            output->imp()->backendResizeGL();
+
+            unique_lock<mutex> lock(bkndOutput->mtx);
+            bkndOutput->request = NoRequest;
+            bkndOutput->repaintRequested = true;
+            bkndOutput->requestDone = true;
+            bkndOutput->cond.notify_all();
+            continue;
+        }
+
+        output->imp()->backendPaintGL();
+
+        // Pbuffers have no front buffer, wait for the GPU as a real page flip would
+        glFinish();
+        lastFlip = chrono::steady_clock::now();
+        bkndOutput->surfaceFrames[bkndOutput->currentBuffer] = ++bkndOutput->frame;
+
+        bkndOutput->currentBuffer = (bkndOutput->currentBuffer + 1) % bkndOutput->buffersCount;
+        makeCurrent(bknd, bkndOutput);
+        output->imp()->backendPageFlipped();
+    }
+}
+
+static void sendRequest(Output *bkndOutput, OutputRequest request)
+{
+    unique_lock<mutex> lock(bkndOutput->mtx);
+    bkndOutput->requestDone = false;
+    bkndOutput->request = request;
+    bkndOutput->cond.notify_all();
+    bkndOutput->cond.wait(lock, [bkndOutput]{ return bkndOutput->requestDone; });
+}
+
+UInt32 LGraphicBackend::id()
+{
+    return LGraphicBackendHeadless;
+}
+
+void *LGraphicBackend::getContextHandle()
+{
+    return backend()->display;
+}
+
+bool LGraphicBackend::initialize()
+{
+    LCompositor *compositor = LCompositor::compositor();
+    Backend *bknd = new Backend();
+    compositor->imp()->graphicBackendData = bknd;
+
+    const char *env;
+    const char *clientExtensions;
+    const char *glExtensions;
+    EGLint numConfigs = 0;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC eglGetPlatformDisplayEXT;
+
+    static const EGLint configAttribs[] =
+    {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 0,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+        EGL_NONE
+    };
+
+    static const EGLint contextAttribs[] =
+    {
+        EGL_CONTEXT_CLIENT_VERSION, 2,
+        EGL_NONE
+    };
+
+    env = getenv("LOUVRE_HEADLESS_BUFFERS");
+
+    if (env)
+    {
+        Int32 count = atoi(env);
+
+        if (count >= 1 && count <= HEADLESS_MAX_BUFFERS)
+            bknd->buffersCount = count;
+        else
+            LLog::warning("[%s] Invalid LOUVRE_HEADLESS_BUFFERS value %s. Using %d buffers.", BKND_NAME, env, bknd->buffersCount);
+    }
+
+    clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+
+    if (!hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+    {
+        LLog::error("[%s] EGL_MESA_platform_surfaceless not supported.", BKND_NAME);
+        goto fail;
+    }
+
+    eglGetPlatformDisplayEXT = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    if (!eglGetPlatformDisplayEXT)
+    {
+        LLog::error("[%s] eglGetPlatformDisplayEXT not available.", BKND_NAME);
+        goto fail;
+    }
+
+    bknd->display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+
+    if (bknd->display == EGL_NO_DISPLAY || !eglInitialize(bknd->display, NULL, NULL))
+    {
+        LLog::error("[%s] Failed to initialize surfaceless EGL display.", BKND_NAME);
+        goto fail;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_ES_API))
+    {
+        LLog::error("[%s] Failed to bind EGL_OPENGL_ES_API.", BKND_NAME);
+        goto fail;
+    }
+
+    if (!eglChooseConfig(bknd->display, configAttribs, &bknd->config, 1, &numConfigs) || numConfigs == 0)
+    {
+        LLog::error("[%s] No EGL config with pbuffer support found.", BKND_NAME);
+        goto fail;
+    }
+
+    bknd->context = eglCreateContext(bknd->display, bknd->config, EGL_NO_CONTEXT, contextAttribs);
+
+    if (bknd->context == EGL_NO_CONTEXT)
+    {
+        LLog::error("[%s] Failed to create allocator EGL context.", BKND_NAME);
+        goto fail;
+    }
+
+    eglMakeCurrent(bknd->display, EGL_NO_SURFACE, EGL_NO_SURFACE, bknd->context);
+    glExtensions = (const char*)glGetString(GL_EXTENSIONS);
+    bknd->hasUnpackSubimage = hasExtension(glExtensions, "GL_EXT_unpack_subimage");
+    bknd->hasBGRA = hasExtension(glExtensions, "GL_EXT_texture_format_BGRA8888");
+
+    if (hasExtension(eglQueryString(bknd->display, EGL_EXTENSIONS), "EGL_WL_bind_wayland_display") &&
+        hasExtension(glExtensions, "GL_OES_EGL_image"))
+    {
+        bknd->eglQueryWaylandBufferWL = (PFNEGLQUERYWAYLANDBUFFERWL)eglGetProcAddress("eglQueryWaylandBufferWL");
+        bknd->eglCreateImageKHR = (PFNEGLCREATEIMAGEKHRPROC)eglGetProcAddress("eglCreateImageKHR");
+        bknd->eglDestroyImageKHR = (PFNEGLDESTROYIMAGEKHRPROC)eglGetProcAddress("eglDestroyImageKHR");
+        bknd->glEGLImageTargetTexture2DOES = (PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)eglGetProcAddress("glEGLImageTargetTexture2DOES");
+    }
+
+    env = getenv("LOUVRE_HEADLESS_OUTPUTS");
+    parseOutputs(bknd, compositor, env ? env : HEADLESS_DEFAULT_OUTPUTS);
+
+    if (bknd->connectedOutputs.empty())
+    {
+        LLog::error("[%s] No valid outputs defined in LOUVRE_HEADLESS_OUTPUTS.", BKND_NAME);
+        goto fail;
+    }
+
+    LLog::debug("[%s] Initialized with %d outputs and %d buffers.", BKND_NAME, (Int32)bknd->connectedOutputs.size(), bknd->buffersCount);
+    return true;
+
+    fail:
+    if (bknd->context != EGL_NO_CONTEXT)
+    {
+        eglMakeCurrent(bknd->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(bknd->display, bknd->context);
+    }
+
+    if (bknd->display != EGL_NO_DISPLAY)
+        eglTerminate(bknd->display);
+
+    compositor->imp()->graphicBackendData = nullptr;
+    delete bknd;
+    return false;
+}
+
+void LGraphicBackend::uninitialize()
+{
+    LCompositor *compositor = LCompositor::compositor();
+    Backend *bknd = backend();
+
+    while (!bknd->connectedOutputs.empty())
+    {
+        destroyOutput(bknd->connectedOutputs.back());
+        bknd->connectedOutputs.pop_back();
+    }
+
+    eglMakeCurrent(bknd->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(bknd->display, bknd->context);
+    eglTerminate(bknd->display);
+    compositor->imp()->graphicBackendData = nullptr;
+    delete bknd;
+}
+
+void LGraphicBackend::pause()
+{
+    /* Nothing to do, there is no session to release */
+}
+
+void LGraphicBackend::resume()
+{
+    for (LOutput *output : backend()->connectedOutputs)
+        scheduleOutputRepaint(output);
+}
+
+const list<LOutput*> *LGraphicBackend::getConnectedOutputs()
+{
+    return &backend()->connectedOutputs;
+}
+
+UInt32 LGraphicBackend::rendererGPUs()
+{
+    return 1;
+}
+
+bool LGraphicBackend::initializeOutput(LOutput *output)
+{
+    Backend *bknd = backend();
+    Output *bkndOutput = (Output*)output->imp()->graphicBackendData;
+
+    bkndOutput->buffersCount = bknd->buffersCount;
+    bkndOutput->initialized = false;
+    bkndOutput->initFailed = false;
+    bkndOutput->request = NoRequest;
+    bkndOutput->repaintRequested = true;
+
+    for (UInt32 i = 0; i < HEADLESS_MAX_BUFFERS; i++)
+        bkndOutput->surfaces[i] = EGL_NO_SURFACE;
+
+    bkndOutput->renderThread = thread(renderLoop, bknd, output);
+
+    // Block until backendInitializeGL() is done, as the DRM backend does
+    unique_lock<mutex> lock(bkndOutput->mtx);
+    bkndOutput->cond.wait(lock, [bkndOutput]{ return bkndOutput->initialized || bkndOutput->initFailed; });
+
+    if (bkndOutput->initFailed)
+    {
+        lock.unlock();
+        bkndOutput->renderThread.join();
+        return false;
+    }
+
+    return true;
+}
+
+bool LGraphicBackend::scheduleOutputRepaint(LOutput *output)
+{
+    Output *bkndOutput = (Output*)output->imp()->graphicBackendData;
+    unique_lock<mutex> lock(bkndOutput->mtx);
+
+    if (!bkndOutput->initialized)
+        return false;
+
+    bkndOutput->repaintRequested = true;
+    bkndOutput->cond.notify_all();
+    return true;
+}
+
+void LGraphicBackend::uninitializeOutput(LOutput *output)
+{
+    Output *bkndOutput = (Output*)output->imp()->graphicBackendData;
+
+    {
+        unique_lock<mutex> lock(bkndOutput->mtx);
+
+        if (!bkndOutput->initialized)
+            return;
+    }
+
+    sendRequest(bkndOutput, UninitializeRequest);
+    bkndOutput->renderThread.join();
+    bkndOutput->initialized = false;
+}
+
+bool LGraphicBackend::hasBufferDamageSupport(LOutput *output)
+{
+    L_UNUSED(output);
+    return false;
+}
+
+void LGraphicBackend::setOutputBufferDamage(LOutput *output, LRegion &region)
+{
+    L_UNUSED(output);
+    L_UNUSED(region);
+}
+
+const LSize *LGraphicBackend::getOutputPhysicalSize(LOutput *output)
+{
+    Output *bkndOutput = (Output*)output->imp()->graphicBackendData;
+    return &bkndOutput->physicalSize;
+}
+
+Int32 LGraphicBackend::getOutputCurrentBufferIndex(LOutput *output)
+{
+    Output *bkndOutput = (Output*)output->imp()->graphicBackendData;
+    return bkndOutput->currentBuffer;
+}
+
+UInt32 LGraphicBackend::getOutputBuffersCount(LOutput *output)
+{
+    Output *bkndOutput = (Output*)output->imp()->graphicBackendData;
+    return bkndOutput->buffersCount;
+}
+
+Int32 LGraphicBackend::getOutputBufferAge(LOutput *output)
+{
+    Output *bkndOutput = (Output*)output->imp()->graphicBackendData;
+    const UInt64 lastFrame = bkndOutput->surfaceFrames[bkndOutput->currentBuffer];
+    return lastFrame == 0 ? 0 : bkndOutput->frame + 1 - lastFrame;
+}
+
+LTexture *LGraphicBackend::getOutputBuffer(LOutput *output, UInt32 bufferIndex)
+{
+    /* Pbuffers can not be sampled without EGL_BIND_TO_TEXTURE_RGBA support */
+    L_UNUSED(output);
+    L_UNUSED(bufferIndex);
+    return nullptr;
+}
+
+const char *LGraphicBackend::getOutputName(LOutput *output)
+{
+    Output *bkndOutput = (Output*)output->imp()->graphicBackendData;
+    return bkndOutput->name.c_str();
+}
+
+const char *LGraphicBackend::getOutputManufacturerName(LOutput *output)
+{
+    L_UNUSED(output);
+    return "Louvre";
+}
+
+const char *LGraphicBackend::getOutputModelName(LOutput *output)
+{
+    L_UNUSED(output);
+    return "Headless";
+}
+
+const char *LGraphicBackend::getOutputDescription(LOutput *output)
+{
+    L_UNUSED(output);
+    return "Virtual headless output";
+}
+
+const LOutputMode *LGraphicBackend::getOutputPreferredMode(LOutput *output)
+{
+    Output *bkndOutput = (Output*)output->imp()->graphicBackendData;
+    return bkndOutput->modes.front();
+}
+
+const LOutputMode *LGraphicBackend::getOutputCurrentMode(LOutput *output)
+{
+    Output *bkndOutput = (Output*)output->imp()->graphicBackendData;
+    return bkndOutput->currentMode;
+}
+
+const std::list<LOutputMode *> *LGraphicBackend::getOutputModes(LOutput *output)
+{
+    Output *bkndOutput = (Output*)output->imp()->graphicBackendData;
+    return &bkndOutput->modes;
+}
+
+bool LGraphicBackend::setOutputMode(LOutput *output, LOutputMode *mode)
+{
+    Output *bkndOutput = (Output*)output->imp()->graphicBackendData;
+
+    if (bkndOutput->currentMode == mode)
+        return true;
+
+    if (!bkndOutput->initialized)
+    {
+        bkndOutput->currentMode = mode;
+        output->imp()->updateRect();
+        return true;
+    }
+
+    bkndOutput->pendingMode = mode;
+    sendRequest(bkndOutput, ChangeModeRequest);
+    return bkndOutput->currentMode == mode;
+}
+
+const LSize *LGraphicBackend::getOutputModeSize(LOutputMode *mode)
+{
+    OutputMode *bkndOutputMode = (OutputMode*)mode->imp()->graphicBackendData;
+    return &bkndOutputMode->size;
+}
+
+Int32 LGraphicBackend::getOutputModeRefreshRate(LOutputMode *mode)
+{
+    OutputMode *bkndOutputMode = (OutputMode*)mode->imp()->graphicBackendData;
+    return bkndOutputMode->refreshRate * 1000;
+}
+
+bool LGraphicBackend::getOutputModeIsPreferred(LOutputMode *mode)
+{
+    OutputMode *bkndOutputMode = (OutputMode*)mode->imp()->graphicBackendData;
+    return bkndOutputMode->preferred;
+}
+
+bool LGraphicBackend::hasHardwareCursorSupport(LOutput *output)
+{
+    L_UNUSED(output);
+    return false;
+}
+
+void LGraphicBackend::setCursorTexture(LOutput *output, UChar8 *buffer)
+{
+    L_UNUSED(output);
+    L_UNUSED(buffer);
+}
+
+void LGraphicBackend::setCursorPosition(LOutput *output, const LPoint &position)
+{
+    L_UNUSED(output);
+    L_UNUSED(position);
+}
+
+const list<LDMAFormat*> *LGraphicBackend::getDMAFormats()
+{
+    /* DMA buffers are not supported, clients fall back to shared memory */
+    return &backend()->dmaFormats;
+}
+
+EGLDisplay LGraphicBackend::getAllocatorEGLDisplay()
+{
+    return backend()->display;
+}
+
+EGLContext LGraphicBackend::getAllocatorEGLContext()
+{
+    return backend()->context;
+}
+
+static bool glFormatFromDRM(UInt32 format, GLenum *glFormat)
+{
+    switch (format)
+    {
+    case DRM_FORMAT_ARGB8888:
+    case DRM_FORMAT_XRGB8888:
+        if (!backend()->hasBGRA)
+            return false;
+        *glFormat = GL_BGRA_EXT;
+        return true;
+    case DRM_FORMAT_ABGR8888:
+    case DRM_FORMAT_XBGR8888:
+        *glFormat = GL_RGBA;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Copies the rows to a PBO so that the driver can transfer them asynchronously,
+ * only used by the upload thread */
+static bool uploadPixelsPBO(GLenum glFormat, UInt32 stride, const LRect &dst, const UChar8 *src)
+{
+    Backend *bknd = backend();
+    const UInt32 rowSize = dst.w() * 4;
+    const GLsizeiptr size = rowSize * dst.h();
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, bknd->uploadPBO);
+
+    // Orphans the previous storage, which may still be in use
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+    UChar8 *map = (UChar8*)bknd->glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT_EXT | GL_MAP_INVALIDATE_BUFFER_BIT_EXT);
+
+    if (!map)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    if (stride == rowSize)
+        memcpy(map, src, size);
+    else
+    {
+        for (Int32 y = 0; y < dst.h(); y++)
+            memcpy(&map[y * rowSize], &src[y * stride], rowSize);
+    }
+
+    bknd->glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, dst.x(), dst.y(), dst.w(), dst.h(), glFormat, GL_UNSIGNED_BYTE, NULL);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+
+static void uploadPixels(GLenum glFormat, UInt32 stride, const LRect &dst, const void *pixels, bool allocate)
+{
+    Backend *bknd = backend();
+    const UChar8 *src = (const UChar8*)pixels;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (allocate)
+        glTexImage2D(GL_TEXTURE_2D, 0, glFormat, dst.w(), dst.h(), 0, glFormat, GL_UNSIGNED_BYTE, NULL);
+
+    if (bknd->uploadPBO && eglGetCurrentContext() == bknd->uploadContext && uploadPixelsPBO(glFormat, stride, dst, src))
+    {
+        glFlush();
+        return;
+    }
+
+    if (stride == (UInt32)dst.w() * 4)
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, dst.x(), dst.y(), dst.w(), dst.h(), glFormat, GL_UNSIGNED_BYTE, src);
+    }
+    else if (bknd->hasUnpackSubimage)
+    {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, stride / 4);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, dst.x(), dst.y(), dst.w(), dst.h(), glFormat, GL_UNSIGNED_BYTE, src);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, 0);
+    }
+    else
+    {
+        for (Int32 y = 0; y < dst.h(); y++)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, dst.x(), dst.y() + y, dst.w(), 1, glFormat, GL_UNSIGNED_BYTE, &src[y * stride]);
+    }
+
+    // Make the texture visible to output contexts
+    glFlush();
+}
+
+bool LGraphicBackend::createTextureFromCPUBuffer(LTexture *texture, const LSize &size, UInt32 stride, UInt32 format, const void *pixels)
+{
+    GLenum glFormat;
+
+    if (!glFormatFromDRM(format, &glFormat))
+    {
+        LLog::error("[%s] Unsupported CPU buffer format.", BKND_NAME);
+        return false;
+    }
+
+    Texture *bkndTexture = new Texture();
+    glGenTextures(1, &bkndTexture->id);
+
+    if (!bkndTexture->id)
+    {
+        delete bkndTexture;
+        return false;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, bkndTexture->id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    uploadPixels(glFormat, stride, LRect(0, size), pixels, true);
+    texture->imp()->graphicBackendData = bkndTexture;
+    return true;
+}
+
+bool LGraphicBackend::createTextureFromWaylandDRM(LTexture *texture, void *wlBuffer)
+{
+    Backend *bknd = backend();
+
+    if (!bknd->eglQueryWaylandBufferWL || !bknd->eglCreateImageKHR || !bknd->glEGLImageTargetTexture2DOES)
+        return false;
+
+    EGLint width, height, textureFormat;
+
+    if (!bknd->eglQueryWaylandBufferWL(bknd->display, (wl_resource*)wlBuffer, EGL_WIDTH, &width) ||
+        !bknd->eglQueryWaylandBufferWL(bknd->display, (wl_resource*)wlBuffer, EGL_HEIGHT, &height) ||
+        !bknd->eglQueryWaylandBufferWL(bknd->display, (wl_resource*)wlBuffer, EGL_TEXTURE_FORMAT, &textureFormat))
+        return false;
+
+    static const EGLint imageAttribs[] =
+    {
+        EGL_WAYLAND_PLANE_WL, 0,
+        EGL_NONE
+    };
+
+    Texture *bkndTexture = new Texture();
+    bkndTexture->image = bknd->eglCreateImageKHR(bknd->display, EGL_NO_CONTEXT, EGL_WAYLAND_BUFFER_WL, (EGLClientBuffer)wlBuffer, imageAttribs);
+
+    if (bkndTexture->image == EGL_NO_IMAGE_KHR)
+    {
+        delete bkndTexture;
+        return false;
+    }
+
+    glGenTextures(1, &bkndTexture->id);
+    glBindTexture(GL_TEXTURE_2D, bkndTexture->id);
+    bknd->glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, bkndTexture->image);
+    glFlush();
+
+    texture->imp()->graphicBackendData = bkndTexture;
+    texture->imp()->format = textureFormat == EGL_TEXTURE_RGB ? DRM_FORMAT_XRGB8888 : DRM_FORMAT_ARGB8888;
+    texture->imp()->sizeB.setW(width);
+    texture->imp()->sizeB.setH(height);
+    return true;
+}
+
+bool LGraphicBackend::createTextureFromDMA(LTexture *texture, const LDMAPlanes *planes)
+{
+    L_UNUSED(texture);
+    L_UNUSED(planes);
+    return false;
+}
+
+bool LGraphicBackend::updateTextureRect(LTexture *texture, UInt32 stride, const LRect &dst, const void *pixels)
+{
+    Texture *bkndTexture = (Texture*)texture->imp()->graphicBackendData;
+    GLenum glFormat;
+
+    if (bkndTexture->image != EGL_NO_IMAGE_KHR || !glFormatFromDRM(texture->format(), &glFormat))
+        return false;
+
+    Backend *bknd = backend();
+    glBindTexture(GL_TEXTURE_2D, bkndTexture->id);
+
+    /* Without GL_EXT_unpack_subimage, rects narrower than the buffer are uploaded row by row,
+     * while full width rows are contiguous and uploaded with a single call */
+    if (!bknd->hasUnpackSubimage && dst.h() > 1 && stride != (UInt32)dst.w() * 4 && stride == (UInt32)texture->sizeB().w() * 4 &&
+        !(bknd->uploadPBO && eglGetCurrentContext() == bknd->uploadContext))
+    {
+        const UChar8 *rows = (const UChar8*)pixels - dst.x() * 4;
+        uploadPixels(glFormat, stride, LRect(0, dst.y(), texture->sizeB().w(), dst.h()), rows, false);
+        return true;
+    }
+
+    uploadPixels(glFormat, stride, dst, pixels, false);
+    return true;
+}
+
+bool LGraphicBackend::initializeUploadContext()
+{
+    Backend *bknd = backend();
+    bool gles3 = true;
+
+    static const EGLint gles3Attribs[] =
+    {
+        EGL_CONTEXT_CLIENT_VERSION, 3,
+        EGL_NONE
+    };
+
+    static const EGLint gles2Attribs[] =
+    {
+        EGL_CONTEXT_CLIENT_VERSION, 2,
+        EGL_NONE
+    };
+
+    bknd->uploadContext = eglCreateContext(bknd->display, bknd->config, bknd->context, gles3Attribs);
+
+    if (bknd->uploadContext == EGL_NO_CONTEXT)
+    {
+        gles3 = false;
+        bknd->uploadContext = eglCreateContext(bknd->display, bknd->config, bknd->context, gles2Attribs);
+    }
+
+    if (bknd->uploadContext == EGL_NO_CONTEXT)
+    {
+        LLog::error("[%s] Failed to create upload EGL context.", BKND_NAME);
+        return false;
+    }
+
+    if (!eglMakeCurrent(bknd->display, EGL_NO_SURFACE, EGL_NO_SURFACE, bknd->uploadContext))
+    {
+        LLog::error("[%s] Failed to make the upload EGL context current.", BKND_NAME);
+        eglDestroyContext(bknd->display, bknd->uploadContext);
+        bknd->uploadContext = EGL_NO_CONTEXT;
+        return false;
+    }
+
+    if (gles3)
+    {
+        bknd->glMapBufferRange = (PFNGLMAPBUFFERRANGEEXTPROC)eglGetProcAddress("glMapBufferRange");
+        bknd->glUnmapBuffer = (PFNGLUNMAPBUFFEROESPROC)eglGetProcAddress("glUnmapBuffer");
+
+        if (bknd->glMapBufferRange && bknd->glUnmapBuffer)
+            glGenBuffers(1, &bknd->uploadPBO);
+    }
+
+    LLog::debug("[%s] Upload context initialized (%s).", BKND_NAME, bknd->uploadPBO ? "GLES 3.0 with PBO" : "GLES 2.0");
+    return true;
+}
+
+void LGraphicBackend::uninitializeUploadContext()
+{
+    Backend *bknd = backend();
+
+    if (bknd->uploadContext == EGL_NO_CONTEXT)
+        return;
+
+    if (bknd->uploadPBO)
+    {
+        glDeleteBuffers(1, &bknd->uploadPBO);
+        bknd->uploadPBO = 0;
+    }
+
+    eglMakeCurrent(bknd->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(bknd->display, bknd->uploadContext);
+    bknd->uploadContext = EGL_NO_CONTEXT;
+}
+
+UInt32 LGraphicBackend::getTextureID(LOutput *output, LTexture *texture)
+{
+    /* All contexts share the same textures */
+    L_UNUSED(output);
+    Texture *bkndTexture = (Texture*)texture->imp()->graphicBackendData;
+    return bkndTexture->id;
+}
+
+GLenum LGraphicBackend::getTextureTarget(LTexture *texture)
+{
+    Texture *bkndTexture = (Texture*)texture->imp()->graphicBackendData;
+    return bkndTexture->target;
+}
+
+void LGraphicBackend::destroyTexture(LTexture *texture)
+{
+    Texture *bkndTexture = (Texture*)texture->imp()->graphicBackendData;
+
+    if (!bkndTexture)
+        return;
+
+    Backend *bknd = backend();
+
+    if (bkndTexture->id)
+        glDeleteTextures(1, &bkndTexture->id);
+
+    if (bkndTexture->image != EGL_NO_IMAGE_KHR && bknd->eglDestroyImageKHR)
+        bknd->eglDestroyImageKHR(bknd->display, bkndTexture->image);
+
+    delete bkndTexture;
+}
+
+static LGraphicBackendInterface API;
+
+extern "C" LGraphicBackendInterface *getAPI()
+{
+    API.id = &LGraphicBackend::id;
+    API.getContextHandle = &LGraphicBackend::getContextHandle;
+    API.initialize = &LGraphicBackend::initialize;
+    API.pause = &LGraphicBackend::pause;
+    API.resume = &LGraphicBackend::resume;
+    API.scheduleOutputRepaint = &LGraphicBackend::scheduleOutputRepaint;
+    API.uninitialize = &LGraphicBackend::uninitialize;
+    API.getConnectedOutputs = &LGraphicBackend::getConnectedOutputs;
+    API.rendererGPUs = &LGraphicBackend::rendererGPUs;
+    API.initializeOutput = &LGraphicBackend::initializeOutput;
+    API.uninitializeOutput = &LGraphicBackend::uninitializeOutput;
+    API.hasBufferDamageSupport = &LGraphicBackend::hasBufferDamageSupport;
+    API.setOutputBufferDamage = &LGraphicBackend::setOutputBufferDamage;
+    API.getOutputPhysicalSize = &LGraphicBackend::getOutputPhysicalSize;
+    API.getOutputCurrentBufferIndex = &LGraphicBackend::getOutputCurrentBufferIndex;
+    API.getOutputBuffersCount = &LGraphicBackend::getOutputBuffersCount;
+    API.getOutputBuffer = &LGraphicBackend::getOutputBuffer;
+    API.getOutputName = &LGraphicBackend::getOutputName;
+    API.getOutputManufacturerName = &LGraphicBackend::getOutputManufacturerName;
+    API.getOutputModelName = &LGraphicBackend::getOutputModelName;
+    API.getOutputDescription = &LGraphicBackend::getOutputDescription;
+    API.getOutputPreferredMode = &LGraphicBackend::getOutputPreferredMode;
+    API.getOutputCurrentMode = &LGraphicBackend::getOutputCurrentMode;
+    API.getOutputModes = &LGraphicBackend::getOutputModes;
+    API.setOutputMode = &LGraphicBackend::setOutputMode;
+    API.getOutputModeSize = &LGraphicBackend::getOutputModeSize;
+    API.getOutputModeRefreshRate = &LGraphicBackend::getOutputModeRefreshRate;
+    API.getOutputModeIsPreferred = &LGraphicBackend::getOutputModeIsPreferred;
+    API.hasHardwareCursorSupport = &LGraphicBackend::hasHardwareCursorSupport;
+    API.setCursorTexture = &LGraphicBackend::setCursorTexture;
+    API.setCursorPosition = &LGraphicBackend::setCursorPosition;
+
+    // Buffers
+    API.getDMAFormats = &LGraphicBackend::getDMAFormats;
+    API.getAllocatorEGLDisplay = &LGraphicBackend::getAllocatorEGLDisplay;
+    API.getAllocatorEGLContext = &LGraphicBackend::getAllocatorEGLContext;
+    API.createTextureFromCPUBuffer = &LGraphicBackend::createTextureFromCPUBuffer;
+    API.createTextureFromWaylandDRM = &LGraphicBackend::createTextureFromWaylandDRM;
+    API.createTextureFromDMA = &LGraphicBackend::createTextureFromDMA;
+    API.updateTextureRect = &LGraphicBackend::updateTextureRect;
+    API.getTextureID = &LGraphicBackend::getTextureID;
+    API.getTextureTarget = &LGraphicBackend::getTextureTarget;
+    API.destroyTexture = &LGraphicBackend::destroyTexture;
+
+    // Optional
+    API.getOutputBufferAge = &LGraphicBackend::getOutputBufferAge;
+    API.initializeUploadContext = &LGraphicBackend::initializeUploadContext;
+    API.uninitializeUploadContext = &LGraphicBackend::uninitializeUploadContext;
+
+    return &API;
+}
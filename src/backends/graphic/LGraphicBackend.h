@@ -32,6 +32,9 @@ public:
     static const LSize *getOutputPhysicalSize(LOutput *output);
     static Int32 getOutputCurrentBufferIndex(LOutput *output);
     static UInt32 getOutputBuffersCount(LOutput *output);
+
+    /* Optional, if not provided Louvre tracks it from the buffer indices */
+    static Int32 getOutputBufferAge(LOutput *output);
     static LTexture *getOutputBuffer(LOutput *output, UInt32 bufferIndex);
     static const char *getOutputName(LOutput *output);
     static const char *getOutputManufacturerName(LOutput *output);
@@ -77,6 +80,12 @@ public:
                                   const LRect &dst,
                                   const void *pixels);
 
+    /* Optional, called from the SHM upload thread to make current a context sharing
+     * textures with the allocator context, createTextureFromCPUBuffer() and updateTextureRect()
+     * are then also called from it. If not provided uploads are done by the main thread */
+    static bool initializeUploadContext();
+    static void uninitializeUploadContext();
+
     static UInt32 getTextureID(LOutput *output, LTexture *texture);
     static GLenum getTextureTarget(LTexture *texture);
 
@@ -0,0 +1,102 @@
+#ifndef LINPUTTRACE
+#define LINPUTTRACE
+
+#include <LNamespaces.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Input traces are recorded by the Libinput backend (LOUVRE_INPUT_RECORD)
+ * and replayed by the Scripted backend (LOUVRE_INPUT_TRACE).
+ *
+ * Binary traces start with LINPUT_TRACE_MAGIC followed by a UInt32 version
+ * and a sequence of LInputTraceEvent structs in native byte order.
+ *
+ * JSON traces contain one event object per line, e.g:
+ *
+ * {"t":0,"type":"motion","x":1.5,"y":-2,"absolute":0}
+ * {"t":8000,"type":"button","code":272,"state":1}
+ * {"t":9000,"type":"axis","x":0,"y":15,"dx":0,"dy":120,"source":0}
+ * {"t":12000,"type":"key","code":30,"state":1}
+ *
+ * Timestamps (t) are in microseconds relative to the first event. */
+
+#define LINPUT_TRACE_MAGIC "LITRACE"
+#define LINPUT_TRACE_VERSION 1
+
+namespace Louvre
+{
+    enum LInputTraceEventType : UInt32
+    {
+        LInputTracePointerMotion = 0,
+        LInputTracePointerButton = 1,
+        LInputTracePointerAxis = 2,
+        LInputTraceKeyboardKey = 3
+    };
+
+    struct LInputTraceEvent
+    {
+        // Microseconds since the first event
+        UInt64 time;
+        UInt32 type;
+
+        // Button or key code, absolute flag for motion, axis source for axis events
+        UInt32 code;
+
+        // Key or button state
+        UInt32 state;
+
+        // Motion: x, y - Axis: axisX, axisY, discreteX, discreteY
+        Float32 values[4];
+    };
+
+    static inline const char *inputTraceEventTypeName(UInt32 type)
+    {
+        switch (type)
+        {
+        case LInputTracePointerMotion:
+            return "motion";
+        case LInputTracePointerButton:
+            return "button";
+        case LInputTracePointerAxis:
+            return "axis";
+        case LInputTraceKeyboardKey:
+            return "key";
+        default:
+            return "unknown";
+        }
+    }
+
+    static inline bool inputTraceWriteHeader(FILE *file, bool json)
+    {
+        if (json)
+            return true;
+
+        UInt32 version = LINPUT_TRACE_VERSION;
+        return fwrite(LINPUT_TRACE_MAGIC, 1, sizeof(LINPUT_TRACE_MAGIC), file) == sizeof(LINPUT_TRACE_MAGIC) &&
+               fwrite(&version, sizeof(version), 1, file) == 1;
+    }
+
+    static inline bool inputTraceWriteEvent(FILE *file, bool json, const LInputTraceEvent &event)
+    {
+        if (!json)
+            return fwrite(&event, sizeof(event), 1, file) == 1;
+
+        switch (event.type)
+        {
+        case LInputTracePointerMotion:
+            return fprintf(file, "{\"t\":%llu,\"type\":\"motion\",\"x\":%g,\"y\":%g,\"absolute\":%u}\n",
+                           (unsigned long long)event.time, event.values[0], event.values[1], event.code) > 0;
+        case LInputTracePointerButton:
+        case LInputTraceKeyboardKey:
+            return fprintf(file, "{\"t\":%llu,\"type\":\"%s\",\"code\":%u,\"state\":%u}\n",
+                           (unsigned long long)event.time, inputTraceEventTypeName(event.type), event.code, event.state) > 0;
+        case LInputTracePointerAxis:
+            return fprintf(file, "{\"t\":%llu,\"type\":\"axis\",\"x\":%g,\"y\":%g,\"dx\":%g,\"dy\":%g,\"source\":%u}\n",
+                           (unsigned long long)event.time, event.values[0], event.values[1], event.values[2], event.values[3], event.code) > 0;
+        default:
+            return false;
+        }
+    }
+}
+
+#endif // LINPUTTRACE
@@ -2,6 +2,7 @@
 #include <private/LSeatPrivate.h>
 #include <private/LKeyboardPrivate.h>
 #include <LInputBackend.h>
+#include <LInputTrace.h>
 #include <LLog.h>
 #include <unordered_map>
 #include <cstring>
@@ -23,6 +24,18 @@ struct BACKEND_DATA
     libinput_interface libinputInterface;
     LSeat *seat;
     std::list<DEVICE_FD_ID> devices;
+
+    // Recorder mode (LOUVRE_INPUT_RECORD)
+    FILE *recordFile = nullptr;
+    bool recordJSON = false;
+    bool recordStarted = false;
+    UInt64 recordStartTime = 0;
+
+    // Relative motion coalescing (LOUVRE_INPUT_COALESCE_MOTION)
+    bool coalesceMotion = false;
+    bool pendingMotion = false;
+    Float32 pendingDx = 0.f;
+    Float32 pendingDy = 0.f;
 };
 
 // Libseat devices
@@ -99,6 +112,77 @@ static void closeRestricted(int fd, void *data)
     close(fd);
 }
 
+static void initRecorder(BACKEND_DATA *data)
+{
+    const char *path = getenv("LOUVRE_INPUT_RECORD");
+
+    if (!path)
+        return;
+
+    size_t len = strlen(path);
+    data->recordJSON = len > 5 && strcmp(&path[len - 5], ".json") == 0;
+    data->recordFile = fopen(path, data->recordJSON ? "w" : "wb");
+
+    if (!data->recordFile || !inputTraceWriteHeader(data->recordFile, data->recordJSON))
+    {
+        LLog::error("[Libinput Backend] Failed to open input trace file %s.", path);
+
+        if (data->recordFile)
+        {
+            fclose(data->recordFile);
+            data->recordFile = nullptr;
+        }
+
+        return;
+    }
+
+    LLog::debug("[Libinput Backend] Recording input events into %s.", path);
+}
+
+static void record(BACKEND_DATA *data, UInt64 time, UInt32 type, UInt32 code, UInt32 state,
+                   Float32 v0 = 0.f, Float32 v1 = 0.f, Float32 v2 = 0.f, Float32 v3 = 0.f)
+{
+    if (!data->recordFile)
+        return;
+
+    if (!data->recordStarted)
+    {
+        data->recordStarted = true;
+        data->recordStartTime = time;
+    }
+
+    // Zeroed so the padding bytes written to binary traces are reproducible
+    LInputTraceEvent event;
+    memset(&event, 0, sizeof(event));
+    event.time = time - data->recordStartTime;
+    event.type = type;
+    event.code = code;
+    event.state = state;
+    event.values[0] = v0;
+    event.values[1] = v1;
+    event.values[2] = v2;
+    event.values[3] = v3;
+
+    if (!inputTraceWriteEvent(data->recordFile, data->recordJSON, event))
+    {
+        LLog::error("[Libinput Backend] Failed to write input trace, recording stopped.");
+        fclose(data->recordFile);
+        data->recordFile = nullptr;
+    }
+}
+
+// Delivers the accumulated relative motion as a single event
+static void flushMotion(BACKEND_DATA *data)
+{
+    if (!data->pendingMotion)
+        return;
+
+    data->pendingMotion = false;
+    data->seat->pointer()->pointerMoveEvent(data->pendingDx, data->pendingDy, false);
+    data->pendingDx = 0.f;
+    data->pendingDy = 0.f;
+}
+
 static Int32 processInput(int, unsigned int, void *userData)
 {
     LSeat *seat = (LSeat*)userData;
@@ -116,6 +200,10 @@ static Int32 processInput(int, unsigned int, void *userData)
     {
         eventType = libinput_event_get_type(ev);
 
+        // Any other event must see the cursor where the preceding motion left it
+        if (eventType != LIBINPUT_EVENT_POINTER_MOTION)
+            flushMotion(data);
+
         if (eventType == LIBINPUT_EVENT_POINTER_MOTION)
         {
             pointerEvent = libinput_event_get_pointer_event(ev);
@@ -123,7 +211,16 @@ static Int32 processInput(int, unsigned int, void *userData)
             x = libinput_event_pointer_get_dx(pointerEvent);
             y = libinput_event_pointer_get_dy(pointerEvent);
 
-            seat->pointer()->pointerMoveEvent(x, y, false);
+            record(data, libinput_event_pointer_get_time_usec(pointerEvent), LInputTracePointerMotion, 0, 0, x, y);
+
+            if (data->coalesceMotion)
+            {
+                data->pendingMotion = true;
+                data->pendingDx += x;
+                data->pendingDy += y;
+            }
+            else
+                seat->pointer()->pointerMoveEvent(x, y, false);
         }
         else if (eventType == LIBINPUT_EVENT_POINTER_BUTTON)
         {
@@ -131,6 +228,8 @@ static Int32 processInput(int, unsigned int, void *userData)
             pointerButton = libinput_event_pointer_get_button(pointerEvent);
             pointerButtonState = libinput_event_pointer_get_button_state(pointerEvent);
 
+            record(data, libinput_event_pointer_get_time_usec(pointerEvent), LInputTracePointerButton, pointerButton, pointerButtonState);
+
             seat->pointer()->pointerButtonEvent(
                 (LPointer::Button)pointerButton,
                 (LPointer::ButtonState)pointerButtonState);
@@ -140,6 +239,7 @@ static Int32 processInput(int, unsigned int, void *userData)
             keyEvent = libinput_event_get_keyboard_event(ev);
             keyState = libinput_event_keyboard_get_key_state(keyEvent);
             keyCode = libinput_event_keyboard_get_key(keyEvent);
+            record(data, libinput_event_keyboard_get_time_usec(keyEvent), LInputTraceKeyboardKey, keyCode, keyState);
             seat->keyboard()->imp()->backendKeyEvent(keyCode, (LKeyboard::KeyState)keyState);
         }
         else if (eventType == LIBINPUT_EVENT_POINTER_SCROLL_FINGER)
@@ -152,6 +252,7 @@ static Int32 processInput(int, unsigned int, void *userData)
             if (libinput_event_pointer_has_axis(pointerEvent, LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL))
                 axisY = libinput_event_pointer_get_scroll_value(pointerEvent, LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL);
 
+            record(data, libinput_event_pointer_get_time_usec(pointerEvent), LInputTracePointerAxis, LPointer::AxisSource::Finger, 0, axisX, axisY, axisX, axisY);
             seat->pointer()->pointerAxisEvent(axisX, axisY, axisX, axisY, LPointer::AxisSource::Finger);
         }
         else if (eventType == LIBINPUT_EVENT_POINTER_SCROLL_CONTINUOUS)
@@ -164,6 +265,7 @@ static Int32 processInput(int, unsigned int, void *userData)
             if (libinput_event_pointer_has_axis(pointerEvent, LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL))
                 axisY = libinput_event_pointer_get_scroll_value(pointerEvent, LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL);
 
+            record(data, libinput_event_pointer_get_time_usec(pointerEvent), LInputTracePointerAxis, LPointer::AxisSource::Continuous, 0, axisX, axisY, axisX, axisY);
             seat->pointer()->pointerAxisEvent(axisX, axisY, axisX, axisY, LPointer::AxisSource::Continuous);
         }
         else if (eventType == LIBINPUT_EVENT_POINTER_SCROLL_WHEEL)
@@ -182,6 +284,7 @@ static Int32 processInput(int, unsigned int, void *userData)
                 d120Y = libinput_event_pointer_get_scroll_value_v120(pointerEvent, LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL);
             }
 
+            record(data, libinput_event_pointer_get_time_usec(pointerEvent), LInputTracePointerAxis, LPointer::AxisSource::Wheel, 0, discreteX, discreteY, d120X, d120Y);
             seat->pointer()->pointerAxisEvent(discreteX, discreteY, d120X, d120Y, LPointer::AxisSource::Wheel);
         }
 
@@ -189,6 +292,7 @@ static Int32 processInput(int, unsigned int, void *userData)
         libinput_event_destroy(ev);
     }
 
+    flushMotion(data);
     return 0;
 }
 
@@ -200,6 +304,7 @@ UInt32 LInputBackend::id()
 bool LInputBackend::initialize()
 {
     int fd;
+    const char *env;
     LSeat *seat = LCompositor::compositor()->seat();
     libseatEnabled = seat->imp()->initLibseat();
 
@@ -227,6 +332,10 @@ bool LInputBackend::initialize()
     fcntl(fd, F_SETFD, FD_CLOEXEC);
 
     eventSource = LCompositor::addFdListener(fd, (LSeat*)seat, &processInput);
+    initRecorder(data);
+
+    env = getenv("LOUVRE_INPUT_COALESCE_MOTION");
+    data->coalesceMotion = env && atoi(env) == 1;
     return true;
 
     fail:
@@ -323,6 +432,9 @@ void LInputBackend::uninitialize()
     if (data->ud)
         udev_unref(data->ud);
 
+    if (data->recordFile)
+        fclose(data->recordFile);
+
     delete data;
     seat->imp()->inputBackendData = nullptr;
 }
@@ -0,0 +1,403 @@
+#include <private/LCompositorPrivate.h>
+#include <private/LSeatPrivate.h>
+#include <private/LKeyboardPrivate.h>
+#include <LInputBackend.h>
+#include <LInputTrace.h>
+#include <LPointer.h>
+#include <LLog.h>
+#include <sys/timerfd.h>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <time.h>
+
+using namespace Louvre;
+
+// Maximum number of events dispatched per loop iteration in fast mode
+#define FAST_MODE_BATCH 64
+
+struct BACKEND_DATA
+{
+    std::vector<LInputTraceEvent> events;
+    size_t current = 0;
+    bool fast = false;
+    bool loop = false;
+    bool suspended = false;
+    int timerFd = -1;
+    wl_event_source *timerSource = nullptr;
+
+    // Time of the first event in CLOCK_MONOTONIC (us)
+    UInt64 startTime = 0;
+
+    // Time the backend was suspended (us)
+    UInt64 suspendTime = 0;
+};
+
+static UInt64 nowUsec()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return UInt64(ts.tv_sec) * 1000000 + UInt64(ts.tv_nsec) / 1000;
+}
+
+static bool jsonNumber(const char *line, const char *key, Float64 *value)
+{
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char *it = strstr(line, pattern);
+
+    if (!it)
+        return false;
+
+    *value = strtod(it + strlen(pattern), nullptr);
+    return true;
+}
+
+static bool parseJSONLine(const char *line, LInputTraceEvent *event)
+{
+    Float64 value;
+
+    memset(event, 0, sizeof(LInputTraceEvent));
+
+    const char *type = strstr(line, "\"type\":\"");
+
+    if (!type)
+        return false;
+
+    type += strlen("\"type\":\"");
+
+    if (strncmp(type, "motion\"", 7) == 0)
+        event->type = LInputTracePointerMotion;
+    else if (strncmp(type, "button\"", 7) == 0)
+        event->type = LInputTracePointerButton;
+    else if (strncmp(type, "axis\"", 5) == 0)
+        event->type = LInputTracePointerAxis;
+    else if (strncmp(type, "key\"", 4) == 0)
+        event->type = LInputTraceKeyboardKey;
+    else
+        return false;
+
+    if (!jsonNumber(line, "t", &value) || value < 0)
+        return false;
+
+    event->time = value;
+
+    switch (event->type)
+    {
+    case LInputTracePointerMotion:
+        if (jsonNumber(line, "x", &value))
+            event->values[0] = value;
+        if (jsonNumber(line, "y", &value))
+            event->values[1] = value;
+        if (jsonNumber(line, "absolute", &value))
+            event->code = value != 0;
+        break;
+    case LInputTracePointerButton:
+    case LInputTraceKeyboardKey:
+        if (!jsonNumber(line, "code", &value))
+            return false;
+        event->code = value;
+        if (jsonNumber(line, "state", &value))
+            event->state = value != 0;
+        break;
+    case LInputTracePointerAxis:
+        if (jsonNumber(line, "x", &value))
+            event->values[0] = value;
+        if (jsonNumber(line, "y", &value))
+            event->values[1] = value;
+        if (jsonNumber(line, "dx", &value))
+            event->values[2] = value;
+        if (jsonNumber(line, "dy", &value))
+            event->values[3] = value;
+        if (jsonNumber(line, "source", &value))
+            event->code = value;
+        break;
+    }
+
+    return true;
+}
+
+static bool loadTrace(BACKEND_DATA *data, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (!file)
+    {
+        LLog::error("[Scripted Backend] Failed to open input trace %s.", path);
+        return false;
+    }
+
+    char magic[sizeof(LINPUT_TRACE_MAGIC)];
+    UInt32 version;
+    LInputTraceEvent event;
+
+    if (fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, LINPUT_TRACE_MAGIC, sizeof(magic)) == 0)
+    {
+        if (fread(&version, sizeof(version), 1, file) != 1 || version != LINPUT_TRACE_VERSION)
+        {
+            LLog::error("[Scripted Backend] Unsupported input trace version.");
+            fclose(file);
+            return false;
+        }
+
+        while (fread(&event, sizeof(event), 1, file) == 1)
+            data->events.push_back(event);
+    }
+    else
+    {
+        rewind(file);
+        char line[512];
+        UInt32 lineNumber = 0;
+
+        while (fgets(line, sizeof(line), file))
+        {
+            lineNumber++;
+
+            if (line[0] != '{')
+                continue;
+
+            if (parseJSONLine(line, &event))
+                data->events.push_back(event);
+            else
+                LLog::warning("[Scripted Backend] Ignoring invalid event at line %d.", lineNumber);
+        }
+    }
+
+    fclose(file);
+
+    // Events must be sorted by time
+    for (size_t i = 1; i < data->events.size(); i++)
+    {
+        if (data->events[i].time < data->events[i - 1].time)
+            data->events[i].time = data->events[i - 1].time;
+    }
+
+    return true;
+}
+
+static void dispatchEvent(LSeat *seat, const LInputTraceEvent &event)
+{
+    switch (event.type)
+    {
+    case LInputTracePointerMotion:
+        seat->pointer()->pointerMoveEvent(event.values[0], event.values[1], event.code != 0);
+        break;
+    case LInputTracePointerButton:
+        seat->pointer()->pointerButtonEvent(
+            (LPointer::Button)event.code,
+            (LPointer::ButtonState)event.state);
+        break;
+    case LInputTracePointerAxis:
+        seat->pointer()->pointerAxisEvent(event.values[0],
+                                          event.values[1],
+                                          event.values[2],
+                                          event.values[3],
+                                          (LPointer::AxisSource)event.code);
+        break;
+    case LInputTraceKeyboardKey:
+        seat->keyboard()->imp()->backendKeyEvent(event.code, (LKeyboard::KeyState)event.state);
+        break;
+    }
+}
+
+static void armTimer(BACKEND_DATA *data)
+{
+    itimerspec its;
+    memset(&its, 0, sizeof(its));
+
+    if (data->suspended || data->current >= data->events.size())
+    {
+        timerfd_settime(data->timerFd, 0, &its, NULL);
+        return;
+    }
+
+    if (data->fast)
+    {
+        // Minimal timeout, the main loop still gets a chance to flush clients
+        its.it_value.tv_nsec = 1;
+        timerfd_settime(data->timerFd, 0, &its, NULL);
+        return;
+    }
+
+    UInt64 target = data->startTime + data->events[data->current].time;
+    its.it_value.tv_sec = target / 1000000;
+    its.it_value.tv_nsec = (target % 1000000) * 1000;
+
+    // A zero value disarms the timer
+    if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0)
+        its.it_value.tv_nsec = 1;
+
+    timerfd_settime(data->timerFd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+static Int32 processInput(int fd, unsigned int, void *userData)
+{
+    LSeat *seat = (LSeat*)userData;
+    BACKEND_DATA *data = (BACKEND_DATA*)seat->imp()->inputBackendData;
+
+    // fd is -1 when called from forceUpdate()
+    if (fd != -1)
+    {
+        UInt64 expirations;
+
+        if (read(fd, &expirations, sizeof(expirations)) < 0)
+            return 0;
+    }
+
+    if (data->suspended)
+        return 0;
+
+    if (data->fast)
+    {
+        for (UInt32 i = 0; i < FAST_MODE_BATCH && data->current < data->events.size(); i++)
+            dispatchEvent(seat, data->events[data->current++]);
+    }
+    else
+    {
+        UInt64 elapsed = nowUsec() - data->startTime;
+
+        while (data->current < data->events.size() && data->events[data->current].time <= elapsed)
+            dispatchEvent(seat, data->events[data->current++]);
+    }
+
+    if (data->current >= data->events.size())
+    {
+        if (data->loop && !data->events.empty())
+        {
+            data->current = 0;
+            data->startTime = nowUsec();
+        }
+        else
+            LLog::debug("[Scripted Backend] Input trace finished.");
+    }
+
+    armTimer(data);
+    return 0;
+}
+
+UInt32 LInputBackend::id()
+{
+    return LInputBackendScripted;
+}
+
+bool LInputBackend::initialize()
+{
+    LSeat *seat = LCompositor::compositor()->seat();
+    const char *path = getenv("LOUVRE_INPUT_TRACE");
+    const char *env;
+
+    BACKEND_DATA *data = new BACKEND_DATA;
+    seat->imp()->inputBackendData = data;
+
+    if (!path)
+    {
+        LLog::error("[Scripted Backend] LOUVRE_INPUT_TRACE is not set.");
+        goto fail;
+    }
+
+    if (!loadTrace(data, path))
+        goto fail;
+
+    env = getenv("LOUVRE_INPUT_TRACE_MODE");
+    data->fast = env && strcmp(env, "fast") == 0;
+
+    env = getenv("LOUVRE_INPUT_TRACE_LOOP");
+    data->loop = env && atoi(env) == 1;
+
+    data->timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (data->timerFd == -1)
+    {
+        LLog::error("[Scripted Backend] Failed to create timer.");
+        goto fail;
+    }
+
+    data->timerSource = LCompositor::addFdListener(data->timerFd, seat, &processInput);
+    data->startTime = nowUsec();
+    armTimer(data);
+
+    LLog::debug("[Scripted Backend] Replaying %d events from %s (%s).",
+                (Int32)data->events.size(), path, data->fast ? "fast" : "recorded timing");
+    return true;
+
+    fail:
+    uninitialize();
+    return false;
+}
+
+UInt32 LInputBackend::getCapabilities()
+{
+    return LSeat::InputCapabilities::Pointer | LSeat::InputCapabilities::Keyboard;
+}
+
+void *LInputBackend::getContextHandle()
+{
+    return nullptr;
+}
+
+void LInputBackend::suspend()
+{
+    LSeat *seat = LCompositor::compositor()->seat();
+    BACKEND_DATA *data = (BACKEND_DATA*)seat->imp()->inputBackendData;
+
+    if (data->suspended)
+        return;
+
+    data->suspended = true;
+    data->suspendTime = nowUsec();
+    armTimer(data);
+}
+
+void LInputBackend::forceUpdate()
+{
+    LSeat *seat = LCompositor::compositor()->seat();
+    processInput(-1, 0, (LSeat*)seat);
+}
+
+void LInputBackend::resume()
+{
+    LSeat *seat = LCompositor::compositor()->seat();
+    BACKEND_DATA *data = (BACKEND_DATA*)seat->imp()->inputBackendData;
+
+    if (!data->suspended)
+        return;
+
+    // Time spent suspended is not replayed
+    data->startTime += nowUsec() - data->suspendTime;
+    data->suspended = false;
+    armTimer(data);
+}
+
+void LInputBackend::uninitialize()
+{
+    LSeat *seat = LCompositor::compositor()->seat();
+    BACKEND_DATA *data = (BACKEND_DATA*)seat->imp()->inputBackendData;
+
+    if (!data)
+        return;
+
+    if (data->timerSource)
+        LCompositor::removeFdListener(data->timerSource);
+
+    if (data->timerFd != -1)
+        close(data->timerFd);
+
+    delete data;
+    seat->imp()->inputBackendData = nullptr;
+}
+
+LInputBackendInterface API;
+
+extern "C" LInputBackendInterface *getAPI()
+{
+    API.id = &LInputBackend::id;
+    API.initialize = &LInputBackend::initialize;
+    API.uninitialize = &LInputBackend::uninitialize;
+    API.getCapabilities = &LInputBackend::getCapabilities;
+    API.getContextHandle = &LInputBackend::getContextHandle;
+    API.suspend = &LInputBackend::suspend;
+    API.forceUpdate = &LInputBackend::forceUpdate;
+    API.resume = &LInputBackend::resume;
+    return &API;
+}
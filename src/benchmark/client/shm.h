@@ -3,6 +3,14 @@
 
 #include <sys/types.h>
 
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
 int create_shm_file(off_t size);
 
+#ifdef  __cplusplus
+}
+#endif
+
 #endif
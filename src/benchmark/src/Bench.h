@@ -0,0 +1,54 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <LNamespaces.h>
+#include <string>
+
+using namespace Louvre;
+
+class Compositor;
+
+struct BenchOptions
+{
+    // Workload name (subsurfaces, toplevels, popups, resize or video)
+    std::string workload = "subsurfaces";
+
+    // Number of surfaces used by the workload (-1 uses the workload default)
+    Int32 count = -1;
+
+    UInt32 durationMs = 5000;
+    UInt32 warmupMs = 1000;
+    UInt32 seed = 1;
+
+    // Value assigned to LOUVRE_HEADLESS_OUTPUTS
+    std::string outputs = "1920x1080@60";
+
+    // Where the JSON results are written (stdout if empty)
+    std::string resultsPath;
+
+    // Previous results to compare with
+    std::string baselinePath;
+
+    // Maximum allowed p95 frame time regression (%)
+    Float32 threshold = 10.f;
+
+    // Replay a synthetic pointer trace while the workload runs
+    bool input = true;
+
+    // Microbenchmark run instead of a workload (hittest or coarsening), see HitTest.h and Coarsening.h
+    std::string micro;
+};
+
+namespace Bench
+{
+    // Microseconds of CLOCK_MONOTONIC
+    UInt64 monotonicUs();
+
+    // Microseconds of CPU time consumed by the calling thread
+    UInt64 threadCpuUs();
+
+    Compositor *compositor();
+    const BenchOptions &options();
+};
+
+#endif // BENCH_H
@@ -0,0 +1,281 @@
+#include <sys/mman.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cstring>
+#include <cstdio>
+#include <shm.h>
+#include <wayland-client.h>
+#include <xdg-shell-client-protocol.h>
+
+#include "Client.h"
+#include "Workloads.h"
+
+static void outputHandleGeometry(void *, wl_output *, int32_t, int32_t, int32_t, int32_t, int32_t, const char *, const char *, int32_t) {}
+
+static void outputHandleMode(void *data, wl_output *, uint32_t flags, int32_t width, int32_t height, int32_t)
+{
+    Client *client = (Client*)data;
+
+    if ((flags & WL_OUTPUT_MODE_CURRENT) || client->outputWidth == 0)
+    {
+        client->outputWidth = width;
+        client->outputHeight = height;
+    }
+}
+
+static void outputHandleDone(void *, wl_output *) {}
+
+static void outputHandleScale(void *data, wl_output *, int32_t scale)
+{
+    Client *client = (Client*)data;
+    client->outputScale = scale;
+}
+
+static void outputHandleString(void *, wl_output *, const char *) {}
+
+static const wl_output_listener outputListener =
+{
+    &outputHandleGeometry,
+    &outputHandleMode,
+    &outputHandleDone,
+    &outputHandleScale,
+    &outputHandleString,
+    &outputHandleString
+};
+
+static void wmBaseHandlePing(void *, xdg_wm_base *wmBase, uint32_t serial)
+{
+    xdg_wm_base_pong(wmBase, serial);
+}
+
+static const xdg_wm_base_listener wmBaseListener =
+{
+    &wmBaseHandlePing
+};
+
+static void registryHandleGlobal(void *data, wl_registry *registry, uint32_t name, const char *interface, uint32_t version)
+{
+    Client *client = (Client*)data;
+
+    if (strcmp(interface, wl_shm_interface.name) == 0)
+        client->shm = (wl_shm*)wl_registry_bind(registry, name, &wl_shm_interface, 1);
+    else if (strcmp(interface, wl_compositor_interface.name) == 0)
+        client->compositor = (wl_compositor*)wl_registry_bind(registry, name, &wl_compositor_interface, 3);
+    else if (strcmp(interface, wl_subcompositor_interface.name) == 0)
+        client->subcompositor = (wl_subcompositor*)wl_registry_bind(registry, name, &wl_subcompositor_interface, 1);
+    else if (strcmp(interface, xdg_wm_base_interface.name) == 0)
+    {
+        client->wmBase = (xdg_wm_base*)wl_registry_bind(registry, name, &xdg_wm_base_interface, 2);
+        xdg_wm_base_add_listener(client->wmBase, &wmBaseListener, client);
+    }
+    else if (!client->output && strcmp(interface, wl_output_interface.name) == 0)
+    {
+        client->output = (wl_output*)wl_registry_bind(registry, name, &wl_output_interface, version >= 2 ? 2 : 1);
+        wl_output_add_listener(client->output, &outputListener, client);
+    }
+}
+
+static void registryHandleGlobalRemove(void *, wl_registry *, uint32_t) {}
+
+static const wl_registry_listener registryListener =
+{
+    &registryHandleGlobal,
+    &registryHandleGlobalRemove
+};
+
+static void bufferHandleRelease(void *data, wl_buffer *)
+{
+    ShmBuffer *buffer = (ShmBuffer*)data;
+    buffer->busy = false;
+}
+
+static const wl_buffer_listener bufferListener =
+{
+    &bufferHandleRelease
+};
+
+static void poolBufferHandleRelease(void *, wl_buffer *buffer)
+{
+    wl_buffer_destroy(buffer);
+}
+
+static const wl_buffer_listener poolBufferListener =
+{
+    &poolBufferHandleRelease
+};
+
+static uint8_t *mapShm(int32_t size, int32_t *fd)
+{
+    *fd = create_shm_file(size);
+
+    if (*fd < 0)
+        return nullptr;
+
+    void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, *fd, 0);
+
+    if (data == MAP_FAILED)
+    {
+        close(*fd);
+        return nullptr;
+    }
+
+    return (uint8_t*)data;
+}
+
+static void fillRows(uint8_t *data, int32_t stride, int32_t width, int32_t y, int32_t height, uint32_t argb)
+{
+    for (int32_t row = y; row < y + height; row++)
+    {
+        uint32_t *pixel = (uint32_t*)&data[row * stride];
+
+        for (int32_t x = 0; x < width; x++)
+            pixel[x] = argb;
+    }
+}
+
+Client::Client(const char *socket) : socket(socket), running(true), finished(false) {}
+
+Client::~Client() {}
+
+bool Client::run(Workload *workload)
+{
+    display = wl_display_connect(socket);
+
+    if (!display)
+    {
+        fprintf(stderr, "[louvre-bench] Client failed to connect to %s.\n", socket);
+        return false;
+    }
+
+    registry = wl_display_get_registry(display);
+    wl_registry_add_listener(registry, &registryListener, this);
+    wl_display_roundtrip(display);
+    wl_display_roundtrip(display);
+
+    if (!shm || !compositor || !subcompositor || !wmBase || !output)
+    {
+        fprintf(stderr, "[louvre-bench] Missing globals.\n");
+        wl_display_disconnect(display);
+        return false;
+    }
+
+    if (!workload->init(this))
+    {
+        fprintf(stderr, "[louvre-bench] Failed to initialize workload %s.\n", workload->name());
+        wl_display_disconnect(display);
+        return false;
+    }
+
+    workload->start();
+
+    pollfd fd;
+    fd.fd = wl_display_get_fd(display);
+    fd.events = POLLIN;
+
+    while (running)
+    {
+        while (wl_display_prepare_read(display) != 0)
+            wl_display_dispatch_pending(display);
+
+        wl_display_flush(display);
+
+        if (poll(&fd, 1, 50) > 0)
+        {
+            if (wl_display_read_events(display) == -1)
+                break;
+        }
+        else
+            wl_display_cancel_read(display);
+
+        if (wl_display_dispatch_pending(display) == -1)
+            break;
+    }
+
+    workload->uninit();
+    wl_display_roundtrip(display);
+    wl_display_disconnect(display);
+    display = nullptr;
+    return true;
+}
+
+void Client::stop()
+{
+    running = false;
+}
+
+ShmBuffer *Client::createBuffer(int32_t width, int32_t height, uint32_t argb)
+{
+    ShmBuffer *buffer = new ShmBuffer;
+    buffer->width = width;
+    buffer->height = height;
+    buffer->stride = width * 4;
+
+    int32_t fd;
+    int32_t size = buffer->stride * height;
+    buffer->data = mapShm(size, &fd);
+
+    if (!buffer->data)
+    {
+        delete buffer;
+        return nullptr;
+    }
+
+    wl_shm_pool *pool = wl_shm_create_pool(shm, fd, size);
+    buffer->buffer = wl_shm_pool_create_buffer(pool, 0, width, height, buffer->stride, WL_SHM_FORMAT_ARGB8888);
+    wl_buffer_add_listener(buffer->buffer, &bufferListener, buffer);
+    wl_shm_pool_destroy(pool);
+    close(fd);
+
+    fillBuffer(buffer, 0, height, argb);
+    return buffer;
+}
+
+void Client::destroyBuffer(ShmBuffer *buffer)
+{
+    wl_buffer_destroy(buffer->buffer);
+    munmap(buffer->data, buffer->stride * buffer->height);
+    delete buffer;
+}
+
+void Client::fillBuffer(ShmBuffer *buffer, int32_t y, int32_t height, uint32_t argb)
+{
+    fillRows(buffer->data, buffer->stride, buffer->width, y, height, argb);
+}
+
+ShmPool *Client::createPool(int32_t width, int32_t height, uint32_t argb)
+{
+    ShmPool *pool = new ShmPool;
+    pool->width = width;
+    pool->height = height;
+    pool->stride = width * 4;
+
+    int32_t fd;
+    int32_t size = pool->stride * height;
+    pool->data = mapShm(size, &fd);
+
+    if (!pool->data)
+    {
+        delete pool;
+        return nullptr;
+    }
+
+    pool->pool = wl_shm_create_pool(shm, fd, size);
+    close(fd);
+
+    fillRows(pool->data, pool->stride, width, 0, height, argb);
+    return pool;
+}
+
+void Client::destroyPool(ShmPool *pool)
+{
+    wl_shm_pool_destroy(pool->pool);
+    munmap(pool->data, pool->stride * pool->height);
+    delete pool;
+}
+
+wl_buffer *Client::createPoolBuffer(ShmPool *pool, int32_t width, int32_t height)
+{
+    wl_buffer *buffer = wl_shm_pool_create_buffer(pool->pool, 0, width, height, pool->stride, WL_SHM_FORMAT_ARGB8888);
+    wl_buffer_add_listener(buffer, &poolBufferListener, nullptr);
+    return buffer;
+}
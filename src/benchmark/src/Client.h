@@ -0,0 +1,84 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+#include <cstdint>
+#include <atomic>
+
+/* Client code only uses libwayland-client, this header is also included
+ * by compositor code so protocol headers are not included here. */
+struct wl_display;
+struct wl_registry;
+struct wl_compositor;
+struct wl_subcompositor;
+struct wl_shm;
+struct wl_shm_pool;
+struct wl_buffer;
+struct wl_output;
+struct xdg_wm_base;
+
+class Workload;
+
+// ARGB8888 shm buffer, released buffers are marked as not busy
+struct ShmBuffer
+{
+    wl_buffer *buffer = nullptr;
+    uint8_t *data = nullptr;
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t stride = 0;
+    bool busy = false;
+};
+
+// Shm pool from which buffers of any size (up to the pool size) can be created
+struct ShmPool
+{
+    wl_shm_pool *pool = nullptr;
+    uint8_t *data = nullptr;
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t stride = 0;
+};
+
+/* Wayland client running the workloads. It lives in its own thread
+ * and connects to the in-process compositor. */
+class Client
+{
+public:
+    Client(const char *socket);
+    ~Client();
+
+    // Connects, binds globals and runs the workload until stop() is called
+    bool run(Workload *workload);
+    void stop();
+
+    ShmBuffer *createBuffer(int32_t width, int32_t height, uint32_t argb);
+    void destroyBuffer(ShmBuffer *buffer);
+    void fillBuffer(ShmBuffer *buffer, int32_t y, int32_t height, uint32_t argb);
+
+    ShmPool *createPool(int32_t width, int32_t height, uint32_t argb);
+    void destroyPool(ShmPool *pool);
+
+    // Buffer backed by the pool memory, destroyed automatically when released
+    wl_buffer *createPoolBuffer(ShmPool *pool, int32_t width, int32_t height);
+
+    const char *socket;
+    std::atomic<bool> running;
+
+    // Set by the client thread once it disconnects
+    std::atomic<bool> finished;
+
+    wl_display *display = nullptr;
+    wl_registry *registry = nullptr;
+    wl_compositor *compositor = nullptr;
+    wl_subcompositor *subcompositor = nullptr;
+    wl_shm *shm = nullptr;
+    wl_output *output = nullptr;
+    xdg_wm_base *wmBase = nullptr;
+
+    // Mode of the first output
+    int32_t outputWidth = 0;
+    int32_t outputHeight = 0;
+    int32_t outputScale = 1;
+};
+
+#endif // CLIENT_H
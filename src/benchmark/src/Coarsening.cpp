@@ -0,0 +1,183 @@
+#include <private/LSceneViewPrivate.h>
+#include <private/LCompositorPrivate.h>
+#include <private/LOutputPrivate.h>
+#include <LSolidColorView.h>
+#include <LSceneView.h>
+#include <LLayerView.h>
+#include <LLog.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Compositor.h"
+#include "Coarsening.h"
+#include "Output.h"
+
+#define COARSENING_CELL 24
+#define COARSENING_SQUARE 8
+#define COARSENING_TIMEOUT_MS 2000
+
+// Repaints the output and waits until its framebuffer is read
+static bool capture(Output *output, std::vector<UChar8> &pixels)
+{
+    Compositor *compositor = Bench::compositor();
+    output->requestCapture();
+    output->repaint();
+
+    for (UInt32 i = 0; i < COARSENING_TIMEOUT_MS / 10; i++)
+    {
+        compositor->processLoop(10);
+
+        if (output->takeCapture(pixels))
+            return true;
+    }
+
+    LLog::error("[louvre-bench] coarsening: timed out waiting for a frame.");
+    return false;
+}
+
+// Pixels with a channel differing by more than 1 (blending may round differently)
+static UInt32 countMismatches(const std::vector<UChar8> &a, const std::vector<UChar8> &b)
+{
+    if (a.size() != b.size())
+        return a.size() / 4;
+
+    UInt32 mismatches = 0;
+
+    for (size_t i = 0; i < a.size(); i += 4)
+        for (size_t c = 0; c < 4; c++)
+            if (abs(Int32(a[i + c]) - Int32(b[i + c])) > 1)
+            {
+                mismatches++;
+                break;
+            }
+
+    return mismatches;
+}
+
+bool Coarsening::run(const BenchOptions &options)
+{
+    Compositor *compositor = Bench::compositor();
+
+    // Outputs are added once the compositor is initialized
+    for (UInt32 i = 0; i < 100 && compositor->outputs().empty(); i++)
+        compositor->processLoop(10);
+
+    if (compositor->outputs().empty())
+    {
+        LLog::error("[louvre-bench] No outputs available for the coarsening check.");
+        return false;
+    }
+
+    Output *output = (Output*)compositor->outputs().front();
+    const LRect &area = output->rect();
+
+    // Above the surfaces layer
+    LLayerView layer(compositor->scene.mainView());
+    layer.setPos(area.pos());
+    layer.setSize(area.size());
+
+    LSolidColorView background(1.f, 1.f, 1.f, 1.f, &layer);
+    background.setPos(area.pos());
+    background.setSize(area.size());
+
+    // Split the opaque region of the background into many rects, separated by rows without squares
+    std::vector<LSolidColorView*> squares;
+
+    for (Int32 y = area.y(); y + COARSENING_SQUARE <= area.y() + area.h(); y += COARSENING_CELL)
+    {
+        for (Int32 x = area.x(); x + COARSENING_SQUARE <= area.x() + area.w(); x += COARSENING_CELL)
+        {
+            LSolidColorView *square = new LSolidColorView(0.f, 0.f, 1.f, 1.f, &layer);
+            square->setPos(x, y);
+            square->setSize(COARSENING_SQUARE, COARSENING_SQUARE);
+            squares.push_back(square);
+        }
+    }
+
+    /* Like a shadow or a panel between the damaged areas. The rows of the background on both
+     * sides can be merged over it, but they must not be drawn over it */
+    const Int32 middle = area.w() / 6;
+    LSolidColorView overlay(0.f, 0.f, 0.f, 0.5f, &layer);
+    overlay.setPos(area.x() + (area.w() - middle) / 2, area.y());
+    overlay.setSize(middle, area.h());
+
+    // Translucent, so the background below them is damaged too
+    LSolidColorView left(1.f, 0.f, 0.f, 0.25f, &layer);
+    left.setPos(area.pos());
+    left.setSize(overlay.pos().x() - area.x(), area.h());
+
+    LSolidColorView right(1.f, 0.f, 0.f, 0.25f, &layer);
+    right.setPos(overlay.pos().x() + middle, area.y());
+    right.setSize(area.x() + area.w() - right.pos().x(), area.h());
+
+    std::vector<UChar8> coarsened, expected;
+    bool passed = true;
+
+    // Until the damage of all the buffers only contains both sides
+    for (UInt32 i = 0; i < LOUVRE_DAMAGE_HISTORY + 1 && passed; i++)
+    {
+        const Float32 red = Float32(i % 2);
+        left.setColor(red, 0.f, 1.f - red);
+        right.setColor(red, 0.f, 1.f - red);
+        passed = capture(output, coarsened);
+    }
+
+    const LSceneView::LSceneViewPrivate::CoarseningStats stats =
+        compositor->scene.mainView()->imp()->outputData(output->imp()->slot).coarsening;
+
+    // Same scene, fully repainted without coarsening
+    const UInt32 maxBoxes = compositor->imp()->damageMaxBoxes;
+    compositor->imp()->damageMaxBoxes = 0;
+    compositor->scene.mainView()->damageAll(output);
+    passed = passed && capture(output, expected);
+    compositor->imp()->damageMaxBoxes = maxBoxes;
+
+    const size_t views = squares.size() + 4;
+
+    for (LSolidColorView *square : squares)
+        delete square;
+
+    if (!passed)
+        return false;
+
+    const UInt32 mismatches = countMismatches(coarsened, expected);
+
+    FILE *f = stdout;
+
+    if (!options.resultsPath.empty())
+    {
+        f = fopen(options.resultsPath.c_str(), "w");
+
+        if (!f)
+        {
+            LLog::error("[louvre-bench] Failed to open %s.", options.resultsPath.c_str());
+            return false;
+        }
+    }
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"micro\": \"coarsening\",\n");
+    fprintf(f, "  \"views\": %zu,\n", views);
+    fprintf(f, "  \"opaque_boxes_in\": %u,\n", stats.opaqueBoxesIn);
+    fprintf(f, "  \"opaque_boxes_out\": %u,\n", stats.opaqueBoxesOut);
+    fprintf(f, "  \"mismatches\": %u\n", mismatches);
+    fprintf(f, "}\n");
+
+    if (f != stdout)
+        fclose(f);
+
+    if (maxBoxes != 0 && stats.opaqueBoxesIn == 0)
+    {
+        LLog::error("[louvre-bench] coarsening: the scene did not coarsen any opaque region.");
+        return false;
+    }
+
+    if (mismatches > 0)
+    {
+        LLog::error("[louvre-bench] coarsening: %u pixels differ from a repaint without coarsening.", mismatches);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,15 @@
+#ifndef COARSENING_H
+#define COARSENING_H
+
+#include "Bench.h"
+
+/* Check of the damage coarsening of LScene. Renders a grid of small views
+ * damaged at once below a translucent view, which makes the scene coarsen the
+ * opaque region of the background, and compares the output pixels with a full
+ * repaint without coarsening. */
+namespace Coarsening
+{
+    bool run(const BenchOptions &options);
+};
+
+#endif // COARSENING_H
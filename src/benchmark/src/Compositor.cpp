@@ -0,0 +1,46 @@
+#include <LSceneView.h>
+#include <LOutput.h>
+#include <LSeat.h>
+
+#include "Compositor.h"
+#include "Output.h"
+#include "Surface.h"
+#include "Pointer.h"
+
+Compositor::Compositor() : LCompositor(),
+    scene(),
+    surfacesLayer(scene.mainView()),
+    recording(false)
+{
+    scene.mainView()->setClearColor(0.1f, 0.1f, 0.1f, 1.f);
+}
+
+void Compositor::initialized()
+{
+    Int32 totalWidth = 0;
+
+    // Arrange outputs left to right
+    for (LOutput *output : seat()->outputs())
+    {
+        output->setScale(output->dpi() >= 200 ? 2 : 1);
+        output->setPos(LPoint(totalWidth, 0));
+        totalWidth += output->size().w();
+        addOutput(output);
+        output->repaint();
+    }
+}
+
+LOutput *Compositor::createOutputRequest()
+{
+    return new Output();
+}
+
+LSurface *Compositor::createSurfaceRequest(LSurface::Params *params)
+{
+    return new Surface(params);
+}
+
+LPointer *Compositor::createPointerRequest(LPointer::Params *params)
+{
+    return new Pointer(params);
+}
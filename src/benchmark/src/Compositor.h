@@ -0,0 +1,34 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <LCompositor.h>
+#include <LLayerView.h>
+#include <LScene.h>
+#include <atomic>
+
+using namespace Louvre;
+
+class Compositor : public LCompositor
+{
+public:
+    Compositor();
+
+    void initialized() override;
+
+    LOutput *createOutputRequest() override;
+    LSurface *createSurfaceRequest(LSurface::Params *params) override;
+    LPointer *createPointerRequest(LPointer::Params *params) override;
+
+    LScene scene;
+
+    // Layer where client surfaces are stacked
+    LLayerView surfacesLayer;
+
+    // Frames are only recorded between the warmup and the end of the workload
+    std::atomic<bool> recording;
+
+    // Used to cascade non maximized toplevels
+    UInt32 mappedToplevels = 0;
+};
+
+#endif // COMPOSITOR_H
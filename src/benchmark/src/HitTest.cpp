@@ -0,0 +1,161 @@
+#include <private/LScenePrivate.h>
+#include <LSolidColorView.h>
+#include <LSceneView.h>
+#include <LLayerView.h>
+#include <LOutput.h>
+#include <LLog.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Compositor.h"
+#include "HitTest.h"
+
+#define HITTEST_SAMPLES 20000
+
+struct HitTestResult
+{
+    Int32 views;
+    Float64 gridNs;
+    Float64 walkNs;
+    UInt32 mismatches;
+};
+
+static Float64 measure(LScene &scene, const std::vector<LPoint> &samples, bool grid)
+{
+    scene.imp()->inputGridEnabled = grid;
+
+    // Builds the grid (if enabled) outside the measured time
+    scene.handlePointerMoveEvent(samples.front().x(), samples.front().y(), true);
+
+    const UInt64 start = Bench::monotonicUs();
+
+    for (const LPoint &sample : samples)
+        scene.handlePointerMoveEvent(sample.x(), sample.y(), true);
+
+    return 1000.0 * (Bench::monotonicUs() - start) / samples.size();
+}
+
+static HitTestResult runCount(Int32 count, const LRect &area, const std::vector<LPoint> &samples)
+{
+    HitTestResult result;
+    result.views = count;
+    result.mismatches = 0;
+
+    LScene scene;
+    scene.enableHandleWaylandPointerEvents(false);
+
+    LLayerView layer(scene.mainView());
+    layer.setSize(area.size());
+    std::vector<LSolidColorView*> views;
+
+    for (Int32 i = 0; i < count; i++)
+    {
+        LSolidColorView *view = new LSolidColorView(1.f, 1.f, 1.f, 1.f, &layer);
+        view->setSize(16 + rand() % 80, 16 + rand() % 80);
+        view->setPos(area.x() + rand() % area.w(), area.y() + rand() % area.h());
+        view->enableInput(true);
+
+        // Mix of views that block the pointer and views that let it pass through
+        view->enableBlockPointer(i % 2 == 0);
+        views.push_back(view);
+    }
+
+    result.walkNs = measure(scene, samples, false);
+    result.gridNs = measure(scene, samples, true);
+
+    LView *expected;
+
+    for (const LPoint &sample : samples)
+    {
+        scene.imp()->inputGridEnabled = false;
+        expected = scene.viewAt(sample);
+        scene.imp()->inputGridEnabled = true;
+
+        if (scene.viewAt(sample) != expected)
+            result.mismatches++;
+    }
+
+    for (LSolidColorView *view : views)
+        delete view;
+
+    return result;
+}
+
+bool HitTest::run(const BenchOptions &options)
+{
+    Compositor *compositor = Bench::compositor();
+
+    // Outputs are added once the compositor is initialized
+    for (UInt32 i = 0; i < 100 && compositor->outputs().empty(); i++)
+        compositor->processLoop(10);
+
+    if (compositor->outputs().empty())
+    {
+        LLog::error("[louvre-bench] No outputs available for the hittest benchmark.");
+        return false;
+    }
+
+    const LRect &area = compositor->outputs().front()->rect();
+    std::vector<LPoint> samples;
+    samples.reserve(HITTEST_SAMPLES);
+
+    // Same path as the synthetic pointer trace
+    for (UInt32 i = 0; i < HITTEST_SAMPLES; i++)
+    {
+        const Float32 angle = 2.f * M_PI * i / HITTEST_SAMPLES;
+        samples.push_back(LPoint(area.x() + area.w() * (0.5f + 0.4f * cosf(angle)),
+                                 area.y() + area.h() * (0.5f + 0.4f * sinf(2.f * angle))));
+    }
+
+    std::vector<Int32> counts;
+
+    if (options.count > 0)
+        counts.push_back(options.count);
+    else
+        counts = {16, 64, 256, 1024, 4096};
+
+    FILE *f = stdout;
+
+    if (!options.resultsPath.empty())
+    {
+        f = fopen(options.resultsPath.c_str(), "w");
+
+        if (!f)
+        {
+            LLog::error("[louvre-bench] Failed to open %s.", options.resultsPath.c_str());
+            return false;
+        }
+    }
+
+    bool passed = true;
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"micro\": \"hittest\",\n");
+    fprintf(f, "  \"seed\": %u,\n", options.seed);
+    fprintf(f, "  \"samples\": %u,\n", HITTEST_SAMPLES);
+    fprintf(f, "  \"results\": [");
+
+    for (size_t i = 0; i < counts.size(); i++)
+    {
+        const HitTestResult r = runCount(counts[i], area, samples);
+
+        fprintf(f, "%s\n    {\"views\": %d, \"grid_ns\": %.1f, \"walk_ns\": %.1f, \"speedup\": %.2f, \"mismatches\": %u}",
+                i == 0 ? "" : ",", r.views, r.gridNs, r.walkNs, r.gridNs > 0.0 ? r.walkNs / r.gridNs : 0.0, r.mismatches);
+
+        if (r.mismatches > 0)
+        {
+            LLog::error("[louvre-bench] hittest: the grid and the tree walk found different views for %u positions (%d views).",
+                        r.mismatches, r.views);
+            passed = false;
+        }
+    }
+
+    fprintf(f, "\n  ]\n}\n");
+
+    if (f != stdout)
+        fclose(f);
+
+    return passed;
+}
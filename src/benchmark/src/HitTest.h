@@ -0,0 +1,15 @@
+#ifndef HITTEST_H
+#define HITTEST_H
+
+#include "Bench.h"
+
+/* Microbenchmark of LScene pointer hit-testing. Measures the time spent by
+ * LScene::handlePointerMoveEvent() over scenes with an increasing number of
+ * input-enabled views, with and without the hit-testing grid, and checks both
+ * paths find the same views. */
+namespace HitTest
+{
+    bool run(const BenchOptions &options);
+};
+
+#endif // HITTEST_H
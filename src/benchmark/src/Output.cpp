@@ -0,0 +1,143 @@
+#include <private/LSceneViewPrivate.h>
+#include <private/LOutputPrivate.h>
+#include <LRegion.h>
+#include <LPainter.h>
+#include <LFramebuffer.h>
+#include <GLES2/gl2.h>
+
+#include "Bench.h"
+#include "Compositor.h"
+#include "Output.h"
+
+Output::Output() : LOutput() {}
+
+void Output::initializeGL()
+{
+    Bench::compositor()->scene.handleInitializeGL(this);
+}
+
+void Output::paintGL()
+{
+    Compositor *c = Bench::compositor();
+    const UInt64 wallStart = Bench::monotonicUs();
+    const UInt64 cpuStart = Bench::threadCpuUs();
+
+    c->scene.handlePaintGL(this);
+
+    // Wait for the GPU so that the frame time includes the rendering itself
+    glFinish();
+
+    const UInt64 cpuEnd = Bench::threadCpuUs();
+    const UInt64 wallEnd = Bench::monotonicUs();
+
+    m_statsMutex.lock();
+
+    if (m_captureRequested)
+    {
+        const LSize &sizeB = framebuffer()->sizeB();
+        m_capture.resize(sizeB.area() * 4);
+        painter()->bindFramebuffer(framebuffer());
+        glReadPixels(0, 0, sizeB.w(), sizeB.h(), GL_RGBA, GL_UNSIGNED_BYTE, m_capture.data());
+        m_captureRequested = false;
+        m_captureDone = true;
+    }
+
+    m_statsMutex.unlock();
+
+    if (!c->recording)
+        return;
+
+    FrameStats frame;
+    frame.wallTime = wallEnd - wallStart;
+    frame.cpuTime = cpuEnd - cpuStart;
+    frame.damageArea = 0;
+
+    // Damage (in compositor coords) repainted by the scene during this frame
+    const auto &outputsData = c->scene.mainView()->imp()->outputsData;
+    Int32 n = 0;
+    LBox *boxes = nullptr;
+
+    frame.rawDamageBoxes = 0;
+    frame.coarsenedArea = 0;
+
+    if (imp()->slot < outputsData.size())
+    {
+        boxes = outputsData[imp()->slot].newDamage.boxes(&n);
+        frame.rawDamageBoxes = outputsData[imp()->slot].coarsening.damageBoxesIn;
+        frame.coarsenedArea = outputsData[imp()->slot].coarsening.addedArea * scale() * scale();
+    }
+
+    frame.damageBoxes = n;
+
+    for (Int32 i = 0; i < n; i++)
+        frame.damageArea += UInt64(boxes[i].x2 - boxes[i].x1) * UInt64(boxes[i].y2 - boxes[i].y1);
+
+    frame.damageArea *= scale() * scale();
+
+    m_statsMutex.lock();
+
+    if (wallStart >= m_recordingStart)
+    {
+        frame.time = wallStart - m_recordingStart;
+        frame.interval = m_prevFrameStart == 0 ? 0 : wallStart - m_prevFrameStart;
+        m_prevFrameStart = wallStart;
+        m_frames.push_back(frame);
+    }
+
+    m_statsMutex.unlock();
+}
+
+void Output::moveGL()
+{
+    Bench::compositor()->scene.handleMoveGL(this);
+}
+
+void Output::resizeGL()
+{
+    Bench::compositor()->scene.handleResizeGL(this);
+}
+
+void Output::uninitializeGL()
+{
+    Bench::compositor()->scene.handleUninitializeGL(this);
+}
+
+void Output::resetStats(UInt64 recordingStart)
+{
+    m_statsMutex.lock();
+    m_frames.clear();
+    m_recordingStart = recordingStart;
+    m_prevFrameStart = 0;
+    m_statsMutex.unlock();
+}
+
+std::vector<FrameStats> Output::stats()
+{
+    m_statsMutex.lock();
+    std::vector<FrameStats> copy = m_frames;
+    m_statsMutex.unlock();
+    return copy;
+}
+
+void Output::requestCapture()
+{
+    m_statsMutex.lock();
+    m_captureRequested = true;
+    m_captureDone = false;
+    m_statsMutex.unlock();
+}
+
+bool Output::takeCapture(std::vector<UChar8> &pixels)
+{
+    m_statsMutex.lock();
+    const bool done = m_captureDone;
+
+    if (done)
+    {
+        pixels.swap(m_capture);
+        m_captureDone = false;
+    }
+
+    m_statsMutex.unlock();
+    return done;
+}
@@ -0,0 +1,66 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <LOutput.h>
+#include <mutex>
+#include <vector>
+
+using namespace Louvre;
+
+struct FrameStats
+{
+    // Time the frame started, relative to the start of the recording (us)
+    UInt64 time;
+
+    // Wall time spent rendering the frame, including GPU completion (us)
+    UInt32 wallTime;
+
+    // CPU time spent by the rendering thread (us)
+    UInt32 cpuTime;
+
+    // Time since the previous frame started (us), 0 for the first one
+    UInt32 interval;
+
+    // Repainted area in buffer pixels
+    UInt64 damageArea;
+    UInt32 damageBoxes;
+
+    // Damage boxes before coarsening and pixels added by it, see LRegion::coarsen()
+    UInt32 rawDamageBoxes;
+    UInt64 coarsenedArea;
+};
+
+class Output : public LOutput
+{
+public:
+    Output();
+
+    void initializeGL() override;
+    void paintGL() override;
+    void moveGL() override;
+    void resizeGL() override;
+    void uninitializeGL() override;
+
+    // Clears the recorded frames and starts measuring intervals again
+    void resetStats(UInt64 recordingStart);
+
+    // Copy of the frames recorded so far (thread safe)
+    std::vector<FrameStats> stats();
+
+    // The framebuffer is read once the next frame is drawn, see Coarsening.h
+    void requestCapture();
+
+    // Moves the RGBA8888 pixels of the requested capture to pixels once read (thread safe)
+    bool takeCapture(std::vector<UChar8> &pixels);
+
+private:
+    std::mutex m_statsMutex;
+    std::vector<FrameStats> m_frames;
+    bool m_captureRequested = false;
+    bool m_captureDone = false;
+    std::vector<UChar8> m_capture;
+    UInt64 m_recordingStart = 0;
+    UInt64 m_prevFrameStart = 0;
+};
+
+#endif // OUTPUT_H
@@ -0,0 +1,20 @@
+#include "Bench.h"
+#include "Compositor.h"
+#include "Pointer.h"
+
+Pointer::Pointer(Params *params) : LPointer(params) {}
+
+void Pointer::pointerMoveEvent(Float32 x, Float32 y, bool absolute)
+{
+    Bench::compositor()->scene.handlePointerMoveEvent(x, y, absolute);
+}
+
+void Pointer::pointerButtonEvent(Button button, ButtonState state)
+{
+    Bench::compositor()->scene.handlePointerButtonEvent(button, state);
+}
+
+void Pointer::pointerAxisEvent(Float64 axisX, Float64 axisY, Int32 discreteX, Int32 discreteY, AxisSource source)
+{
+    Bench::compositor()->scene.handlePointerAxisEvent(axisX, axisY, discreteX, discreteY, source);
+}
@@ -0,0 +1,226 @@
+#include <LOutputMode.h>
+#include <LLog.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Output.h"
+#include "Report.h"
+
+struct Summary
+{
+    Float64 mean = 0.0;
+    UInt64 p50 = 0;
+    UInt64 p90 = 0;
+    UInt64 p95 = 0;
+    UInt64 p99 = 0;
+    UInt64 max = 0;
+};
+
+static UInt64 percentile(const std::vector<UInt64> &sorted, Float64 p)
+{
+    if (sorted.empty())
+        return 0;
+
+    // Nearest rank
+    size_t rank = (size_t)(p / 100.0 * sorted.size() + 0.5);
+    rank = std::min(std::max(rank, (size_t)1), sorted.size());
+    return sorted[rank - 1];
+}
+
+static Summary summarize(std::vector<UInt64> values)
+{
+    Summary s;
+
+    if (values.empty())
+        return s;
+
+    std::sort(values.begin(), values.end());
+
+    for (UInt64 value : values)
+        s.mean += value;
+
+    s.mean /= values.size();
+    s.p50 = percentile(values, 50.0);
+    s.p90 = percentile(values, 90.0);
+    s.p95 = percentile(values, 95.0);
+    s.p99 = percentile(values, 99.0);
+    s.max = values.back();
+    return s;
+}
+
+static void writeSummary(FILE *f, const char *key, const Summary &s)
+{
+    fprintf(f, "      \"%s\": {\"mean\": %.1f, \"p50\": %llu, \"p90\": %llu, \"p95\": %llu, \"p99\": %llu, \"max\": %llu},\n",
+            key, s.mean,
+            (unsigned long long)s.p50,
+            (unsigned long long)s.p90,
+            (unsigned long long)s.p95,
+            (unsigned long long)s.p99,
+            (unsigned long long)s.max);
+}
+
+// Reads the p95 frame time of the first output of a previous run
+static bool readBaseline(const char *path, Float64 *p95)
+{
+    FILE *f = fopen(path, "r");
+
+    if (!f)
+        return false;
+
+    std::vector<char> data;
+    char chunk[4096];
+    size_t n;
+
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+        data.insert(data.end(), chunk, chunk + n);
+
+    fclose(f);
+    data.push_back('\0');
+
+    const char *it = strstr(data.data(), "\"frame_time_us\"");
+
+    if (!it || !(it = strstr(it, "\"p95\":")))
+        return false;
+
+    *p95 = strtod(it + strlen("\"p95\":"), nullptr);
+    return *p95 > 0.0;
+}
+
+bool Report::write(const BenchOptions &options, const std::list<Output*> &outputs, const UploadCounters &uploads)
+{
+    FILE *f = stdout;
+
+    if (!options.resultsPath.empty())
+    {
+        f = fopen(options.resultsPath.c_str(), "w");
+
+        if (!f)
+        {
+            LLog::error("[louvre-bench] Failed to open %s.", options.resultsPath.c_str());
+            return false;
+        }
+    }
+
+    bool passed = true;
+    Float64 firstP95 = 0.0;
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"workload\": \"%s\",\n", options.workload.c_str());
+    fprintf(f, "  \"count\": %d,\n", options.count);
+    fprintf(f, "  \"duration_ms\": %u,\n", options.durationMs);
+    fprintf(f, "  \"warmup_ms\": %u,\n", options.warmupMs);
+    fprintf(f, "  \"seed\": %u,\n", options.seed);
+    fprintf(f, "  \"outputs\": [\n");
+
+    UInt32 outputIndex = 0;
+
+    for (Output *output : outputs)
+    {
+        const std::vector<FrameStats> frames = output->stats();
+        const UInt32 refresh = output->currentMode() ? output->currentMode()->refreshRate() : 0;
+
+        std::vector<UInt64> wallTimes, cpuTimes, damage;
+        UInt64 totalDamage = 0;
+        UInt64 totalCoarsened = 0;
+        UInt64 dropped = 0;
+
+        for (const FrameStats &frame : frames)
+        {
+            wallTimes.push_back(frame.wallTime);
+            cpuTimes.push_back(frame.cpuTime);
+            damage.push_back(frame.damageArea);
+            totalDamage += frame.damageArea;
+            totalCoarsened += frame.coarsenedArea;
+
+            // Vblanks missed between two consecutive frames
+            if (refresh > 0 && frame.interval > 0)
+            {
+                const Float64 period = 1000000000.0 / refresh;
+                const UInt64 vblanks = (UInt64)(frame.interval / period + 0.5);
+
+                if (vblanks > 1)
+                    dropped += vblanks - 1;
+            }
+        }
+
+        const Summary wallSummary = summarize(wallTimes);
+
+        if (outputIndex == 0)
+            firstP95 = wallSummary.p95;
+
+        fprintf(f, "    {\n");
+        fprintf(f, "      \"name\": \"%s\",\n", output->name());
+        fprintf(f, "      \"width\": %d,\n", output->currentMode() ? output->currentMode()->sizeB().w() : 0);
+        fprintf(f, "      \"height\": %d,\n", output->currentMode() ? output->currentMode()->sizeB().h() : 0);
+        fprintf(f, "      \"scale\": %d,\n", output->scale());
+        fprintf(f, "      \"refresh_mhz\": %u,\n", refresh);
+        fprintf(f, "      \"frames\": %u,\n", (UInt32)frames.size());
+        fprintf(f, "      \"fps\": %.2f,\n", frames.size() * 1000.0 / std::max(options.durationMs, 1u));
+        fprintf(f, "      \"dropped_frames\": %llu,\n", (unsigned long long)dropped);
+        writeSummary(f, "frame_time_us", wallSummary);
+        writeSummary(f, "cpu_time_us", summarize(cpuTimes));
+        writeSummary(f, "damage_px", summarize(damage));
+        fprintf(f, "      \"damage_px_total\": %llu,\n", (unsigned long long)totalDamage);
+        fprintf(f, "      \"coarsened_px_total\": %llu,\n", (unsigned long long)totalCoarsened);
+        fprintf(f, "      \"per_frame\": [");
+
+        for (size_t i = 0; i < frames.size(); i++)
+        {
+            const FrameStats &frame = frames[i];
+            fprintf(f, "%s\n        {\"t\": %llu, \"frame_time_us\": %u, \"cpu_time_us\": %u, \"interval_us\": %u, \"damage_px\": %llu, \"damage_boxes\": %u, \"raw_damage_boxes\": %u, \"coarsened_px\": %llu}",
+                    i == 0 ? "" : ",",
+                    (unsigned long long)frame.time,
+                    frame.wallTime,
+                    frame.cpuTime,
+                    frame.interval,
+                    (unsigned long long)frame.damageArea,
+                    frame.damageBoxes,
+                    frame.rawDamageBoxes,
+                    (unsigned long long)frame.coarsenedArea);
+        }
+
+        fprintf(f, "\n      ]\n");
+        fprintf(f, "    }%s\n", ++outputIndex == outputs.size() ? "" : ",");
+    }
+
+    fprintf(f, "  ],\n");
+    fprintf(f, "  \"shm_uploads\": {\"commits\": %llu, \"bytes\": %llu, \"bytes_per_commit\": %.1f, \"calls\": %llu, \"deferred\": %llu, \"skipped\": %llu, \"solid\": %llu, \"texture_bytes\": %llu}",
+            (unsigned long long)uploads.commits,
+            (unsigned long long)uploads.bytes,
+            uploads.commits == 0 ? 0.0 : Float64(uploads.bytes) / Float64(uploads.commits),
+            (unsigned long long)uploads.calls,
+            (unsigned long long)uploads.deferred,
+            (unsigned long long)uploads.skipped,
+            (unsigned long long)uploads.solid,
+            (unsigned long long)uploads.textureBytes);
+
+    if (!options.baselinePath.empty())
+    {
+        Float64 baselineP95;
+
+        if (readBaseline(options.baselinePath.c_str(), &baselineP95))
+        {
+            const Float64 change = 100.0 * (firstP95 - baselineP95) / baselineP95;
+            passed = change <= options.threshold;
+
+            fprintf(f, ",\n  \"baseline\": {\"path\": \"%s\", \"p95_frame_time_us\": %.1f, \"change_pct\": %.2f, \"threshold_pct\": %.2f, \"passed\": %s}",
+                    options.baselinePath.c_str(), baselineP95, change, options.threshold, passed ? "true" : "false");
+
+            if (!passed)
+                LLog::error("[louvre-bench] %s: p95 frame time regressed %.2f%% (%.1f us -> %.1f us).",
+                            options.workload.c_str(), change, baselineP95, firstP95);
+        }
+        else
+            LLog::warning("[louvre-bench] Could not read baseline %s, skipping comparison.", options.baselinePath.c_str());
+    }
+
+    fprintf(f, "\n}\n");
+
+    if (f != stdout)
+        fclose(f);
+
+    return passed;
+}
@@ -0,0 +1,35 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <LNamespaces.h>
+#include <list>
+
+#include "Bench.h"
+
+using namespace Louvre;
+
+class Output;
+
+// SHM buffer commits processed by the compositor during the recorded time
+struct UploadCounters
+{
+    UInt64 commits = 0;
+    UInt64 bytes = 0;
+    UInt64 calls = 0;
+    UInt64 deferred = 0;
+    UInt64 skipped = 0;
+    UInt64 solid = 0;
+
+    // Memory used by the SHM textures of all surfaces at the end
+    UInt64 textureBytes = 0;
+};
+
+namespace Report
+{
+    /* Writes the JSON results of the recorded frames and compares them with
+     * the baseline, if any. Returns false if the p95 frame time regressed
+     * by more than the configured threshold. */
+    bool write(const BenchOptions &options, const std::list<Output*> &outputs, const UploadCounters &uploads);
+};
+
+#endif // REPORT_H
@@ -0,0 +1,57 @@
+#include <LToplevelRole.h>
+#include <LCursor.h>
+#include <LOutput.h>
+
+#include "Bench.h"
+#include "Compositor.h"
+#include "Surface.h"
+
+Surface::Surface(LSurface::Params *params) : LSurface(params),
+    view(this, &Bench::compositor()->surfacesLayer) {}
+
+Surface::~Surface() {}
+
+void Surface::mappingChanged()
+{
+    if (mapped() && toplevel() && !toplevel()->maximized() && !toplevel()->fullscreen())
+    {
+        // Cascade toplevels so that they partially overlap
+        LOutput *output = cursor()->output();
+        const Int32 i = Bench::compositor()->mappedToplevels++;
+        const LSize free = output->size() - size();
+
+        setPos(output->pos() + LPoint(
+            free.w() > 0 ? (i * 37) % free.w() : 0,
+            free.h() > 0 ? (i * 23) % free.h() : 0));
+    }
+
+    compositor()->repaintAllOutputs();
+}
+
+void Surface::orderChanged()
+{
+    Surface *prev = (Surface*)prevSurface();
+
+    while (prev && prev->view.parent() != view.parent())
+        prev = (Surface*)prev->prevSurface();
+
+    view.insertAfter(prev ? &prev->view : nullptr, false);
+}
+
+void Surface::roleChanged()
+{
+    // Cursors are not rendered, only the compositor cost is measured
+    if (cursorRole())
+    {
+        view.setVisible(false);
+        view.setParent(nullptr);
+    }
+
+    repaintOutputs();
+}
+
+void Surface::minimizedChanged()
+{
+    view.setVisible(!minimized());
+    repaintOutputs();
+}
@@ -0,0 +1,23 @@
+#ifndef SURFACE_H
+#define SURFACE_H
+
+#include <LSurface.h>
+#include <LSurfaceView.h>
+
+using namespace Louvre;
+
+class Surface : public LSurface
+{
+public:
+    Surface(LSurface::Params *params);
+    ~Surface();
+
+    void mappingChanged() override;
+    void orderChanged() override;
+    void roleChanged() override;
+    void minimizedChanged() override;
+
+    LSurfaceView view;
+};
+
+#endif // SURFACE_H
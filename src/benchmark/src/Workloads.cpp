@@ -0,0 +1,847 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <time.h>
+#include <wayland-client.h>
+#include <xdg-shell-client-protocol.h>
+
+#include "Workloads.h"
+
+/*********************** Common helpers ***********************/
+
+static uint64_t monotonicUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000 + uint64_t(ts.tv_nsec) / 1000;
+}
+
+static void callbackHandleDone(void *data, wl_callback *callback, uint32_t)
+{
+    Workload *workload = (Workload*)data;
+    wl_callback_destroy(callback);
+    workload->frame((monotonicUs() - workload->startTime()) / 1000);
+}
+
+static const wl_callback_listener callbackListener =
+{
+    &callbackHandleDone
+};
+
+static uint32_t animatedColor(uint32_t ms)
+{
+    uint8_t r = (sinf(ms * 0.0015f) + 1.f) * 127.f;
+    uint8_t g = (cosf(ms * 0.0010f) + 1.f) * 127.f;
+    uint8_t b = (cosf(ms * 0.0005f) + 1.f) * 127.f;
+    return 0xFF000000 | (r << 16) | (g << 8) | b;
+}
+
+// xdg_toplevel with its configured size
+struct Window
+{
+    wl_surface *surface = nullptr;
+    xdg_surface *xdgSurface = nullptr;
+    xdg_toplevel *xdgToplevel = nullptr;
+    int32_t width = 0;
+    int32_t height = 0;
+};
+
+static void windowHandleSurfaceConfigure(void *, xdg_surface *xdgSurface, uint32_t serial)
+{
+    xdg_surface_ack_configure(xdgSurface, serial);
+}
+
+static const xdg_surface_listener windowSurfaceListener =
+{
+    &windowHandleSurfaceConfigure
+};
+
+static void windowHandleToplevelConfigure(void *data, xdg_toplevel *, int32_t width, int32_t height, wl_array *)
+{
+    Window *window = (Window*)data;
+
+    if (width > 0 && height > 0)
+    {
+        window->width = width;
+        window->height = height;
+    }
+}
+
+static void windowHandleToplevelClose(void *, xdg_toplevel *) {}
+
+static const xdg_toplevel_listener windowToplevelListener =
+{
+    &windowHandleToplevelConfigure,
+    &windowHandleToplevelClose
+};
+
+// Creates a toplevel and waits for its first configure (without a buffer attached)
+static void createWindow(Client *client, Window *window, int32_t width, int32_t height, bool maximized, bool fullscreen)
+{
+    window->surface = wl_compositor_create_surface(client->compositor);
+    window->xdgSurface = xdg_wm_base_get_xdg_surface(client->wmBase, window->surface);
+    window->xdgToplevel = xdg_surface_get_toplevel(window->xdgSurface);
+    xdg_surface_add_listener(window->xdgSurface, &windowSurfaceListener, window);
+    xdg_toplevel_add_listener(window->xdgToplevel, &windowToplevelListener, window);
+    wl_surface_set_buffer_scale(window->surface, client->outputScale);
+
+    if (maximized)
+        xdg_toplevel_set_maximized(window->xdgToplevel);
+
+    if (fullscreen)
+        xdg_toplevel_set_fullscreen(window->xdgToplevel, client->output);
+
+    window->width = width;
+    window->height = height;
+    wl_surface_commit(window->surface);
+    wl_display_roundtrip(client->display);
+}
+
+static void destroyWindow(Window *window)
+{
+    xdg_toplevel_destroy(window->xdgToplevel);
+    xdg_surface_destroy(window->xdgSurface);
+    wl_surface_destroy(window->surface);
+}
+
+static void setOpaque(Client *client, wl_surface *surface, int32_t width, int32_t height)
+{
+    wl_region *region = wl_compositor_create_region(client->compositor);
+    wl_region_add(region, 0, 0, width, height);
+    wl_surface_set_opaque_region(surface, region);
+    wl_region_destroy(region);
+}
+
+/*********************** Subsurfaces ***********************/
+
+/* The original LBenchmark workload: a maximized toplevel with a 10px
+ * tall band updated each frame and N moving 512x512 subsurfaces.
+ * Even subsurfaces are opaque and odd ones translucent. */
+class SubsurfacesWorkload : public Workload
+{
+public:
+    SubsurfacesWorkload(int32_t count) : Workload(count < 0 ? 16 : count) {}
+
+    const char *name() const override { return "subsurfaces"; }
+
+    bool init(Client *c) override
+    {
+        client = c;
+        const int32_t s = client->outputScale;
+
+        createWindow(client, &parent, client->outputWidth / s, client->outputHeight / s, true, false);
+
+        parentBuffer = client->createBuffer(parent.width * s, parent.height * s, 0xFFFFFFFF);
+        opaqueBuffer = client->createBuffer(childSize * s, childSize * s, 0xFF0000FF);
+        translucentBuffer = client->createBuffer(childSize * s, childSize * s, 0x64000064);
+
+        if (!parentBuffer || !opaqueBuffer || !translucentBuffer)
+            return false;
+
+        childRegion = wl_compositor_create_region(client->compositor);
+        wl_region_add(childRegion, 0, 0, childSize, childSize);
+
+        setOpaque(client, parent.surface, parent.width, parent.height);
+        wl_surface_attach(parent.surface, parentBuffer->buffer, 0, 0);
+        wl_surface_damage(parent.surface, 0, 0, parent.width, parent.height);
+        wl_surface_commit(parent.surface);
+
+        children.resize(count);
+
+        for (Child &child : children)
+        {
+            child.phaseX = 6.28f * (float)(rand() % 10000) / 10000.f;
+            child.phaseY = 6.28f * (float)(rand() % 10000) / 10000.f;
+            child.speed = 0.01f + 0.1f * (float)(rand() % 10000) / 10000.f;
+            child.surface = wl_compositor_create_surface(client->compositor);
+            child.subsurface = wl_subcompositor_get_subsurface(client->subcompositor, child.surface, parent.surface);
+            wl_subsurface_set_desync(child.subsurface);
+            wl_subsurface_set_position(child.subsurface, 0, 0);
+            wl_surface_set_buffer_scale(child.surface, s);
+
+            const bool opaque = (&child - &children[0]) % 2 == 0;
+            wl_surface_attach(child.surface, opaque ? opaqueBuffer->buffer : translucentBuffer->buffer, 0, 0);
+            wl_surface_set_opaque_region(child.surface, opaque ? childRegion : NULL);
+            wl_surface_damage(child.surface, 0, 0, childSize, childSize);
+            wl_surface_commit(child.surface);
+        }
+
+        wl_surface_commit(parent.surface);
+        wl_display_roundtrip(client->display);
+        return true;
+    }
+
+    void uninit() override
+    {
+        for (Child &child : children)
+        {
+            wl_subsurface_destroy(child.subsurface);
+            wl_surface_destroy(child.surface);
+        }
+
+        wl_region_destroy(childRegion);
+        destroyWindow(&parent);
+        client->destroyBuffer(parentBuffer);
+        client->destroyBuffer(opaqueBuffer);
+        client->destroyBuffer(translucentBuffer);
+    }
+
+    void frame(uint32_t ms) override
+    {
+        const float t = ms / 50.f;
+
+        for (uint32_t i = 0; i < children.size(); i++)
+        {
+            Child &child = children[i];
+            int32_t x = (parent.width - childSize) * (sinf(child.phaseX + t * child.speed) + 1.f) / 2.f;
+            int32_t y = (parent.height - childSize) * (sinf(child.phaseY + t * child.speed) + 1.f) / 2.f;
+            wl_subsurface_set_position(child.subsurface, x, y);
+            wl_surface_set_opaque_region(child.surface, i % 2 == 0 ? childRegion : NULL);
+        }
+
+        client->fillBuffer(parentBuffer, 0, bandHeight * client->outputScale, animatedColor(ms));
+
+        requestFrame(parent.surface);
+        wl_surface_attach(parent.surface, parentBuffer->buffer, 0, 0);
+        wl_surface_damage(parent.surface, 0, 0, parent.width, bandHeight);
+        wl_surface_commit(parent.surface);
+    }
+
+private:
+    struct Child
+    {
+        wl_surface *surface;
+        wl_subsurface *subsurface;
+        float phaseX;
+        float phaseY;
+        float speed;
+    };
+
+    static const int32_t childSize = 512;
+    static const int32_t bandHeight = 10;
+
+    Window parent;
+    std::vector<Child> children;
+    ShmBuffer *parentBuffer = nullptr;
+    ShmBuffer *opaqueBuffer = nullptr;
+    ShmBuffer *translucentBuffer = nullptr;
+    wl_region *childRegion = nullptr;
+};
+
+/*********************** Toplevels ***********************/
+
+/* Many overlapping opaque toplevels, each one updating a 16px
+ * tall band at a different position every frame. */
+class ToplevelsWorkload : public Workload
+{
+public:
+    ToplevelsWorkload(int32_t count) : Workload(count < 0 ? 32 : count) {}
+
+    const char *name() const override { return "toplevels"; }
+
+    bool init(Client *c) override
+    {
+        client = c;
+        const int32_t s = client->outputScale;
+        windows.resize(count);
+        buffers.resize(count);
+
+        for (int32_t i = 0; i < count; i++)
+        {
+            createWindow(client, &windows[i], width, height, false, false);
+            buffers[i] = client->createBuffer(width * s, height * s, 0xFF202020 | (rand() & 0x00FFFFFF));
+
+            if (!buffers[i])
+                return false;
+
+            setOpaque(client, windows[i].surface, width, height);
+            wl_surface_attach(windows[i].surface, buffers[i]->buffer, 0, 0);
+            wl_surface_damage(windows[i].surface, 0, 0, width, height);
+            wl_surface_commit(windows[i].surface);
+        }
+
+        wl_display_roundtrip(client->display);
+        return true;
+    }
+
+    void uninit() override
+    {
+        for (int32_t i = 0; i < count; i++)
+        {
+            destroyWindow(&windows[i]);
+            client->destroyBuffer(buffers[i]);
+        }
+    }
+
+    void frame(uint32_t ms) override
+    {
+        const int32_t s = client->outputScale;
+
+        for (int32_t i = 0; i < count; i++)
+        {
+            const int32_t y = (ms / 4 + i * 7) % (height - bandHeight);
+            client->fillBuffer(buffers[i], y * s, bandHeight * s, animatedColor(ms + i * 100));
+
+            if (i == 0)
+                requestFrame(windows[i].surface);
+
+            wl_surface_attach(windows[i].surface, buffers[i]->buffer, 0, 0);
+            wl_surface_damage(windows[i].surface, 0, y, width, bandHeight);
+            wl_surface_commit(windows[i].surface);
+        }
+    }
+
+private:
+    static const int32_t width = 320;
+    static const int32_t height = 240;
+    static const int32_t bandHeight = 16;
+
+    std::vector<Window> windows;
+    std::vector<ShmBuffer*> buffers;
+};
+
+/*********************** Popups ***********************/
+
+struct Popup
+{
+    wl_surface *surface;
+    xdg_surface *xdgSurface;
+    xdg_popup *xdgPopup;
+    ShmBuffer *buffer;
+    int32_t width;
+    int32_t height;
+};
+
+static void popupHandleSurfaceConfigure(void *data, xdg_surface *xdgSurface, uint32_t serial)
+{
+    Popup *popup = (Popup*)data;
+    xdg_surface_ack_configure(xdgSurface, serial);
+    wl_surface_attach(popup->surface, popup->buffer->buffer, 0, 0);
+    wl_surface_damage(popup->surface, 0, 0, popup->width, popup->height);
+    wl_surface_commit(popup->surface);
+}
+
+static const xdg_surface_listener popupSurfaceListener =
+{
+    &popupHandleSurfaceConfigure
+};
+
+static void popupHandleConfigure(void *, xdg_popup *, int32_t, int32_t, int32_t, int32_t) {}
+static void popupHandleDone(void *, xdg_popup *) {}
+static void popupHandleRepositioned(void *, xdg_popup *, uint32_t) {}
+
+static const xdg_popup_listener popupListener =
+{
+    &popupHandleConfigure,
+    &popupHandleDone,
+    &popupHandleRepositioned
+};
+
+/* A toplevel whose popups are all destroyed and recreated at random
+ * positions every frame, stressing surface creation and mapping. */
+class PopupsWorkload : public Workload
+{
+public:
+    PopupsWorkload(int32_t count) : Workload(count < 0 ? 8 : count) {}
+
+    const char *name() const override { return "popups"; }
+
+    bool init(Client *c) override
+    {
+        client = c;
+        const int32_t s = client->outputScale;
+
+        createWindow(client, &parent, 800, 600, false, false);
+        parentBuffer = client->createBuffer(parent.width * s, parent.height * s, 0xFFE0E0E0);
+        popupBuffer = client->createBuffer(popupWidth * s, popupHeight * s, 0xFF3060C0);
+
+        if (!parentBuffer || !popupBuffer)
+            return false;
+
+        setOpaque(client, parent.surface, parent.width, parent.height);
+        wl_surface_attach(parent.surface, parentBuffer->buffer, 0, 0);
+        wl_surface_damage(parent.surface, 0, 0, parent.width, parent.height);
+        wl_surface_commit(parent.surface);
+        wl_display_roundtrip(client->display);
+        popups.resize(count);
+
+        for (Popup &popup : popups)
+            popup.surface = nullptr;
+
+        return true;
+    }
+
+    void destroyPopups()
+    {
+        // Destroyed in reverse order so that the topmost popup always goes first
+        for (std::vector<Popup>::reverse_iterator it = popups.rbegin(); it != popups.rend(); it++)
+        {
+            if (!it->surface)
+                continue;
+
+            xdg_popup_destroy(it->xdgPopup);
+            xdg_surface_destroy(it->xdgSurface);
+            wl_surface_destroy(it->surface);
+            it->surface = nullptr;
+        }
+    }
+
+    void uninit() override
+    {
+        destroyPopups();
+        destroyWindow(&parent);
+        client->destroyBuffer(parentBuffer);
+        client->destroyBuffer(popupBuffer);
+    }
+
+    void frame(uint32_t ms) override
+    {
+        destroyPopups();
+
+        for (Popup &popup : popups)
+        {
+            popup.width = popupWidth;
+            popup.height = popupHeight;
+            popup.buffer = popupBuffer;
+            popup.surface = wl_compositor_create_surface(client->compositor);
+            popup.xdgSurface = xdg_wm_base_get_xdg_surface(client->wmBase, popup.surface);
+            xdg_surface_add_listener(popup.xdgSurface, &popupSurfaceListener, &popup);
+            wl_surface_set_buffer_scale(popup.surface, client->outputScale);
+
+            xdg_positioner *positioner = xdg_wm_base_create_positioner(client->wmBase);
+            xdg_positioner_set_size(positioner, popupWidth, popupHeight);
+            xdg_positioner_set_anchor_rect(positioner,
+                                           rand() % (parent.width - popupWidth),
+                                           rand() % (parent.height - popupHeight),
+                                           1, 1);
+            xdg_positioner_set_anchor(positioner, XDG_POSITIONER_ANCHOR_TOP_LEFT);
+            xdg_positioner_set_gravity(positioner, XDG_POSITIONER_GRAVITY_BOTTOM_RIGHT);
+            popup.xdgPopup = xdg_surface_get_popup(popup.xdgSurface, parent.xdgSurface, positioner);
+            xdg_popup_add_listener(popup.xdgPopup, &popupListener, &popup);
+            xdg_positioner_destroy(positioner);
+
+            // The buffer is attached after the initial configure
+            wl_surface_commit(popup.surface);
+        }
+
+        client->fillBuffer(parentBuffer, 0, 10 * client->outputScale, animatedColor(ms));
+        requestFrame(parent.surface);
+        wl_surface_attach(parent.surface, parentBuffer->buffer, 0, 0);
+        wl_surface_damage(parent.surface, 0, 0, parent.width, 10);
+        wl_surface_commit(parent.surface);
+    }
+
+private:
+    static const int32_t popupWidth = 160;
+    static const int32_t popupHeight = 120;
+
+    Window parent;
+    ShmBuffer *parentBuffer = nullptr;
+    ShmBuffer *popupBuffer = nullptr;
+    std::vector<Popup> popups;
+};
+
+/*********************** Resize ***********************/
+
+/* A toplevel whose size changes every frame, so a texture of a
+ * different size is uploaded each time. */
+class ResizeWorkload : public Workload
+{
+public:
+    ResizeWorkload(int32_t count) : Workload(count) {}
+
+    const char *name() const override { return "resize"; }
+
+    bool init(Client *c) override
+    {
+        client = c;
+        const int32_t s = client->outputScale;
+        maxWidth = client->outputWidth / s;
+        maxHeight = client->outputHeight / s;
+
+        createWindow(client, &window, minSize, minSize, false, false);
+        pool = client->createPool(maxWidth * s, maxHeight * s, 0xFF408040);
+        return pool != nullptr;
+    }
+
+    void uninit() override
+    {
+        destroyWindow(&window);
+        client->destroyPool(pool);
+    }
+
+    void frame(uint32_t ms) override
+    {
+        const int32_t s = client->outputScale;
+        const int32_t w = minSize + (maxWidth - minSize) * (sinf(ms * 0.004f) + 1.f) / 2.f;
+        const int32_t h = minSize + (maxHeight - minSize) * (cosf(ms * 0.003f) + 1.f) / 2.f;
+
+        requestFrame(window.surface);
+        wl_surface_attach(window.surface, client->createPoolBuffer(pool, w * s, h * s), 0, 0);
+        setOpaque(client, window.surface, w, h);
+        wl_surface_damage(window.surface, 0, 0, w, h);
+        wl_surface_commit(window.surface);
+    }
+
+private:
+    static const int32_t minSize = 64;
+
+    Window window;
+    ShmPool *pool = nullptr;
+    int32_t maxWidth, maxHeight;
+};
+
+/*********************** Video ***********************/
+
+/* A fullscreen toplevel fully repainted every frame, like a video
+ * player cycling through a few buffers. */
+class VideoWorkload : public Workload
+{
+public:
+    VideoWorkload(int32_t count) : Workload(count < 0 ? 3 : count) {}
+
+    const char *name() const override { return "video"; }
+
+    bool init(Client *c) override
+    {
+        client = c;
+        const int32_t s = client->outputScale;
+
+        createWindow(client, &window, client->outputWidth / s, client->outputHeight / s, false, true);
+
+        // The count is the number of buffers in the swapchain
+        for (int32_t i = 0; i < std::max(count, 1); i++)
+        {
+            ShmBuffer *buffer = client->createBuffer(window.width * s, window.height * s, 0xFF000000);
+
+            if (!buffer)
+                return false;
+
+            buffers.push_back(buffer);
+        }
+
+        setOpaque(client, window.surface, window.width, window.height);
+        return true;
+    }
+
+    void uninit() override
+    {
+        destroyWindow(&window);
+
+        for (ShmBuffer *buffer : buffers)
+            client->destroyBuffer(buffer);
+    }
+
+    void frame(uint32_t ms) override
+    {
+        ShmBuffer *buffer = buffers[next];
+
+        // Pick the first released buffer, or reuse the oldest one
+        for (uint32_t i = 0; i < buffers.size(); i++)
+        {
+            if (!buffers[(next + i) % buffers.size()]->busy)
+            {
+                buffer = buffers[(next + i) % buffers.size()];
+                next = (next + i + 1) % buffers.size();
+                break;
+            }
+        }
+
+        // Moving horizontal gradient
+        for (int32_t y = 0; y < buffer->height; y++)
+            client->fillBuffer(buffer, y, 1, animatedColor(ms + y * 4));
+
+        buffer->busy = true;
+        requestFrame(window.surface);
+        wl_surface_attach(window.surface, buffer->buffer, 0, 0);
+        wl_surface_damage(window.surface, 0, 0, window.width, window.height);
+        wl_surface_commit(window.surface);
+    }
+
+private:
+    Window window;
+    std::vector<ShmBuffer*> buffers;
+    uint32_t next = 0;
+};
+
+/*********************** Hidden ***********************/
+
+/* A toplevel updating a 10px tall band each frame and --count minimized
+ * 512x512 toplevels fully repainted every frame, whose textures are not
+ * used by the compositor (see LOUVRE_LAZY_SHM_UPLOAD). */
+class HiddenWorkload : public Workload
+{
+public:
+    HiddenWorkload(int32_t count) : Workload(count < 0 ? 16 : count) {}
+
+    const char *name() const override { return "hidden"; }
+
+    bool init(Client *c) override
+    {
+        client = c;
+        const int32_t s = client->outputScale;
+
+        createWindow(client, &driver, 800, 600, false, false);
+        driverBuffer = client->createBuffer(driver.width * s, driver.height * s, 0xFFE0E0E0);
+
+        if (!driverBuffer)
+            return false;
+
+        setOpaque(client, driver.surface, driver.width, driver.height);
+        wl_surface_attach(driver.surface, driverBuffer->buffer, 0, 0);
+        wl_surface_damage(driver.surface, 0, 0, driver.width, driver.height);
+        wl_surface_commit(driver.surface);
+
+        windows.resize(count);
+        buffers.resize(count);
+
+        for (int32_t i = 0; i < count; i++)
+        {
+            createWindow(client, &windows[i], size, size, false, false);
+            buffers[i] = client->createBuffer(size * s, size * s, 0xFF000000);
+
+            if (!buffers[i])
+                return false;
+
+            setOpaque(client, windows[i].surface, size, size);
+            wl_surface_attach(windows[i].surface, buffers[i]->buffer, 0, 0);
+            wl_surface_damage(windows[i].surface, 0, 0, size, size);
+            wl_surface_commit(windows[i].surface);
+            xdg_toplevel_set_minimized(windows[i].xdgToplevel);
+        }
+
+        wl_display_roundtrip(client->display);
+        return true;
+    }
+
+    void uninit() override
+    {
+        for (int32_t i = 0; i < count; i++)
+        {
+            destroyWindow(&windows[i]);
+            client->destroyBuffer(buffers[i]);
+        }
+
+        destroyWindow(&driver);
+        client->destroyBuffer(driverBuffer);
+    }
+
+    void frame(uint32_t ms) override
+    {
+        const int32_t s = client->outputScale;
+
+        for (int32_t i = 0; i < count; i++)
+        {
+            client->fillBuffer(buffers[i], 0, size * s, animatedColor(ms + i * 100));
+            wl_surface_attach(windows[i].surface, buffers[i]->buffer, 0, 0);
+            wl_surface_damage(windows[i].surface, 0, 0, size, size);
+            wl_surface_commit(windows[i].surface);
+        }
+
+        client->fillBuffer(driverBuffer, 0, 10 * s, animatedColor(ms));
+        requestFrame(driver.surface);
+        wl_surface_attach(driver.surface, driverBuffer->buffer, 0, 0);
+        wl_surface_damage(driver.surface, 0, 0, driver.width, 10);
+        wl_surface_commit(driver.surface);
+    }
+
+private:
+    static const int32_t size = 512;
+
+    Window driver;
+    ShmBuffer *driverBuffer = nullptr;
+    std::vector<Window> windows;
+    std::vector<ShmBuffer*> buffers;
+};
+
+/*********************** Flood ***********************/
+
+/* A 512x512 toplevel fully repainted and committed --count times per
+ * frame, like a client rendering faster than the refresh rate (see
+ * LSurface::enableCommitCoalescing()). */
+class FloodWorkload : public Workload
+{
+public:
+    FloodWorkload(int32_t count) : Workload(count < 0 ? 4 : count) {}
+
+    const char *name() const override { return "flood"; }
+
+    bool init(Client *c) override
+    {
+        client = c;
+        const int32_t s = client->outputScale;
+
+        createWindow(client, &window, size, size, false, false);
+
+        for (int32_t i = 0; i < 3; i++)
+        {
+            ShmBuffer *buffer = client->createBuffer(size * s, size * s, 0xFF000000);
+
+            if (!buffer)
+                return false;
+
+            buffers.push_back(buffer);
+        }
+
+        setOpaque(client, window.surface, size, size);
+        return true;
+    }
+
+    void uninit() override
+    {
+        destroyWindow(&window);
+
+        for (ShmBuffer *buffer : buffers)
+            client->destroyBuffer(buffer);
+    }
+
+    void frame(uint32_t ms) override
+    {
+        for (int32_t i = 0; i < std::max(count, 1); i++)
+        {
+            ShmBuffer *buffer = buffers[next];
+            uint32_t j = 0;
+
+            // Pick the first released buffer, or reuse the oldest one
+            while (j < buffers.size() && buffers[(next + j) % buffers.size()]->busy)
+                j++;
+
+            if (j < buffers.size())
+                buffer = buffers[(next + j) % buffers.size()];
+            else
+                j = 0;
+
+            next = (next + j + 1) % buffers.size();
+
+            for (int32_t y = 0; y < buffer->height; y++)
+                client->fillBuffer(buffer, y, 1, animatedColor(ms + i * 4 + y * 4));
+
+            buffer->busy = true;
+
+            if (i == std::max(count, 1) - 1)
+                requestFrame(window.surface);
+
+            wl_surface_attach(window.surface, buffer->buffer, 0, 0);
+            wl_surface_damage(window.surface, 0, 0, size, size);
+            wl_surface_commit(window.surface);
+        }
+    }
+
+private:
+    static const int32_t size = 512;
+
+    Window window;
+    std::vector<ShmBuffer*> buffers;
+    uint32_t next = 0;
+};
+
+/*********************** Solid ***********************/
+
+/* --count 512x512 toplevels fully repainted with a single color each
+ * frame, like splash screens or blank backgrounds (see
+ * LOUVRE_SOLID_COLOR_DETECTION). */
+class SolidWorkload : public Workload
+{
+public:
+    SolidWorkload(int32_t count) : Workload(count < 0 ? 8 : count) {}
+
+    const char *name() const override { return "solid"; }
+
+    bool init(Client *c) override
+    {
+        client = c;
+        const int32_t s = client->outputScale;
+
+        windows.resize(count);
+        buffers.resize(count);
+
+        for (int32_t i = 0; i < count; i++)
+        {
+            createWindow(client, &windows[i], size, size, false, false);
+            buffers[i] = client->createBuffer(size * s, size * s, 0xFF000000);
+
+            if (!buffers[i])
+                return false;
+
+            setOpaque(client, windows[i].surface, size, size);
+        }
+
+        return true;
+    }
+
+    void uninit() override
+    {
+        for (int32_t i = 0; i < count; i++)
+        {
+            destroyWindow(&windows[i]);
+            client->destroyBuffer(buffers[i]);
+        }
+    }
+
+    void frame(uint32_t ms) override
+    {
+        const int32_t s = client->outputScale;
+
+        for (int32_t i = 0; i < count; i++)
+        {
+            client->fillBuffer(buffers[i], 0, size * s, animatedColor(ms + i * 100));
+
+            if (i == 0)
+                requestFrame(windows[i].surface);
+
+            wl_surface_attach(windows[i].surface, buffers[i]->buffer, 0, 0);
+            wl_surface_damage(windows[i].surface, 0, 0, size, size);
+            wl_surface_commit(windows[i].surface);
+        }
+    }
+
+private:
+    static const int32_t size = 512;
+
+    std::vector<Window> windows;
+    std::vector<ShmBuffer*> buffers;
+};
+
+/*********************** Workload ***********************/
+
+Workload::~Workload() {}
+
+Workload *Workload::create(const std::string &name, int32_t count)
+{
+    if (name == "subsurfaces")
+        return new SubsurfacesWorkload(count);
+    else if (name == "toplevels")
+        return new ToplevelsWorkload(count);
+    else if (name == "popups")
+        return new PopupsWorkload(count);
+    else if (name == "resize")
+        return new ResizeWorkload(count);
+    else if (name == "video")
+        return new VideoWorkload(count);
+    else if (name == "hidden")
+        return new HiddenWorkload(count);
+    else if (name == "flood")
+        return new FloodWorkload(count);
+    else if (name == "solid")
+        return new SolidWorkload(count);
+
+    return nullptr;
+}
+
+const char *Workload::available()
+{
+    return "subsurfaces, toplevels, popups, resize, video, hidden, flood, solid";
+}
+
+void Workload::start()
+{
+    m_startTime = monotonicUs();
+    frame(0);
+}
+
+void Workload::requestFrame(wl_surface *surface)
+{
+    wl_callback *callback = wl_surface_frame(surface);
+    wl_callback_add_listener(callback, &callbackListener, this);
+}
@@ -0,0 +1,51 @@
+#ifndef WORKLOADS_H
+#define WORKLOADS_H
+
+#include <cstdint>
+#include <string>
+
+#include "Client.h"
+
+struct wl_surface;
+
+/* Base class of the client workloads. Workloads are driven by the frame
+ * callbacks of a single surface, so a new frame is only produced once the
+ * compositor presented the previous one. */
+class Workload
+{
+public:
+    virtual ~Workload();
+
+    // Returns nullptr if there is no workload with the given name
+    static Workload *create(const std::string &name, int32_t count);
+
+    // Comma separated list of available workloads
+    static const char *available();
+
+    virtual const char *name() const = 0;
+    virtual bool init(Client *client) = 0;
+    virtual void uninit() = 0;
+
+    // Produces the first frame
+    void start();
+
+    // Called when the previous frame is presented, ms since start()
+    virtual void frame(uint32_t ms) = 0;
+
+    // Time start() was called (us)
+    uint64_t startTime() const { return m_startTime; }
+
+protected:
+    Workload(int32_t count) : count(count) {}
+
+    // Must be called before committing the surface that drives the workload
+    void requestFrame(wl_surface *surface);
+
+    Client *client = nullptr;
+    int32_t count;
+
+private:
+    uint64_t m_startTime = 0;
+};
+
+#endif // WORKLOADS_H
@@ -0,0 +1,334 @@
+#include <private/LCompositorPrivate.h>
+#include <private/LSurfacePrivate.h>
+#include <LLog.h>
+#include <LInputTrace.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <time.h>
+
+#include "Bench.h"
+#include "Client.h"
+#include "Coarsening.h"
+#include "Compositor.h"
+#include "HitTest.h"
+#include "Output.h"
+#include "Report.h"
+#include "Workloads.h"
+
+// Exit code meson interprets as a skipped test
+#define EXIT_SKIP 77
+
+#ifndef BENCH_GRAPHIC_BACKEND
+#define BENCH_GRAPHIC_BACKEND "/usr/etc/Louvre/backends/libLGraphicBackendHeadless.so"
+#endif
+
+#ifndef BENCH_INPUT_BACKEND
+#define BENCH_INPUT_BACKEND "/usr/etc/Louvre/backends/libLInputBackendScripted.so"
+#endif
+
+static Compositor *s_compositor = nullptr;
+static BenchOptions s_options;
+
+UInt64 Bench::monotonicUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return UInt64(ts.tv_sec) * 1000000 + UInt64(ts.tv_nsec) / 1000;
+}
+
+UInt64 Bench::threadCpuUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return UInt64(ts.tv_sec) * 1000000 + UInt64(ts.tv_nsec) / 1000;
+}
+
+Compositor *Bench::compositor()
+{
+    return s_compositor;
+}
+
+const BenchOptions &Bench::options()
+{
+    return s_options;
+}
+
+static void readUploadCounters(UploadCounters *counters)
+{
+    const LCompositor::LCompositorPrivate::UploadStats &stats = s_compositor->imp()->uploadStats;
+    counters->commits = stats.commits;
+    counters->bytes = stats.bytes;
+    counters->calls = stats.calls;
+    counters->deferred = stats.deferred;
+    counters->skipped = stats.skipped;
+    counters->solid = stats.solid;
+}
+
+// Size of the SHM textures of all surfaces, including the second texture used by async uploads
+static UInt64 shmTextureBytes()
+{
+    UInt64 bytes = 0;
+
+    for (LSurface *surface : s_compositor->surfaces())
+    {
+        for (LTexture *texture : {surface->imp()->textureBackup, surface->imp()->uploadTexture})
+            if (texture && texture->initialized() && texture->sourceType() == LTexture::CPU)
+                bytes += UInt64(texture->sizeB().area()) * LTexture::formatBytesPerPixel(texture->format());
+    }
+
+    return bytes;
+}
+
+static void usage()
+{
+    printf("Usage: louvre-bench [options]\n\n");
+    printf("  --workload NAME     One of: %s (default subsurfaces)\n", Workload::available());
+    printf("  --count N           Number of surfaces used by the workload\n");
+    printf("  --duration MS       Recorded time (default 5000)\n");
+    printf("  --warmup MS         Time before recording starts (default 1000)\n");
+    printf("  --seed N            Random seed (default 1)\n");
+    printf("  --outputs SPEC      Headless outputs, see LOUVRE_HEADLESS_OUTPUTS (default 1920x1080@60)\n");
+    printf("  --results PATH      Write the JSON results to PATH instead of stdout\n");
+    printf("  --baseline PATH     Fail if the p95 frame time regressed compared to a previous result\n");
+    printf("  --threshold PCT     Allowed p95 frame time regression (default 10)\n");
+    printf("  --no-input          Do not replay the synthetic pointer trace\n");
+    printf("  --micro NAME        Run a microbenchmark instead of a workload: hittest, coarsening\n");
+}
+
+static bool parseArgs(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (strcmp(arg, "--no-input") == 0)
+        {
+            s_options.input = false;
+            continue;
+        }
+
+        if (strcmp(arg, "--help") == 0 || !value)
+            return false;
+
+        if (strcmp(arg, "--workload") == 0)
+            s_options.workload = value;
+        else if (strcmp(arg, "--count") == 0)
+            s_options.count = atoi(value);
+        else if (strcmp(arg, "--duration") == 0)
+            s_options.durationMs = atoi(value);
+        else if (strcmp(arg, "--warmup") == 0)
+            s_options.warmupMs = atoi(value);
+        else if (strcmp(arg, "--seed") == 0)
+            s_options.seed = atoi(value);
+        else if (strcmp(arg, "--outputs") == 0)
+            s_options.outputs = value;
+        else if (strcmp(arg, "--results") == 0)
+            s_options.resultsPath = value;
+        else if (strcmp(arg, "--baseline") == 0)
+            s_options.baselinePath = value;
+        else if (strcmp(arg, "--threshold") == 0)
+            s_options.threshold = atof(value);
+        else if (strcmp(arg, "--micro") == 0)
+            s_options.micro = value;
+        else
+            return false;
+
+        i++;
+    }
+
+    return true;
+}
+
+// Pointer moving in circles over the first output, replayed in a loop by the Scripted backend
+static bool writePointerTrace(const char *path)
+{
+    Int32 width = 1920, height = 1080;
+    sscanf(s_options.outputs.c_str(), "%dx%d", &width, &height);
+
+    FILE *file = fopen(path, "w");
+
+    if (!file)
+        return false;
+
+    LInputTraceEvent event;
+    memset(&event, 0, sizeof(event));
+    event.type = LInputTracePointerMotion;
+    event.code = 1;
+
+    // 2 seconds at 125 Hz
+    for (UInt32 i = 0; i < 250; i++)
+    {
+        const Float32 angle = 2.f * M_PI * i / 250.f;
+        event.time = i * 8000;
+        event.values[0] = width * (0.5f + 0.4f * cosf(angle));
+        event.values[1] = height * (0.5f + 0.4f * sinf(2.f * angle));
+        inputTraceWriteEvent(file, true, event);
+    }
+
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (!parseArgs(argc, argv))
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    if (s_options.baselinePath.empty() && getenv("LOUVRE_BENCH_BASELINE"))
+        s_options.baselinePath = getenv("LOUVRE_BENCH_BASELINE");
+
+    struct stat st;
+
+    // A directory with the results of a previous run
+    if (!s_options.baselinePath.empty() && stat(s_options.baselinePath.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+        s_options.baselinePath += "/bench-" + s_options.workload + ".json";
+
+    if (!s_options.micro.empty() && s_options.micro != "hittest" && s_options.micro != "coarsening")
+    {
+        LLog::fatal("[louvre-bench] Unknown microbenchmark %s.", s_options.micro.c_str());
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    Workload *workload = s_options.micro.empty() ? Workload::create(s_options.workload, s_options.count) : nullptr;
+
+    if (!workload && s_options.micro.empty())
+    {
+        LLog::fatal("[louvre-bench] Unknown workload %s.", s_options.workload.c_str());
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    srand(s_options.seed);
+
+    // Wayland needs a runtime dir, CI environments often lack one
+    char runtimeDir[] = "/tmp/louvre-bench-XXXXXX";
+    bool tmpRuntimeDir = false;
+
+    if (!getenv("XDG_RUNTIME_DIR"))
+    {
+        if (!mkdtemp(runtimeDir))
+        {
+            LLog::fatal("[louvre-bench] Failed to create XDG_RUNTIME_DIR.");
+            return EXIT_SKIP;
+        }
+
+        setenv("XDG_RUNTIME_DIR", runtimeDir, 1);
+        tmpRuntimeDir = true;
+    }
+
+    char socket[64];
+    snprintf(socket, sizeof(socket), "louvre-bench-%d", getpid());
+    setenv("LOUVRE_WAYLAND_DISPLAY", socket, 1);
+    setenv("LOUVRE_HEADLESS_OUTPUTS", s_options.outputs.c_str(), 1);
+
+    char tracePath[256];
+    snprintf(tracePath, sizeof(tracePath), "%s/%s.trace.json", getenv("XDG_RUNTIME_DIR"), socket);
+
+    if (s_options.input && s_options.micro.empty() && writePointerTrace(tracePath))
+    {
+        setenv("LOUVRE_INPUT_TRACE", tracePath, 1);
+        setenv("LOUVRE_INPUT_TRACE_LOOP", "1", 1);
+    }
+    else
+        setenv("LOUVRE_INPUT_TRACE", "/dev/null", 1);
+
+    s_compositor = new Compositor();
+
+    if (!s_compositor->loadGraphicBackend(BENCH_GRAPHIC_BACKEND) ||
+        !s_compositor->loadInputBackend(BENCH_INPUT_BACKEND) ||
+        !s_compositor->start())
+    {
+        LLog::fatal("[louvre-bench] Failed to start the headless compositor, skipping.");
+        unlink(tracePath);
+        return EXIT_SKIP;
+    }
+
+    // Microbenchmarks run in the compositor thread without clients
+    if (!s_options.micro.empty())
+    {
+        const bool passed = s_options.micro == "hittest" ? HitTest::run(s_options) : Coarsening::run(s_options);
+        s_compositor->finish();
+        unlink(tracePath);
+
+        if (tmpRuntimeDir)
+            rmdir(runtimeDir);
+
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    Client client(socket);
+    std::atomic<bool> clientFailed(false);
+
+    std::thread clientThread([&client, &clientFailed, workload]()
+    {
+        clientFailed = !client.run(workload);
+        client.finished = true;
+    });
+
+    const UInt64 start = Bench::monotonicUs();
+    const UInt64 recordStart = start + s_options.warmupMs * 1000;
+    const UInt64 recordEnd = recordStart + s_options.durationMs * 1000;
+    UploadCounters uploadsStart, uploads;
+
+    while (!client.finished)
+    {
+        s_compositor->processLoop(10);
+
+        const UInt64 now = Bench::monotonicUs();
+
+        if (!s_compositor->recording && now >= recordStart && now < recordEnd)
+        {
+            for (LOutput *output : s_compositor->outputs())
+                ((Output*)output)->resetStats(now);
+
+            readUploadCounters(&uploadsStart);
+            s_compositor->recording = true;
+        }
+        else if (now >= recordEnd)
+        {
+            readUploadCounters(&uploads);
+            uploads.commits -= uploadsStart.commits;
+            uploads.bytes -= uploadsStart.bytes;
+            uploads.calls -= uploadsStart.calls;
+            uploads.deferred -= uploadsStart.deferred;
+            uploads.skipped -= uploadsStart.skipped;
+            uploads.solid -= uploadsStart.solid;
+            uploads.textureBytes = shmTextureBytes();
+            s_compositor->recording = false;
+            break;
+        }
+    }
+
+    // Keep dispatching while the client cleans up
+    client.stop();
+
+    while (!client.finished)
+        s_compositor->processLoop(10);
+
+    clientThread.join();
+
+    bool passed = !clientFailed;
+
+    if (passed)
+        passed = Report::write(s_options, (const std::list<Output*>&)s_compositor->outputs(), uploads);
+
+    s_compositor->finish();
+    unlink(tracePath);
+    delete workload;
+
+    if (tmpRuntimeDir)
+        rmdir(runtimeDir);
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -93,6 +93,11 @@ const list<LinuxDMABuf::GLinuxDMABuf *> &LClient::linuxDMABufGlobals() const
     return imp()->linuxDMABufGlobals;
 }
 
+const list<WpSinglePixelBuffer::GWpSinglePixelBufferManager *> &LClient::wpSinglePixelBufferManagerGlobals() const
+{
+    return imp()->wpSinglePixelBufferManagerGlobals;
+}
+
 const list<XdgDecoration::GXdgDecorationManager *> &LClient::xdgDecorationManagerGlobals() const
 {
     return imp()->xdgDecorationManagerGlobals;
@@ -173,6 +173,13 @@ public:
      */
     const std::list<Protocols::LinuxDMABuf::GLinuxDMABuf*> &linuxDMABufGlobals() const;
 
+    /**
+     * List of resources generated when the client binds to the
+     * [wp_single_pixel_buffer_manager_v1](https://wayland.app/protocols/single-pixel-buffer-v1#wp_single_pixel_buffer_manager_v1) global
+     * of the Single-pixel buffer protocol.
+     */
+    const std::list<Protocols::WpSinglePixelBuffer::GWpSinglePixelBufferManager*> &wpSinglePixelBufferManagerGlobals() const;
+
     LPRIVATE_IMP(LClient)
 };
 
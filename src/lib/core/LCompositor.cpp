@@ -42,6 +42,49 @@ LCompositor::LCompositor()
     LSurface::LSurfacePrivate::getEGLFunctions();
     m_imp = new LCompositorPrivate();
     imp()->compositor = this;
+
+    const char *env = getenv("LOUVRE_OCCLUDED_FRAME_INTERVAL");
+
+    if (env && atoi(env) > 0)
+        imp()->occludedFrameInterval = atoi(env);
+
+    env = getenv("LOUVRE_DAMAGE_MAX_BOXES");
+
+    if (env)
+        imp()->damageMaxBoxes = atoi(env) > 0 ? atoi(env) : 0;
+
+    env = getenv("LOUVRE_DAMAGE_MAX_WASTE");
+
+    if (env)
+        imp()->damageMaxWaste = std::min(std::max(atoi(env), 0), 100) / 100.f;
+
+    env = getenv("LOUVRE_VIEW_CACHE_FRAMES");
+
+    if (env && atoi(env) > 0)
+        imp()->layerFrames = atoi(env);
+
+    env = getenv("LOUVRE_CONCURRENT_RENDERING");
+    imp()->concurrentRendering = env && atoi(env) == 1;
+
+    env = getenv("LOUVRE_ASYNC_SHM_UPLOAD");
+    imp()->asyncUploads = env && atoi(env) == 1;
+
+    env = getenv("LOUVRE_LAZY_SHM_UPLOAD");
+    imp()->lazyUploads = env && atoi(env) == 1;
+
+    env = getenv("LOUVRE_COALESCE_SHM_COMMITS");
+    imp()->coalesceCommits = env && atoi(env) == 1;
+
+    env = getenv("LOUVRE_INFER_OPAQUE_REGION");
+    imp()->inferOpaqueRegions = env && atoi(env) == 1;
+
+    env = getenv("LOUVRE_SOLID_COLOR_DETECTION");
+    imp()->detectSolidColors = env && atoi(env) == 1;
+
+    env = getenv("LOUVRE_SHM_UPLOAD_CALL_COST");
+
+    if (env && atoi(env) >= 0)
+        imp()->uploadCallCost = atoi(env);
 }
 
 LCompositor *LCompositor::compositor()
@@ -328,6 +371,7 @@ bool LCompositor::addOutput(LOutput *output)
             return true;
 
     imp()->outputs.push_back(output);
+    imp()->outputLayoutSerial++;
 
     if (imp()->outputs.size() == 1)
         cursor()->imp()->setOutput(output);
@@ -381,9 +425,12 @@ void LCompositor::removeOutput(LOutput *output)
                 s->sendOutputLeaveEvent(output);
 
             for (LView *v : imp()->views)
-                v->imp()->removeThread(v, (*it)->threadId());
+                v->imp()->removeOutput(v, output);
+
+            imp()->releaseOutputSlot(output->imp()->slot);
 
             imp()->outputs.erase(it);
+            imp()->outputLayoutSerial++;
 
             // Remove all wl_outputs from clients
             for (LClient *c : clients())
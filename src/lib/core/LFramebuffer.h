@@ -114,6 +114,22 @@ public:
      */
     virtual Int32 currentBufferIndex() const = 0;
 
+    /**
+     * @brief Get the age of the current framebuffer.
+     *
+     * Number of frames since the content of the current framebuffer was last rendered, as defined by `EGL_EXT_buffer_age`.
+     * For example, 1 means it contains the previous frame and 0 that its content is unknown.
+     * LSceneView uses it to repaint only the damage of the frames rendered since then, or everything if unknown.
+     *
+     * The default implementation returns buffersCount(), which assumes buffers are used in rotation.
+     *
+     * @returns The age of the current framebuffer or 0 if unknown.
+     */
+    virtual Int32 bufferAge() const
+    {
+        return buffersCount();
+    }
+
     /**
      * @brief Get the OpenGL texture ID of a specific framebuffer index.
      *
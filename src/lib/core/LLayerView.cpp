@@ -1,4 +1,5 @@
 #include <private/LLayerViewPrivate.h>
+#include <private/LViewPrivate.h>
 #include <LCompositor.h>
 
 LLayerView::LLayerView(LView *parent) : LView(LView::Layer, parent)
@@ -16,20 +17,28 @@ LLayerView::~LLayerView()
 
 void LLayerView::setPos(Int32 x, Int32 y)
 {
-    if (mapped() && (x != imp()->nativePos.x() || y != imp()->nativePos.y()))
+    if (x == imp()->nativePos.x() && y == imp()->nativePos.y())
+        return;
+
+    if (mapped())
         repaint();
 
     imp()->nativePos.setX(x);
     imp()->nativePos.setY(y);
+    LViewPrivate::invalidateWorld(this, LViewPrivate::WorldPos);
 }
 
 void LLayerView::setSize(Int32 w, Int32 h)
 {
-    if (mapped() && (w != imp()->nativeSize.w() || h != imp()->nativeSize.h()))
+    if (w == imp()->nativeSize.w() && h == imp()->nativeSize.h())
+        return;
+
+    if (mapped())
         repaint();
 
     imp()->nativeSize.setW(w);
     imp()->nativeSize.setH(h);
+    LViewPrivate::inputGeometryChanged();
 }
 
 void LLayerView::setPos(const LPoint &pos)
@@ -62,6 +71,8 @@ void LLayerView::setInputRegion(const LRegion *region) const
             imp()->inputRegion = nullptr;
         }
     }
+
+    LViewPrivate::inputGeometryChanged();
 }
 
 bool LLayerView::nativeMapped() const
@@ -7,6 +7,8 @@
 #define LOUVRE_MAX_SURFACE_SIZE 10000000
 #define LOUVRE_GLOBAL_ITERS_BEFORE_DESTROY 5
 #define LOUVRE_MAX_DMA_PLANES 4
+#define LOUVRE_LAYER_POOL_SIZE 4
+#define LOUVRE_DAMAGE_HISTORY 4
 
 // Globals
 #define LOUVRE_WL_COMPOSITOR_VERSION 6
@@ -19,6 +21,7 @@
 #define LOUVRE_XDG_DECORATION_MANAGER_VERSION 1
 #define LOUVRE_WP_PRESENTATION_VERSION 1
 #define LOUVRE_LINUX_DMA_BUF_VERSION 3
+#define LOUVRE_WP_SINGLE_PIXEL_BUFFER_MANAGER_VERSION 1
 
 #define L_UNUSED(object){(void)object;}
 
@@ -293,7 +296,8 @@ namespace Louvre
     enum LGraphicBackendID : UInt32
     {
         LGraphicBackendDRM = 0,     ///< ID for the DRM graphic backend.
-        LGraphicBackendX11 = 1      ///< ID for the X11 graphic backend.
+        LGraphicBackendX11 = 1,     ///< ID for the X11 graphic backend.
+        LGraphicBackendHeadless = 2 ///< ID for the headless graphic backend.
     };
 
     /**
@@ -310,7 +314,8 @@ namespace Louvre
     enum LInputBackendID : UInt32
     {
         LInputBackendLibinput = 0, ///< ID for the Libinput input backend.
-        LInputBackendX11 = 1       ///< ID for the X11 input backend.
+        LInputBackendX11 = 1,      ///< ID for the X11 input backend.
+        LInputBackendScripted = 2  ///< ID for the Scripted input backend (replays recorded input traces).
     };
 
     namespace Protocols
@@ -365,6 +370,13 @@ namespace Louvre
             class RLinuxBufferParams;
             class RLinuxDMABufFeedback;
         };
+
+        namespace WpSinglePixelBuffer
+        {
+            class GWpSinglePixelBufferManager;
+
+            class RWpSinglePixelBuffer;
+        };
     }
 
     /// @cond OMIT
@@ -415,6 +427,12 @@ namespace Louvre
         UInt32 (*getTextureID)(LOutput *output, LTexture *texture);
         GLenum (*getTextureTarget)(LTexture *texture);
         void (*destroyTexture)(LTexture *texture);
+
+        /* Optional hooks, appended so the members above keep their offsets
+         * for backends built against previous versions */
+        Int32 (*getOutputBufferAge)(LOutput *output);
+        bool (*initializeUploadContext)();
+        void (*uninitializeUploadContext)();
     };
 
     struct LInputBackendInterface
@@ -398,6 +398,7 @@ const char *LOutput::description() const
 void LOutput::setPos(const LPoint &pos)
 {
     imp()->rect.setPos(pos);
+    compositor()->imp()->outputLayoutSerial++;
 }
 
 LPainter *LOutput::painter() const
@@ -1,4 +1,5 @@
 #include <private/LOutputFramebufferPrivate.h>
+#include <private/LOutputPrivate.h>
 #include <LOutput.h>
 #include <GLES2/gl2.h>
 
@@ -43,6 +44,11 @@ Int32 LOutputFramebuffer::currentBufferIndex() const
     return imp()->output->currentBuffer();
 }
 
+Int32 LOutputFramebuffer::bufferAge() const
+{
+    return imp()->output->imp()->bufferAge;
+}
+
 const LTexture *LOutputFramebuffer::texture(Int32 index) const
 {
     return imp()->output->bufferTexture(index);
@@ -33,6 +33,7 @@ public:
     GLuint id() const override;
     Int32 buffersCount() const override;
     Int32 currentBufferIndex() const override;
+    Int32 bufferAge() const override;
     const LTexture *texture(Int32 index = 0) const override;
     void setFramebufferDamage(const LRegion *damage) override;
     Transform transform() const override;
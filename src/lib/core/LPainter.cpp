@@ -8,8 +8,17 @@
 #include <LOpenGL.h>
 #include <LRect.h>
 #include <LOutput.h>
+#include <EGL/egl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <limits.h>
+#include <errno.h>
 #include <cstdio>
+#include <cstdlib>
 #include <string.h>
+#include <functional>
+#include <mutex>
+#include <list>
 
 using namespace Louvre;
 
@@ -27,197 +36,20 @@ LPainter::LPainter()
     GLchar vShaderStr[] = R"(
         precision lowp float;
         precision lowp int;
-        uniform lowp vec2 texSize;
-        uniform lowp vec4 srcRect;
-        uniform lowp int transform;
-        attribute lowp vec4 vertexPosition;
+        uniform highp vec2 texSize;
+        uniform highp vec4 srcRect;
+        uniform highp mat2 transform;
+        attribute highp vec4 vertexPosition;
         varying lowp vec2 v_texcoord;
 
         void main()
         {
-            // Normal
-            if (transform == 0)
-                gl_Position = vec4(vertexPosition.xy, 0.0, 1.0);
-
-            // Clock90
-            else if (transform == 1)
-            {
-                // TL > TR
-                if (vertexPosition.x == -1.0 && vertexPosition.y == 1.0)
-                    gl_Position = vec4(1.0, 1.0, 0.0, 1.0);
-                // BL > TL
-                else if (vertexPosition.x == -1.0 && vertexPosition.y == -1.0)
-                    gl_Position = vec4(-1.0, 1.0, 0.0, 1.0);
-                // BR > BL
-                else if (vertexPosition.x == 1.0 && vertexPosition.y == -1.0)
-                    gl_Position = vec4(-1.0, -1.0, 0.0, 1.0);
-                // TR > BR
-                else
-                    gl_Position = vec4(1.0, -1.0, 0.0, 1.0);
-            }
-
-            // Clock180
-            else if (transform == 2)
-            {
-                // TL > BR
-                if (vertexPosition.x == -1.0 && vertexPosition.y == 1.0)
-                    gl_Position = vec4(1.0, -1.0, 0.0, 1.0);
-                // BL > TR
-                else if (vertexPosition.x == -1.0 && vertexPosition.y == -1.0)
-                    gl_Position = vec4(1.0, 1.0, 0.0, 1.0);
-                // BR > TL
-                else if (vertexPosition.x == 1.0 && vertexPosition.y == -1.0)
-                    gl_Position = vec4(-1.0, 1.0, 0.0, 1.0);
-                // TR > BL
-                else
-                    gl_Position = vec4(-1.0, -1.0, 0.0, 1.0);
-            }
-
-            // Clock270
-            else if (transform == 3)
-            {
-                // TL > BL
-                if (vertexPosition.x == -1.0 && vertexPosition.y == 1.0)
-                    gl_Position = vec4(-1.0, -1.0, 0.0, 1.0);
-                // BL > BR
-                else if (vertexPosition.x == -1.0 && vertexPosition.y == -1.0)
-                    gl_Position = vec4(1.0, -1.0, 0.0, 1.0);
-                // BR > TR
-                else if (vertexPosition.x == 1.0 && vertexPosition.y == -1.0)
-                    gl_Position = vec4(1.0, 1.0, 0.0, 1.0);
-                // TR > TL
-                else
-                    gl_Position = vec4(-1.0, 1.0, 0.0, 1.0);
-            }
-
-            // Flipped
-            else if (transform == 4)
-                gl_Position = vec4(-vertexPosition.x, vertexPosition.y, 0.0, 1.0);
-
-            // Flipped90
-            else if (transform == 5)
-            {
-                // TL > BR
-                if (vertexPosition.x == -1.0 && vertexPosition.y == 1.0)
-                    gl_Position = vec4(1.0, -1.0, 0.0, 1.0);
-                // BL > BL
-                else if (vertexPosition.x == -1.0 && vertexPosition.y == -1.0)
-                    gl_Position = vec4(-1.0, -1.0, 0.0, 1.0);
-                // BR > TL
-                else if (vertexPosition.x == 1.0 && vertexPosition.y == -1.0)
-                    gl_Position = vec4(-1.0, 1.0, 0.0, 1.0);
-                // TR > TR
-                else
-                    gl_Position = vec4(1.0, 1.0, 0.0, 1.0);
-            }
-
-            // Flipped180
-            else if (transform == 6)
-                gl_Position = vec4(vertexPosition.x, -vertexPosition.y, 0.0, 1.0);
-
-            // Flipped270
-            else if (transform == 7)
-            {
-                // TL > TL
-                if (vertexPosition.x == -1.0 && vertexPosition.y == 1.0)
-                    gl_Position = vec4(-1.0, 1.0, 0.0, 1.0);
-                // BL > TR
-                else if (vertexPosition.x == -1.0 && vertexPosition.y == -1.0)
-                    gl_Position = vec4(1.0, 1.0, 0.0, 1.0);
-                // BR > BR
-                else if (vertexPosition.x == 1.0 && vertexPosition.y == -1.0)
-                    gl_Position = vec4(1.0, -1.0, 0.0, 1.0);
-                // TR > BL
-                else
-                    gl_Position = vec4(-1.0, -1.0, 0.0, 1.0);
-            }
-
+            gl_Position = vec4(transform * vertexPosition.xy, 0.0, 1.0);
             v_texcoord.x = (srcRect.x + vertexPosition.z*srcRect.z) / texSize.x;
             v_texcoord.y = (srcRect.y + srcRect.w - vertexPosition.w*srcRect.w) / texSize.y;
         }
         )";
 
-    GLchar fShaderStr[] =R"(
-        precision lowp float;
-        precision lowp int;
-        uniform lowp sampler2D tex;
-
-        uniform bool colorFactorEnabled;
-        uniform lowp int mode;
-        uniform lowp float alpha;
-        uniform lowp vec3 color;
-        uniform lowp vec4 colorFactor;
-        varying lowp vec2 v_texcoord;
-
-        void main()
-        {
-            // Texture
-            if (mode == 0)
-            {
-                gl_FragColor = texture2D(tex, v_texcoord);
-                gl_FragColor.w *= alpha;
-            }
-
-            // Solid color
-            else if (mode == 1)
-            {
-                gl_FragColor.xyz = color;
-                gl_FragColor.w = alpha;
-            }
-
-            // Colored texture
-            else if (mode == 2)
-            {
-                gl_FragColor.xyz = color;
-                gl_FragColor.w = texture2D(tex, v_texcoord).w * alpha;
-            }
-
-            if (colorFactorEnabled)
-                gl_FragColor *= colorFactor;
-        }
-        )";
-
-    GLchar fShaderStrExternal[] =R"(
-        #extension GL_OES_EGL_image_external : require
-        precision lowp float;
-        precision lowp int;
-        uniform lowp samplerExternalOES tex;
-
-        uniform bool colorFactorEnabled;
-        uniform lowp int mode;
-        uniform lowp float alpha;
-        uniform lowp vec3 color;
-        uniform lowp vec4 colorFactor;
-        varying lowp vec2 v_texcoord;
-
-        void main()
-        {
-            // Texture
-            if (mode == 0)
-            {
-                gl_FragColor = texture2D(tex, v_texcoord);
-                gl_FragColor.w *= alpha;
-            }
-
-            // Solid color
-            else if (mode == 1)
-            {
-                gl_FragColor.xyz = color;
-                gl_FragColor.w = alpha;
-            }
-
-            // Colored texture
-            else if (mode == 2)
-            {
-                gl_FragColor.xyz = color;
-                gl_FragColor.w = texture2D(tex, v_texcoord).w * alpha;
-            }
-
-            if (colorFactorEnabled)
-                gl_FragColor *= colorFactor;
-        }
-        )";
-
     GLchar fShaderStrScaler[] =R"(
         precision highp float;
         precision highp int;
@@ -301,124 +133,17 @@ LPainter::LPainter()
         }
         )";
 
-    // Load the vertex/fragment shaders
-    imp()->vertexShader = LOpenGL::compileShader(GL_VERTEX_SHADER, vShaderStr);
-    imp()->fragmentShader = LOpenGL::compileShader(GL_FRAGMENT_SHADER, fShaderStr);
-    imp()->fragmentShaderExternal = LOpenGL::compileShader(GL_FRAGMENT_SHADER, fShaderStrExternal);
-    imp()->fragmentShaderScaler = LOpenGL::compileShader(GL_FRAGMENT_SHADER, fShaderStrScaler);
-    imp()->fragmentShaderScalerExternal = LOpenGL::compileShader(GL_FRAGMENT_SHADER, fShaderStrScalerExternal);
-
-    GLint linked;
-
-    /************** SCALER PROGRAM **************/
-
-    imp()->programObjectScaler = glCreateProgram();
-    glAttachShader(imp()->programObjectScaler, imp()->vertexShader);
-    glAttachShader(imp()->programObjectScaler, imp()->fragmentShaderScaler);
-
-    // Link the program
-    glLinkProgram(imp()->programObjectScaler);
-
-    // Check the link status
-    glGetProgramiv(imp()->programObjectScaler, GL_LINK_STATUS, &linked);
-
-    if (!linked)
-    {
-        GLint infoLen = 0;
-        glGetProgramiv(imp()->programObjectScaler, GL_INFO_LOG_LENGTH, &infoLen);
-        glDeleteProgram(imp()->programObjectScaler);
-        imp()->programObjectScaler = 0;
-        LLog::error("[LPainter::LPainter] Failed to compile scaler shader.");
-    }
-    else
-    {
-        imp()->currentProgram = imp()->programObjectScaler;
-        imp()->currentUniformsScaler = &imp()->uniformsScaler;
-        imp()->setupProgramScaler();
-    }
-
-    /************** SCALER PROGRAM EXTERNAL **************/
-
-    imp()->programObjectScalerExternal = glCreateProgram();
-    glAttachShader(imp()->programObjectScalerExternal, imp()->vertexShader);
-    glAttachShader(imp()->programObjectScalerExternal, imp()->fragmentShaderScalerExternal);
-
-    // Link the program
-    glLinkProgram(imp()->programObjectScalerExternal);
-
-    // Check the link status
-    glGetProgramiv(imp()->programObjectScalerExternal, GL_LINK_STATUS, &linked);
-
-    if (!linked)
-    {
-        GLint infoLen = 0;
-        glGetProgramiv(imp()->programObjectScalerExternal, GL_INFO_LOG_LENGTH, &infoLen);
-        glDeleteProgram(imp()->programObjectScalerExternal);
-        imp()->programObjectScalerExternal = 0;
-        LLog::error("[LPainter::LPainter] Failed to compile scaler shader external.");
-    }
-    else
-    {
-        imp()->currentProgram = imp()->programObjectScalerExternal;
-        imp()->currentUniformsScaler = &imp()->uniformsScalerExternal;
-        imp()->setupProgramScaler();
-    }
-
-    /************** RENDER PROGRAM EXTERNAL **************/
-
-    imp()->programObjectExternal = glCreateProgram();
-    glAttachShader(imp()->programObjectExternal, imp()->vertexShader);
-    glAttachShader(imp()->programObjectExternal, imp()->fragmentShaderExternal);
-
-    // Link the program
-    glLinkProgram(imp()->programObjectExternal);
-
-    // Check the link status
-    glGetProgramiv(imp()->programObjectExternal, GL_LINK_STATUS, &linked);
-
-    if (!linked)
-    {
-        GLint infoLen = 0;
-        glGetProgramiv(imp()->programObjectExternal, GL_INFO_LOG_LENGTH, &infoLen);
-        glDeleteProgram(imp()->programObjectExternal);
-        LLog::error("[LPainter::LPainter] Failed to compile external OES shader.");
-    }
-    else
-    {
-        imp()->currentProgram = imp()->programObjectExternal;
-    #if LPAINTER_TRACK_UNIFORMS == 1
-        imp()->currentState = &imp()->stateExternal;
-    #endif
-        imp()->currentUniforms = &imp()->uniformsExternal;
-        imp()->setupProgram();
-    }
+    // Programs are shared with the painters of other contexts in the same share group
+    imp()->vertexShaderSource = vShaderStr;
 
-    /************** RENDER PROGRAM **************/
-
-    imp()->programObject = glCreateProgram();
-    glAttachShader(imp()->programObject, imp()->vertexShader);
-    glAttachShader(imp()->programObject, imp()->fragmentShader);
-
-    // Link the program
-    glLinkProgram(imp()->programObject);
-
-    // Check the link status
-    glGetProgramiv(imp()->programObject, GL_LINK_STATUS, &linked);
-
-    if (!linked)
-    {
-        GLint infoLen = 0;
-        glGetProgramiv(imp()->programObject, GL_INFO_LOG_LENGTH, &infoLen);
-        glDeleteProgram(imp()->programObject);
+    if (!imp()->acquirePrograms(fShaderStrScaler, fShaderStrScalerExternal))
         exit(-1);
-    }
 
-    imp()->currentProgram = imp()->programObject;
-    #if LPAINTER_TRACK_UNIFORMS == 1
-    imp()->currentState = &imp()->state;
-    #endif
-    imp()->currentUniforms = &imp()->uniforms;
-    imp()->setupProgram();
+    imp()->vertexShaderSource = nullptr;
+
+    // Vertex arrays are per context
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, imp()->square);
+    glEnableVertexAttribArray(0);
 
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
@@ -433,11 +158,22 @@ LPainter::LPainter()
     glDisable(GL_SAMPLE_COVERAGE);
     glDisable(GL_SAMPLE_ALPHA_TO_ONE);
 
-    imp()->shaderSetColorFactor(1.f, 1.f, 1.f, 1.f);
+    imp()->useProgram(GL_TEXTURE_2D, LPainterPrivate::ModeTexture);
+
+    const char *env = getenv("LOUVRE_PAINTER_BATCHING");
+    imp()->batchingEnabled = !env || atoi(env) != 0;
+
+    if (imp()->batchingEnabled)
+    {
+        glGenBuffers(1, &imp()->batchVBO);
+        imp()->batchVertices.reserve(64 * LPAINTER_BATCH_QUAD_FLOATS);
+    }
 }
 
 void LPainter::bindFramebuffer(LFramebuffer *framebuffer)
 {
+    imp()->batchSuspend();
+
     if (!framebuffer)
     {
         imp()->fbId = 0;
@@ -487,51 +223,730 @@ void LPainter::LPainterPrivate::updateCPUFormats()
     }
 }
 
-void LPainter::LPainterPrivate::setupProgram()
+constexpr GLfloat LPainter::LPainterPrivate::transformMatrices[9][4];
+
+GLuint LPainter::LPainterPrivate::linkProgram(GLuint fragmentShader)
+{
+    if (!vertexShader)
+        vertexShader = LOpenGL::compileShader(GL_VERTEX_SHADER, vertexShaderSource);
+
+    if (!vertexShader || !fragmentShader)
+        return 0;
+
+    GLint linked;
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glBindAttribLocation(program, 0, "vertexPosition");
+
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+    if (!linked)
+    {
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+// FNV-1a
+static UInt64 hashString(const char *str, UInt64 hash)
+{
+    while (*str)
+    {
+        hash ^= (UChar8)*str++;
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+static bool createDirectories(const std::string &path)
+{
+    for (size_t i = 1; i <= path.size(); i++)
+    {
+        if (i != path.size() && path[i] != '/')
+            continue;
+
+        if (mkdir(path.substr(0, i).c_str(), 0700) != 0 && errno != EEXIST)
+            return false;
+    }
+
+    return true;
+}
+
+void LPainter::LPainterPrivate::setupProgramCache()
+{
+    programCache.enabled = false;
+
+    const char *env = getenv("LOUVRE_SHADER_CACHE");
+
+    if (env && atoi(env) == 0)
+        return;
+
+    GLint formats = 0;
+
+    if (LOpenGL::hasExtension("GL_OES_get_program_binary"))
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+
+    if (formats <= 0)
+    {
+        LLog::debug("[LPainter::LPainter] GL_OES_get_program_binary not supported, shader cache disabled.");
+        return;
+    }
+
+    programCache.getProgramBinary = (PFNGLGETPROGRAMBINARYOESPROC)eglGetProcAddress("glGetProgramBinaryOES");
+    programCache.programBinary = (PFNGLPROGRAMBINARYOESPROC)eglGetProcAddress("glProgramBinaryOES");
+
+    if (!programCache.getProgramBinary || !programCache.programBinary)
+        return;
+
+    env = getenv("LOUVRE_SHADER_CACHE_DIR");
+
+    if (env)
+        programCache.dir = env;
+    else if ((env = getenv("XDG_CACHE_HOME")))
+        programCache.dir = std::string(env) + "/Louvre/shaders";
+    else if ((env = getenv("HOME")))
+        programCache.dir = std::string(env) + "/.cache/Louvre/shaders";
+    else
+        return;
+
+    if (!createDirectories(programCache.dir))
+    {
+        LLog::warning("[LPainter::LPainter] Failed to create shader cache directory %s.", programCache.dir.c_str());
+        return;
+    }
+
+    // Binaries are only valid for the same driver
+    const char *vendor = (const char*)glGetString(GL_VENDOR);
+    const char *renderer = (const char*)glGetString(GL_RENDERER);
+    const char *version = (const char*)glGetString(GL_VERSION);
+    programCache.seed = 0xcbf29ce484222325ULL;
+    programCache.seed = hashString(vendor ? vendor : "", programCache.seed);
+    programCache.seed = hashString(renderer ? renderer : "", programCache.seed);
+    programCache.seed = hashString(version ? version : "", programCache.seed);
+    programCache.enabled = true;
+}
+
+GLuint LPainter::LPainterPrivate::loadProgramBinary(const char *path, UInt64 key)
 {
-    glBindAttribLocation(currentProgram, 0, "vertexPosition");
+    FILE *file = fopen(path, "rb");
+
+    if (!file)
+        return 0;
+
+    ProgramCache::Header header;
+    std::vector<UChar8> binary;
+    GLuint program = 0;
+    GLint linked = 0;
+
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, LPAINTER_PROGRAM_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.key != key ||
+        header.size == 0)
+        goto invalid;
+
+    binary.resize(header.size);
+
+    if (fread(binary.data(), 1, header.size, file) != header.size)
+        goto invalid;
+
+    fclose(file);
+    file = nullptr;
+
+    program = glCreateProgram();
+    programCache.programBinary(program, header.format, binary.data(), header.size);
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+    if (linked)
+        return program;
+
+    // E.g. the driver was updated without changing its version string
+    glDeleteProgram(program);
+    LLog::debug("[LPainter::loadProgramBinary] Cached program %s rejected by the driver, recompiling.", path);
+
+    invalid:
+    if (file)
+        fclose(file);
+    unlink(path);
+    return 0;
+}
+
+void LPainter::LPainterPrivate::saveProgramBinary(GLuint program, const char *path, UInt64 key)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+
+    if (length <= 0)
+        return;
+
+    ProgramCache::Header header;
+    memcpy(header.magic, LPAINTER_PROGRAM_CACHE_MAGIC, sizeof(header.magic));
+    header.key = key;
+
+    std::vector<UChar8> binary(length);
+    GLsizei written = 0;
+    programCache.getProgramBinary(program, length, &written, &header.format, binary.data());
+
+    if (written <= 0)
+        return;
+
+    header.size = written;
+
+    // Output threads may write the same entry concurrently, so write a temporary file and rename it
+    char tmpPath[PATH_MAX];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.%d.%lu.tmp", path, getpid(), (unsigned long)std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+    FILE *file = fopen(tmpPath, "wb");
+
+    if (!file)
+        return;
+
+    const bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                    fwrite(binary.data(), 1, written, file) == (size_t)written;
+
+    if (fclose(file) != 0 || !ok || rename(tmpPath, path) != 0)
+        unlink(tmpPath);
+}
+
+GLuint LPainter::LPainterPrivate::createProgram(const char *fragmentSource)
+{
+    UInt64 key = 0;
+    char path[PATH_MAX];
+    GLuint program;
+
+    if (programCache.enabled)
+    {
+        key = hashString(fragmentSource, hashString(vertexShaderSource, programCache.seed));
+        snprintf(path, sizeof(path), "%s/%016llx.bin", programCache.dir.c_str(), (unsigned long long)key);
+        program = loadProgramBinary(path, key);
+
+        if (program)
+            return program;
+    }
+
+    GLuint fragmentShader = LOpenGL::compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    program = linkProgram(fragmentShader);
+
+    if (fragmentShader)
+        glDeleteShader(fragmentShader);
 
-    // Use the program object
-    glUseProgram(currentProgram);
+    if (program && programCache.enabled)
+        saveProgramBinary(program, path, key);
 
-    // Load the vertex data
+    return program;
+}
+
+/* Program sets by EGLDisplay. Contexts created by the graphic backends for the same device
+ * share objects with its allocator context, so their painters can use the same programs. */
+static std::list<LPainter::LPainterPrivate::ProgramSet*> programSets;
+static std::mutex programSetsMutex;
+
+// Checks if the programs of a set are visible from the current context
+static bool validateProgramSet(LPainter::LPainterPrivate::ProgramSet *set)
+{
+    for (Int32 external = 0; external < 2; external++)
+    {
+        for (Int32 mode = 0; mode < 3; mode++)
+        {
+            for (Int32 colorFactor = 0; colorFactor < 2; colorFactor++)
+            {
+                const GLuint id = set->ids[external][mode][colorFactor];
+
+                if (!id)
+                    continue;
+
+                // The name could belong to some unrelated program of a non shared context
+                if (!glIsProgram(id) || glGetUniformLocation(id, "transform") != set->uniforms[external][mode][colorFactor].transform)
+                    return false;
+            }
+        }
+    }
+
+    return (!set->scaler || glIsProgram(set->scaler)) &&
+           (!set->scalerExternal || glIsProgram(set->scalerExternal));
+}
+
+bool LPainter::LPainterPrivate::acquirePrograms(const char *scalerSource, const char *scalerExternalSource)
+{
+    // Held while compiling, so outputs initialized at the same time wait and reuse the programs
+    std::lock_guard<std::mutex> lock(programSetsMutex);
+
+    const EGLDisplay display = eglGetCurrentDisplay();
+
+    // Uniform values are shared too, painters drawing concurrently can't use the same programs
+    if (!compositor()->imp()->concurrentRendering)
+    {
+        for (ProgramSet *set : programSets)
+        {
+            if (set->display == display && validateProgramSet(set))
+            {
+                programSet = set;
+                break;
+            }
+        }
+    }
+
+    if (!programSet)
+    {
+        programSet = new ProgramSet();
+        programSet->display = display;
+
+        for (Int32 external = 0; external < 2; external++)
+            for (Int32 mode = 0; mode < 3; mode++)
+                for (Int32 colorFactor = 0; colorFactor < 2; colorFactor++)
+                    programSet->owners[external][mode][colorFactor] = nullptr;
+
+        if (!createPrograms(scalerSource, scalerExternalSource))
+        {
+            delete programSet;
+            programSet = nullptr;
+            return false;
+        }
+
+        programSets.push_back(programSet);
+    }
+    else
+        LLog::debug("[LPainter::LPainter] Reusing programs linked by another context.");
+
+    programSet->refs++;
+
+    for (Int32 external = 0; external < 2; external++)
+    {
+        for (Int32 mode = 0; mode < 3; mode++)
+        {
+            for (Int32 colorFactor = 0; colorFactor < 2; colorFactor++)
+            {
+                Program &program = programs[external][mode][colorFactor];
+                program.id = programSet->ids[external][mode][colorFactor];
+                program.uniforms = programSet->uniforms[external][mode][colorFactor];
+                program.owner = &programSet->owners[external][mode][colorFactor];
+            }
+        }
+    }
+
+    programObjectScaler = programSet->scaler;
+    programObjectScalerExternal = programSet->scalerExternal;
+    uniformsScaler = programSet->uniformsScaler;
+    uniformsScalerExternal = programSet->uniformsScalerExternal;
+    currentUniformsScaler = &uniformsScaler;
+    return true;
+}
+
+void LPainter::LPainterPrivate::releasePrograms()
+{
+    std::lock_guard<std::mutex> lock(programSetsMutex);
+
+    if (!programSet)
+        return;
+
+    // A painter created later at the same address must not skip resetProgramState()
+    for (Int32 external = 0; external < 2; external++)
+        for (Int32 mode = 0; mode < 3; mode++)
+            for (Int32 colorFactor = 0; colorFactor < 2; colorFactor++)
+                if (programSet->owners[external][mode][colorFactor] == painter)
+                    programSet->owners[external][mode][colorFactor] = nullptr;
+
+    if (--programSet->refs > 0)
+    {
+        programSet = nullptr;
+        return;
+    }
+
+    for (Int32 external = 0; external < 2; external++)
+        for (Int32 mode = 0; mode < 3; mode++)
+            for (Int32 colorFactor = 0; colorFactor < 2; colorFactor++)
+                if (programSet->ids[external][mode][colorFactor])
+                    glDeleteProgram(programSet->ids[external][mode][colorFactor]);
+
+    if (programSet->scaler)
+        glDeleteProgram(programSet->scaler);
+
+    if (programSet->scalerExternal)
+        glDeleteProgram(programSet->scalerExternal);
+
+    programSets.remove(programSet);
+    delete programSet;
+    programSet = nullptr;
+}
+
+bool LPainter::LPainterPrivate::createPrograms(const char *scalerSource, const char *scalerExternalSource)
+{
+    static const char *fShaderStr = R"(
+        precision lowp float;
+        precision lowp int;
+        uniform lowp SAMPLER tex;
+        uniform lowp float alpha;
+        uniform lowp vec3 color;
+        uniform lowp vec4 colorFactor;
+        varying lowp vec2 v_texcoord;
+
+        void main()
+        {
+        #if MODE == 0
+            gl_FragColor = texture2D(tex, v_texcoord);
+            gl_FragColor.w *= alpha;
+        #elif MODE == 1
+            gl_FragColor = vec4(color, alpha);
+        #else
+            gl_FragColor = vec4(color, texture2D(tex, v_texcoord).w * alpha);
+        #endif
+
+        #if COLOR_FACTOR == 1
+            gl_FragColor *= colorFactor;
+        #endif
+        }
+        )";
+
+    char source[1024];
+    bool externalFailed = false;
+
+    setupProgramCache();
+
+    for (Int32 external = 0; external < 2; external++)
+    {
+        for (Int32 mode = 0; mode < 3; mode++)
+        {
+            // Solid color programs don't sample
+            if (external && mode == ModeSolidColor)
+                continue;
+
+            for (Int32 colorFactor = 0; colorFactor < 2; colorFactor++)
+            {
+                snprintf(source, sizeof(source), "%s#define SAMPLER %s\n#define MODE %d\n#define COLOR_FACTOR %d\n%s",
+                         external ? "#extension GL_OES_EGL_image_external : require\n" : "",
+                         external ? "samplerExternalOES" : "sampler2D",
+                         mode, colorFactor, fShaderStr);
+
+                const GLuint id = createProgram(source);
+
+                if (!id)
+                {
+                    if (!external)
+                    {
+                        LLog::fatal("[LPainter::LPainter] Failed to compile shader (mode %d, color factor %d).", mode, colorFactor);
+                        return false;
+                    }
+
+                    externalFailed = true;
+                    continue;
+                }
+
+                Uniforms &uniforms = programSet->uniforms[external][mode][colorFactor];
+                programSet->ids[external][mode][colorFactor] = id;
+                uniforms.texSize = glGetUniformLocation(id, "texSize");
+                uniforms.srcRect = glGetUniformLocation(id, "srcRect");
+                uniforms.activeTexture = glGetUniformLocation(id, "tex");
+                uniforms.color = glGetUniformLocation(id, "color");
+                uniforms.colorFactor = glGetUniformLocation(id, "colorFactor");
+                uniforms.alpha = glGetUniformLocation(id, "alpha");
+                uniforms.transform = glGetUniformLocation(id, "transform");
+            }
+        }
+    }
+
+    if (externalFailed)
+        LLog::error("[LPainter::LPainter] Failed to compile external OES shader.");
+
+    /************** SCALER PROGRAMS **************/
+
+    programSet->scaler = createProgram(scalerSource);
+
+    if (!programSet->scaler)
+        LLog::error("[LPainter::LPainter] Failed to compile scaler shader.");
+    else
+        setupProgramScaler(programSet->scaler, &programSet->uniformsScaler);
+
+    programSet->scalerExternal = createProgram(scalerExternalSource);
+
+    if (!programSet->scalerExternal)
+        LLog::error("[LPainter::LPainter] Failed to compile scaler shader external.");
+    else
+        setupProgramScaler(programSet->scalerExternal, &programSet->uniformsScalerExternal);
+
+    return true;
+}
+
+void LPainter::LPainterPrivate::resetProgramState(Program *program)
+{
+    #if LPAINTER_TRACK_UNIFORMS == 1
+    program->state.texSize = {1, 1};
+    program->state.srcRect = {0, 0, 1, 1};
+    program->state.activeTexture = 0;
+    program->state.color = {0.f, 0.f, 0.f};
+    program->state.colorFactor = {1.f, 1.f, 1.f, 1.f};
+    program->state.alpha = 1.f;
+    program->state.transform = LFramebuffer::Normal;
+    #endif
+
+    glUniform2f(program->uniforms.texSize, 1.f, 1.f);
+    glUniform4f(program->uniforms.srcRect, 0.f, 0.f, 1.f, 1.f);
+    glUniform1i(program->uniforms.activeTexture, 0);
+    glUniform3f(program->uniforms.color, 0.f, 0.f, 0.f);
+    glUniform4f(program->uniforms.colorFactor, 1.f, 1.f, 1.f, 1.f);
+    glUniform1f(program->uniforms.alpha, 1.f);
+    glUniformMatrix2fv(program->uniforms.transform, 1, GL_FALSE, transformMatrices[LFramebuffer::Normal]);
+}
+
+void LPainter::LPainterPrivate::batchBegin()
+{
+    // Unknown, glBlendFunc() may have been called by anyone
+    blendS = blendD = 0;
+
+    if (!batchingEnabled || !fb)
+        return;
+
+    batching = true;
+    batchReady = false;
+}
+
+void LPainter::LPainterPrivate::batchEnd()
+{
+    if (!batching)
+        return;
+
+    if (recording)
+    {
+        batchFlush();
+        batchReady = false;
+    }
+    else
+        batchSuspend();
+
+    batching = false;
+}
+
+void LPainter::LPainterPrivate::batchSetup()
+{
+    Int32 x = fb->rect().x();
+    Int32 y = fb->rect().y();
+    batchViewportW = fb->rect().w();
+    batchViewportH = fb->rect().h();
+    fbRectToViewport(x, y, batchViewportW, batchViewportH);
+    batchReady = true;
+
+    // Set by recordReplay()
+    if (recording)
+        return;
+
+    glScissor(0, 0, batchViewportW, batchViewportH);
+    glViewport(0, 0, batchViewportW, batchViewportH);
+    glBindBuffer(GL_ARRAY_BUFFER, batchVBO);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, nullptr);
+}
+
+void LPainter::LPainterPrivate::batchSuspend()
+{
+    // Raw OpenGL calls must be issued after the recorded batches
+    if (recording)
+    {
+        batchFlush();
+        recording = false;
+        batchReady = false;
+        recordReplay();
+        frameRecord.textures.clear();
+        return;
+    }
+
+    if (!batchReady)
+        return;
+
+    batchFlush();
+
+    // Back to the client side square used by the non batched draws
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, square);
+    batchReady = false;
+}
 
-    // Enables the vertex array
-    glEnableVertexAttribArray(0);
+void LPainter::LPainterPrivate::batchApply(const BatchState &state)
+{
+    useProgram(state.target, state.mode);
 
-    // Get Uniform Variables
-    currentUniforms->texSize = glGetUniformLocation(currentProgram, "texSize");
-    currentUniforms->srcRect = glGetUniformLocation(currentProgram, "srcRect");
-    currentUniforms->activeTexture = glGetUniformLocation(currentProgram, "tex");
-    currentUniforms->mode = glGetUniformLocation(currentProgram, "mode");
-    currentUniforms->color= glGetUniformLocation(currentProgram, "color");
-    currentUniforms->colorFactor = glGetUniformLocation(currentProgram, "colorFactor");
-    currentUniforms->colorFactorEnabled = glGetUniformLocation(currentProgram, "colorFactorEnabled");
-    currentUniforms->alpha = glGetUniformLocation(currentProgram, "alpha");
-    currentUniforms->transform = glGetUniformLocation(currentProgram, "transform");
+    // Vertices are already in clip space and the texcoords are passed as is
+    shaderSetTransform(LPAINTER_TRANSFORM_BATCH);
+    shaderSetSrcRect(0, 1, 1, -1);
+    shaderSetTexSize(1, 1);
+    shaderSetAlpha(state.alpha);
+
+    if (state.mode != ModeTexture)
+        shaderSetColor(state.color.r, state.color.g, state.color.b);
+
+    if (state.mode != ModeSolidColor)
+    {
+        glActiveTexture(GL_TEXTURE0);
+        shaderSetActiveTexture(0);
+        glBindTexture(state.target, state.texture);
+        glTexParameteri(state.target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(state.target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+}
+
+void LPainter::LPainterPrivate::batchFlush()
+{
+    if (batchVertices.empty())
+        return;
+
+    if (recording)
+    {
+        RecordedBatch batch;
+        batch.state = batchState;
+        batch.colorFactor = colorFactor;
+        batch.colorFactorEnabled = colorFactorEnabled;
+        batch.blendEnabled = blendEnabled;
+        batch.blendS = blendS;
+        batch.blendD = blendD;
+        batch.first = frameRecord.vertices.size() / 4;
+        batch.count = batchVertices.size() / 4;
+        frameRecord.viewportW = batchViewportW;
+        frameRecord.viewportH = batchViewportH;
+        frameRecord.batches.push_back(batch);
+        frameRecord.vertices.insert(frameRecord.vertices.end(), batchVertices.begin(), batchVertices.end());
+        batchVertices.clear();
+        return;
+    }
+
+    const GLsizeiptr size = batchVertices.size() * sizeof(GLfloat);
+
+    batchApply(batchState);
+
+    // Orphan the previous storage so the driver doesn't have to wait for pending draws
+    if (size > batchVBOSize)
+    {
+        batchVBOSize = size;
+        glBufferData(GL_ARRAY_BUFFER, size, batchVertices.data(), GL_STREAM_DRAW);
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER, batchVBOSize, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, batchVertices.data());
+    }
+
+    glDrawArrays(GL_TRIANGLES, 0, batchVertices.size() / 4);
+    batchVertices.clear();
+}
+
+void LPainter::LPainterPrivate::recordBegin()
+{
+    if (!batchingEnabled || !fb)
+        return;
+
+    recording = true;
+    frameRecord.fbId = fbId;
+}
+
+void LPainter::LPainterPrivate::recordEnd()
+{
+    if (!recording)
+        return;
+
+    batchFlush();
+    recording = false;
 }
 
-void LPainter::LPainterPrivate::setupProgramScaler()
+void LPainter::LPainterPrivate::recordReplay()
 {
-    glBindAttribLocation(currentProgram, 0, "vertexPosition");
+    if (frameRecord.batches.empty())
+    {
+        frameRecord.vertices.clear();
+        return;
+    }
+
+    const LGLVec4F currentColorFactor = colorFactor;
+    const bool currentColorFactorEnabled = colorFactorEnabled;
+    const GLsizeiptr size = frameRecord.vertices.size() * sizeof(GLfloat);
+
+    if (frameRecord.fbId != fbId)
+        glBindFramebuffer(GL_FRAMEBUFFER, frameRecord.fbId);
 
-    // Use the program object
-    glUseProgram(currentProgram);
+    glScissor(0, 0, frameRecord.viewportW, frameRecord.viewportH);
+    glViewport(0, 0, frameRecord.viewportW, frameRecord.viewportH);
+    glBindBuffer(GL_ARRAY_BUFFER, batchVBO);
+
+    // The whole frame is uploaded at once
+    if (size > batchVBOSize)
+    {
+        batchVBOSize = size;
+        glBufferData(GL_ARRAY_BUFFER, size, frameRecord.vertices.data(), GL_STREAM_DRAW);
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER, batchVBOSize, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, frameRecord.vertices.data());
+    }
 
-    // Load the vertex data
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+    bool blend = !frameRecord.batches.front().blendEnabled;
+    GLenum s = 0, d = 0;
+
+    for (const RecordedBatch &batch : frameRecord.batches)
+    {
+        if (batch.blendEnabled != blend)
+        {
+            blend = batch.blendEnabled;
+
+            if (blend)
+                glEnable(GL_BLEND);
+            else
+                glDisable(GL_BLEND);
+        }
+
+        if (batch.blendS != 0 && (batch.blendS != s || batch.blendD != d))
+        {
+            s = batch.blendS;
+            d = batch.blendD;
+            glBlendFunc(s, d);
+        }
+
+        colorFactor = batch.colorFactor;
+        colorFactorEnabled = batch.colorFactorEnabled;
+        batchApply(batch.state);
+        glDrawArrays(GL_TRIANGLES, batch.first, batch.count);
+    }
+
+    // Back to the current state
+    colorFactor = currentColorFactor;
+    colorFactorEnabled = currentColorFactorEnabled;
+
+    if (blend != blendEnabled)
+    {
+        if (blendEnabled)
+            glEnable(GL_BLEND);
+        else
+            glDisable(GL_BLEND);
+    }
+
+    if (blendS != 0 && (blendS != s || blendD != d))
+        glBlendFunc(blendS, blendD);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, square);
 
-    // Enables the vertex array
-    glEnableVertexAttribArray(0);
+    if (frameRecord.fbId != fbId)
+        glBindFramebuffer(GL_FRAMEBUFFER, fbId);
+
+    frameRecord.batches.clear();
+    frameRecord.vertices.clear();
+}
+
+void LPainter::LPainterPrivate::setupProgramScaler(GLuint program, UniformsScaler *uniforms)
+{
+    glUseProgram(program);
 
     // Get Uniform Variables
-    currentUniformsScaler->texSize = glGetUniformLocation(currentProgram, "texSize");
-    currentUniformsScaler->srcRect = glGetUniformLocation(currentProgram, "srcRect");
-    currentUniformsScaler->activeTexture = glGetUniformLocation(currentProgram, "tex");
-    currentUniformsScaler->pixelSize = glGetUniformLocation(currentProgram, "pixelSize");
-    currentUniformsScaler->samplerBounds = glGetUniformLocation(currentProgram, "samplerBounds");
-    currentUniformsScaler->iters = glGetUniformLocation(currentProgram, "iters");
+    uniforms->texSize = glGetUniformLocation(program, "texSize");
+    uniforms->srcRect = glGetUniformLocation(program, "srcRect");
+    uniforms->activeTexture = glGetUniformLocation(program, "tex");
+    uniforms->pixelSize = glGetUniformLocation(program, "pixelSize");
+    uniforms->samplerBounds = glGetUniformLocation(program, "samplerBounds");
+    uniforms->iters = glGetUniformLocation(program, "iters");
+
+    // The scaler draws untransformed
+    glUniformMatrix2fv(glGetUniformLocation(program, "transform"), 1, GL_FALSE, transformMatrices[LFramebuffer::Normal]);
 }
 
 void LPainter::drawTexture(const LTexture *texture,
@@ -596,11 +1011,13 @@ void LPainter::drawColor(Int32 dstX, Int32 dstY, Int32 dstW, Int32 dstH,
 
 void LPainter::setViewport(const LRect &rect)
 {
+    imp()->batchSuspend();
     imp()->setViewport(rect.x(), rect.y(), rect.w(), rect.h());
 }
 
 void LPainter::setViewport(Int32 x, Int32 y, Int32 w, Int32 h)
 {
+    imp()->batchSuspend();
     imp()->setViewport(x, y, w, h);
 }
 
@@ -616,6 +1033,7 @@ void LPainter::setColorFactor(Float32 r, Float32 g, Float32 b, Float32 a)
 
 void LPainter::clearScreen()
 {
+    imp()->batchSuspend();
     glDisable(GL_BLEND);
     setViewport(imp()->fb->rect());
     glScissor(0, 0, imp()->fb->sizeB().w(), imp()->fb->sizeB().h());
@@ -626,15 +1044,21 @@ void LPainter::clearScreen()
 
 void LPainter::bindProgram()
 {
-    glUseProgram(imp()->programObject);
+    imp()->batchSuspend();
+
+    // Others programs may have been bound since
+    imp()->current = nullptr;
+    imp()->useProgram(GL_TEXTURE_2D, LPainterPrivate::ModeTexture);
 }
 
 LPainter::~LPainter()
 {
-    glDeleteProgram(imp()->programObject);
-    glDeleteProgram(imp()->programObjectExternal);
-    glDeleteShader(imp()->fragmentShaderExternal);
-    glDeleteShader(imp()->fragmentShader);
-    glDeleteShader(imp()->vertexShader);
+    if (imp()->batchVBO)
+        glDeleteBuffers(1, &imp()->batchVBO);
+
+    imp()->releasePrograms();
+
+    if (imp()->vertexShader)
+        glDeleteShader(imp()->vertexShader);
     delete m_imp;
 }
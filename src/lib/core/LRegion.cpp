@@ -1,5 +1,6 @@
 #include <LRegion.h>
 #include <pixman.h>
+#include <algorithm>
 
 using namespace Louvre;
 
@@ -200,6 +201,73 @@ void LRegion::multiply(Float32 xFactor, Float32 yFactor)
     m_region = tmp;
 }
 
+/* Merges the boxes [first, last) of a pixman region, they are sorted by bands (same y1 and y2)
+ * and by x1 within each band. Ranges are only split at band boundaries or within a single band,
+ * so the resulting rects never overlap */
+static void coarsenBoxes(pixman_region32_t *dst, const pixman_box32_t *boxes, Int32 first, Int32 last,
+                         Float32 maxWaste, const pixman_region32_t *bounds, UInt64 *added)
+{
+    pixman_box32_t bbox = boxes[first];
+    UInt64 area = 0;
+
+    for (Int32 i = first; i < last; i++)
+    {
+        bbox.x1 = std::min(bbox.x1, boxes[i].x1);
+        bbox.y1 = std::min(bbox.y1, boxes[i].y1);
+        bbox.x2 = std::max(bbox.x2, boxes[i].x2);
+        bbox.y2 = std::max(bbox.y2, boxes[i].y2);
+        area += UInt64(boxes[i].x2 - boxes[i].x1) * UInt64(boxes[i].y2 - boxes[i].y1);
+    }
+
+    const UInt64 bboxArea = UInt64(bbox.x2 - bbox.x1) * UInt64(bbox.y2 - bbox.y1);
+
+    if (last - first == 1 ||
+        ((bboxArea - area) <= maxWaste * bboxArea &&
+        (!bounds || pixman_region32_contains_rectangle((pixman_region32_t*)bounds, &bbox) == PIXMAN_REGION_IN)))
+    {
+        pixman_region32_union_rect(dst, dst, bbox.x1, bbox.y1, bbox.x2 - bbox.x1, bbox.y2 - bbox.y1);
+        *added += bboxArea - area;
+        return;
+    }
+
+    Int32 mid = first + (last - first) / 2;
+
+    // Move the split to the closest band boundary, unless the range is a single band
+    if (boxes[first].y1 != boxes[last - 1].y1)
+    {
+        while (mid < last && boxes[mid].y1 == boxes[mid - 1].y1)
+            mid++;
+
+        if (mid == last)
+        {
+            mid = first + (last - first) / 2;
+
+            while (mid > first && boxes[mid].y1 == boxes[mid - 1].y1)
+                mid--;
+        }
+    }
+
+    coarsenBoxes(dst, boxes, first, mid, maxWaste, bounds, added);
+    coarsenBoxes(dst, boxes, mid, last, maxWaste, bounds, added);
+}
+
+UInt64 LRegion::coarsen(UInt32 maxBoxes, Float32 maxWaste, const LRegion *bounds)
+{
+    Int32 n;
+    const pixman_box32_t *boxes = pixman_region32_rectangles(&m_region, &n);
+
+    if (maxBoxes == 0 || n <= (Int32)maxBoxes)
+        return 0;
+
+    UInt64 added = 0;
+    pixman_region32_t result;
+    pixman_region32_init(&result);
+    coarsenBoxes(&result, boxes, 0, n, maxWaste, bounds ? &bounds->m_region : nullptr, &added);
+    pixman_region32_fini(&m_region);
+    m_region = result;
+    return added;
+}
+
 bool LRegion::containsPoint(const LPoint &point) const
 {
     return pixman_region32_contains_point(&m_region, point.x(), point.y(), NULL);
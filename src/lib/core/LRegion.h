@@ -173,6 +173,21 @@ public:
      */
     void multiply(Float32 xFactor, Float32 yFactor);
 
+    /**
+     * @brief Merges boxes into their bounding rects.
+     *
+     * If the region contains more than **maxBoxes** rectangles, groups of adjacent boxes are replaced
+     * by their bounding rect, as long as the pixels it adds don't exceed **maxWaste** times its area and,
+     * if **bounds** is given, it is contained in **bounds**. Groups not satisfying these conditions are split again.
+     * Useful to reduce the number of draw calls where drawing a few extra pixels is cheaper.
+     *
+     * @param maxBoxes Number of rectangles above which the region is coarsened, 0 disables it.
+     * @param maxWaste Max ratio of added pixels per bounding rect, from 0 to 1.
+     * @param bounds Optional region bounding rects must be contained in.
+     * @return The number of pixels added to the region.
+     */
+    UInt64 coarsen(UInt32 maxBoxes, Float32 maxWaste, const LRegion *bounds = nullptr);
+
     /**
     * @brief Check if the LRegion contains a specific point.
      *
@@ -1,7 +1,10 @@
+#include <private/LCompositorPrivate.h>
 #include <private/LScenePrivate.h>
 #include <private/LViewPrivate.h>
 #include <private/LSceneViewPrivate.h>
 #include <private/LSurfacePrivate.h>
+#include <private/LOutputPrivate.h>
+#include <private/LPainterPrivate.h>
 #include <LSurfaceView.h>
 #include <LOutput.h>
 #include <LCursor.h>
@@ -23,53 +26,78 @@ LScene::LScene()
 
     LView *baseView = imp()->view;
     baseView->imp()->scene = this;
+
+    const char *env = getenv("LOUVRE_SCENE_INPUT_GRID");
+    imp()->inputGridEnabled = !env || atoi(env) != 0;
 }
 
 LScene::~LScene()
 {
+    for (LView *view : imp()->pointerOverViews)
+        view->imp()->pointerOverScene = nullptr;
+
     delete imp()->view;
     delete m_imp;
 }
 
 void LScene::handleInitializeGL(LOutput *output)
 {
-    imp()->mutex.lock();
-    imp()->view->imp()->fb = output->framebuffer();
-    imp()->mutex.unlock();
+    // Only used outside rendering threads, see LSceneView::nativeSize()
+    if (!imp()->view->imp()->fb)
+        imp()->view->imp()->fb = output->framebuffer();
 }
 
 void LScene::handlePaintGL(LOutput *output)
 {
-    imp()->mutex.lock();
-    imp()->view->imp()->fb = output->framebuffer();
+    LPainter::LPainterPrivate *painter = output->painter()->imp();
+
+    /* Outputs have their own scene and view state, but the traversal also notifies views and
+     * clients (e.g. frame callbacks), so it runs while holding the compositor lock */
+    painter->recordNextFrame = compositor()->imp()->concurrentRendering && output->imp()->paintGLLocked;
+    compositor()->imp()->beginViewCachePass();
     imp()->view->render();
-    imp()->mutex.unlock();
+    compositor()->imp()->endViewCachePass();
+    painter->recordNextFrame = false;
+
+    /* The recorded draw calls only reference GL objects, so other outputs and the
+     * main thread can go on while they are submitted */
+    if (!painter->frameRecord.batches.empty())
+    {
+        compositor()->imp()->beginUnlockedRender(painter->frameRecord.textures);
+        painter->recordReplay();
+        compositor()->imp()->endUnlockedRender(painter->frameRecord.textures);
+    }
+
+    painter->frameRecord.textures.clear();
 }
 
 void LScene::handleMoveGL(LOutput *output)
 {
-    imp()->mutex.lock();
-    imp()->view->imp()->fb = output->framebuffer();
     imp()->view->damageAll(output);
-    imp()->mutex.unlock();
 }
 
 void LScene::handleResizeGL(LOutput *output)
 {
-    imp()->mutex.lock();
     imp()->view->damageAll(output);
-    imp()->mutex.unlock();
 }
 
 void LScene::handleUninitializeGL(LOutput *output)
 {
-    L_UNUSED(output);
-    imp()->mutex.lock();
-    auto it = imp()->view->imp()->threadsMap.find(output->threadId());
+    imp()->view->imp()->resetOutputData(output->imp()->slot);
+
+    if (imp()->view->imp()->fb != output->framebuffer())
+        return;
 
-    if (it != imp()->view->imp()->threadsMap.end())
-        imp()->view->imp()->threadsMap.erase(it);
-    imp()->mutex.unlock();
+    imp()->view->imp()->fb = nullptr;
+
+    for (LOutput *o : compositor()->outputs())
+    {
+        if (o != output && o->state() == LOutput::Initialized)
+        {
+            imp()->view->imp()->fb = o->framebuffer();
+            break;
+        }
+    }
 }
 
 LView *LScene::handlePointerMoveEvent(Float32 x, Float32 y, bool absolute, LPoint *outLocalPos)
@@ -87,17 +115,18 @@ LView *LScene::handlePointerMoveEvent(Float32 x, Float32 y, bool absolute, LPoin
     else
         cursor()->move(x, y);
 
-    imp()->listChanged = false;
-    imp()->pointerIsBlocked = false;
-
     imp()->handlingPointerMove = true;
-    LView::LViewPrivate::removeFlagWithChildren(mainView(), LVS::PointerMoveDone);
-    imp()->handlePointerMove(mainView(), cursor()->pos(), &view);
+    compositor()->imp()->beginViewCachePass();
+    imp()->handlePointerMove(cursor()->pos(), &view);
+
+    if (view)
+        localPos = imp()->viewLocalPos(view, cursor()->pos());
+
+    compositor()->imp()->endViewCachePass();
     imp()->handlingPointerMove = false;
 
     if (view)
     {
-        localPos = imp()->viewLocalPos(view, cursor()->pos());
 
         if (outLocalPos)
             *outLocalPos = localPos;
@@ -458,5 +487,8 @@ LSceneView *LScene::mainView() const
 
 LView *LScene::viewAt(const LPoint &pos)
 {
-    return imp()->viewAt(mainView(), pos);
+    compositor()->imp()->beginViewCachePass();
+    LView *view = imp()->viewAt(pos);
+    compositor()->imp()->endViewCachePass();
+    return view;
 }
@@ -117,6 +117,9 @@ public:
      *
      * This method should be integrated into LOutput::paintGL() to properly handle OpenGL painting for the associated output.
      *
+     * If **LOUVRE_CONCURRENT_RENDERING** is set to 1, the draw calls are recorded while holding the compositor lock and submitted after releasing it,
+     * so other outputs and the main thread are not blocked meanwhile. The lock is held again before this method returns.
+     *
      * @param output The LOutput instance to handle OpenGL painting for.
      */
     void handlePaintGL(LOutput *output);
@@ -2,6 +2,7 @@
 #include <private/LSceneViewPrivate.h>
 #include <private/LViewPrivate.h>
 #include <private/LPainterPrivate.h>
+#include <private/LOutputPrivate.h>
 #include <LFramebuffer.h>
 #include <LRenderBuffer.h>
 #include <LOutput.h>
@@ -30,6 +31,9 @@ LSceneView::~LSceneView()
     if (!isLScene())
         delete imp()->fb;
 
+    for (UInt32 i = 0; i < imp()->outputsData.size(); i++)
+        imp()->resetOutputData(i);
+
     delete m_imp;
 }
 
@@ -55,7 +59,7 @@ void LSceneView::damageAll(LOutput *output)
     if (!output)
         return;
 
-    LSceneViewPrivate::ThreadData *oD = &imp()->threadsMap[output->threadId()];
+    LSceneViewPrivate::OutputData *oD = &imp()->outputData(output->imp()->slot);
 
     if (isLScene())
         oD->manuallyAddedDamage.addRect(output->rect());
@@ -69,7 +73,7 @@ void LSceneView::addDamage(LOutput *output, const LRegion &damage)
     if (!output)
         return;
 
-    LSceneViewPrivate::ThreadData *oD = &imp()->threadsMap[output->threadId()];
+    LSceneViewPrivate::OutputData *oD = &imp()->outputData(output->imp()->slot);
 
     if (oD->o)
         oD->manuallyAddedDamage.addRegion(damage);
@@ -83,33 +87,35 @@ bool LSceneView::isLScene() const
 
 void LSceneView::render(const LRegion *exclude)
 {
-    LPainter *painter = compositor()->imp()->threadsMap[std::this_thread::get_id()].painter;
+    LOutput *output = compositor()->imp()->renderingOutput;
 
-    if (!painter)
+    if (!output || !output->painter())
         return;
 
+    LPainter *painter = output->painter();
+
     LFramebuffer *prevFb = painter->boundFramebuffer();
 
-    painter->bindFramebuffer(imp()->fb);
+    LSceneViewPrivate::OutputData *oD = &imp()->outputData(output->imp()->slot);
+
+    // The LScene view is shared by all outputs
+    oD->fb = isLScene() ? output->framebuffer() : imp()->fb;
+
+    painter->bindFramebuffer(oD->fb);
 
     if (!isLScene())
     {
-        LRenderBuffer *rb = (LRenderBuffer*)imp()->fb;
+        LRenderBuffer *rb = (LRenderBuffer*)oD->fb;
         rb->setPos(pos());
     }
 
-    LSceneViewPrivate::ThreadData *oD = &imp()->threadsMap[std::this_thread::get_id()];
-    imp()->currentThreadData = oD;
-
     // If painter was not cached
     if (!oD->p)
     {
-        for (Int32 i = 0; i < imp()->fb->buffersCount() - 1; i++)
-            oD->prevDamageList.push_back(new LRegion());
-
         oD->c = compositor();
         oD->p = painter;
-        oD->o = painter->imp()->output;
+        oD->o = output;
+        oD->slot = output->imp()->slot;
     }
 
     imp()->clearTmpVariables(oD);
@@ -129,6 +135,7 @@ void LSceneView::render(const LRegion *exclude)
         oD->newDamage.addRegion(oD->prevExternalExclude);
         oD->prevExternalExclude = *exclude;
         oD->opaqueTransposedSum.addRegion(*exclude);
+        imp()->checkCovered(oD, *exclude);
     }
     else
     {
@@ -139,50 +146,87 @@ void LSceneView::render(const LRegion *exclude)
         }
     }
 
-    for (std::list<LView*>::const_reverse_iterator it = children().crbegin(); it != children().crend(); it++)
-        imp()->calcNewDamage(*it);
+    /* Nested scenes are notified by their parent scene when their geometry changed.
+     * Children may also be clipped to the rect of this view, which depends on the framebuffer */
+    LView *view = this;
+    const bool parentChanged = (!isLScene() && oD->parentChanged) ||
+                               oD->prevFbRect != oD->fb->rect() ||
+                               oD->changeSerial != view->imp()->changeSerial;
+    oD->parentChanged = true;
 
-    // Save new damage for next frame and add old damage to current damage
-    if (imp()->fb->buffersCount() > 1)
-    {
-        // Sum damage generated in other frames into this region
+    // The damage of previous frames is in the old coordinates
+    if (oD->prevFbRect != oD->fb->rect())
+        oD->damageHistorySize = 0;
+
+    oD->prevFbRect = oD->fb->rect();
+    oD->changeSerial = view->imp()->changeSerial;
 
-        // This list contains NUM_FB - 1 regions, so if triple buffering then 2 regions (the prev ones to this current frame)
-        for (std::list<LRegion*>::iterator it = std::next(oD->prevDamageList.begin()); it != oD->prevDamageList.end(); it++)
-            (*oD->prevDamageList.front()).addRegion(*(*it));
+    // Layers render the views they cache, which are children of other views
+    const std::list<LView*> &roots = imp()->layerRoots.empty() ? children() : imp()->layerRoots;
 
-        pixman_region32_t tmp = oD->prevDamageList.front()->m_region;
-        oD->prevDamageList.front()->m_region = oD->newDamage.m_region;
-        oD->newDamage.m_region = tmp;
-        oD->newDamage.addRegion(*oD->prevDamageList.front());
+    for (std::list<LView*>::const_reverse_iterator it = roots.crbegin(); it != roots.crend(); it++)
+        imp()->calcNewDamage(oD, *it, parentChanged);
 
-        LRegion *front = oD->prevDamageList.front();
-        oD->prevDamageList.pop_front();
-        oD->prevDamageList.push_back(front);
+    // Save new damage for the next frames and add the damage of the frames the framebuffer missed
+    const Int32 age = oD->fb->bufferAge();
+    oD->damageHistory[oD->damageHistoryFrame % LOUVRE_DAMAGE_HISTORY] = oD->newDamage;
+
+    if (age <= 0 || age > LOUVRE_DAMAGE_HISTORY || (UInt32)age > oD->damageHistorySize + 1)
+        imp()->damageAll(oD);
+    else
+        for (UInt32 i = 1; i < (UInt32)age; i++)
+            oD->newDamage.addRegion(oD->damageHistory[(oD->damageHistoryFrame - i) % LOUVRE_DAMAGE_HISTORY]);
+
+    oD->damageHistoryFrame++;
+
+    if (oD->damageHistorySize < LOUVRE_DAMAGE_HISTORY)
+        oD->damageHistorySize++;
+
+    // Fewer and larger rects, see LRegion::coarsen()
+    oD->newDamage.boxes(&oD->n);
+    oD->coarsening.damageBoxesIn = oD->n;
+    oD->coarsening.addedArea += oD->newDamage.coarsen(compositor()->imp()->damageMaxBoxes, compositor()->imp()->damageMaxWaste);
+    oD->newDamage.boxes(&oD->n);
+    oD->coarsening.damageBoxesOut = oD->n;
+
+    // Drawn later by LScene::handlePaintGL()
+    if (isLScene() && painter->imp()->recordNextFrame)
+    {
+        painter->imp()->recordNextFrame = false;
+        painter->imp()->recordBegin();
     }
 
-    glDisable(GL_BLEND);
+    const bool prevBlendPremultiplied = painter->imp()->blendPremultiplied;
+    painter->imp()->blendPremultiplied = !imp()->layerRoots.empty();
+    painter->imp()->setBlendEnabled(false);
+    painter->imp()->batchBegin();
 
-    for (std::list<LView*>::const_reverse_iterator it = children().crbegin(); it != children().crend(); it++)
-        imp()->drawOpaqueDamage(*it);
+    for (std::list<LView*>::const_reverse_iterator it = roots.crbegin(); it != roots.crend(); it++)
+        imp()->drawOpaqueDamage(oD, *it);
 
     painter->imp()->shaderSetColorFactorEnabled(0);
-    imp()->drawBackground(!isLScene() && imp()->clearColor.a >= 1.f);
+    imp()->drawBackground(oD, !isLScene() && imp()->clearColor.a >= 1.f);
 
-    glEnable(GL_BLEND);
+    painter->imp()->batchEnd();
+    painter->imp()->setBlendEnabled(true);
+    painter->imp()->batchBegin();
 
-    for (std::list<LView*>::const_iterator it = children().cbegin(); it != children().cend(); it++)
-        imp()->drawTranslucentDamage(*it);
+    for (std::list<LView*>::const_iterator it = roots.cbegin(); it != roots.cend(); it++)
+        imp()->drawTranslucentDamage(oD, *it);
+
+    painter->imp()->batchEnd();
+    painter->imp()->recordEnd();
+    painter->imp()->blendPremultiplied = prevBlendPremultiplied;
 
     if (!isLScene())
     {
-        oD->opaqueTransposedSum.clip(imp()->fb->rect());
+        oD->opaqueTransposedSum.clip(oD->fb->rect());
         oD->translucentTransposedSum = oD->opaqueTransposedSum;
-        oD->translucentTransposedSum.inverse(imp()->fb->rect());
+        oD->translucentTransposedSum.inverse(oD->fb->rect());
     }
     else
     {
-        imp()->fb->setFramebufferDamage(&oD->newDamage);
+        oD->fb->setFramebufferDamage(&oD->newDamage);
     }
 
     painter->bindFramebuffer(prevFb);
@@ -210,6 +254,8 @@ void LSceneView::setPos(Int32 x, Int32 y)
             LRenderBuffer *rb = (LRenderBuffer*)imp()->fb;
             rb->setPos(imp()->customPos);
         }
+
+        LViewPrivate::invalidateWorld(this, LViewPrivate::WorldPos);
         repaint();
     }
 }
@@ -222,6 +268,7 @@ void LSceneView::setSizeB(const LSize &size)
         rb->setSizeB(size);
         for (LOutput *o : compositor()->outputs())
             damageAll(o);
+        LViewPrivate::inputGeometryChanged();
         repaint();
     }
 }
@@ -234,6 +281,7 @@ void LSceneView::setScale(Int32 scale)
         rb->setScale(scale);
         for (LOutput *o : compositor()->outputs())
             damageAll(o);
+        LViewPrivate::inputGeometryChanged();
         repaint();
     }
 }
@@ -250,12 +298,12 @@ const LPoint &LSceneView::nativePos() const
 
 const LSize &LSceneView::nativeSize() const
 {
-    return imp()->fb->rect().size();
+    return imp()->sceneFramebuffer(this)->rect().size();
 }
 
 Int32 LSceneView::bufferScale() const
 {
-    return imp()->fb->scale();
+    return imp()->sceneFramebuffer(this)->scale();
 }
 
 void LSceneView::enteredOutput(LOutput *output)
@@ -286,17 +334,17 @@ void LSceneView::requestNextFrame(LOutput *output)
 
 const LRegion *LSceneView::damage() const
 {
-    return &imp()->currentThreadData->newDamage;
+    return &imp()->currentOutputData().newDamage;
 }
 
 const LRegion *LSceneView::translucentRegion() const
 {
-    return &imp()->currentThreadData->translucentTransposedSum;
+    return &imp()->currentOutputData().translucentTransposedSum;
 }
 
 const LRegion *LSceneView::opaqueRegion() const
 {
-    return &imp()->currentThreadData->opaqueTransposedSum;
+    return &imp()->currentOutputData().opaqueTransposedSum;
 }
 
 const LRegion *LSceneView::inputRegion() const
@@ -1,4 +1,5 @@
 #include <private/LSolidColorViewPrivate.h>
+#include <private/LViewPrivate.h>
 #include <private/LPainterPrivate.h>
 
 Louvre::LSolidColorView::LSolidColorView(LView *parent) : LView(LView::SolidColor, parent)
@@ -51,11 +52,15 @@ void LSolidColorView::setPos(const LPoint &pos)
 
 void LSolidColorView::setPos(Int32 x, Int32 y)
 {
-    if (mapped() && (x != imp()->nativePos.x() || y != imp()->nativePos.y()))
+    if (x == imp()->nativePos.x() && y == imp()->nativePos.y())
+        return;
+
+    if (mapped())
         repaint();
 
     imp()->nativePos.setX(x);
     imp()->nativePos.setY(y);
+    LViewPrivate::invalidateWorld(this, LViewPrivate::WorldPos);
 }
 
 void LSolidColorView::setSize(const LSize &size)
@@ -72,6 +77,7 @@ void LSolidColorView::setSize(Int32 w, Int32 h)
 
         imp()->opaqueRegion.clear();
         imp()->opaqueRegion.addRect(LRect(LPoint(0,0), imp()->nativeSize));
+        LViewPrivate::inputGeometryChanged();
 
         if (mapped())
             repaint();
@@ -98,6 +104,8 @@ void LSolidColorView::setInputRegion(const LRegion *region) const
             imp()->inputRegion = nullptr;
         }
     }
+
+    LViewPrivate::inputGeometryChanged();
 }
 
 bool LSolidColorView::nativeMapped() const
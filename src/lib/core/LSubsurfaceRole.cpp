@@ -69,6 +69,10 @@ void LSubsurfaceRole::handleParentCommit()
     {
         imp()->hasPendingLocalPos = false;
         imp()->currentLocalPos = imp()->pendingLocalPos;
+
+        // Not detected by the commit of the subsurface, see RSurfacePrivate::apply_commit()
+        compositor()->imp()->viewInputSerial++;
+        surface()->imp()->viewsChanged(true);
         localPosChanged();
     }
 
@@ -2,6 +2,7 @@
 #include <protocols/Wayland/RCallback.h>
 #include <protocols/Wayland/GOutput.h>
 #include <private/LSurfacePrivate.h>
+#include <private/LSurfaceViewPrivate.h>
 #include <private/LCompositorPrivate.h>
 #include <private/LOutputPrivate.h>
 #include <private/LTexturePrivate.h>
@@ -60,12 +61,36 @@ LSurface::LSurface(LSurface::Params *params)
     imp()->texture = new LTexture();
     imp()->textureBackup = imp()->texture;
     imp()->surfaceResource = params->surfaceResource;
+    imp()->coalesceCommits = compositor()->imp()->coalesceCommits;
 }
 
 LSurface::~LSurface()
 {
     imp()->lastPointerEventView = nullptr;
 
+    // Views kept after the surface is destroyed must not unlink themselves
+    for (LSurfaceView *view : imp()->views)
+        view->imp()->surfaceLinked = false;
+
+    if (imp()->uploadJob)
+    {
+        compositor()->imp()->finishUpload(imp()->uploadJob);
+        wl_shm_pool_unref(imp()->uploadJob->pool);
+
+        if (imp()->uploadJob->buffer)
+        {
+            wl_list_remove(&imp()->uploadJob->bufferDestroyListener.link);
+            wl_buffer_send_release(imp()->uploadJob->buffer);
+        }
+
+        delete imp()->uploadJob;
+    }
+
+    delete imp()->uploadTexture;
+
+    if (imp()->deferredUpload.buffer)
+        imp()->releaseDeferredBuffer(true);
+
     if (imp()->texture && imp()->texture != imp()->textureBackup && imp()->texture->imp()->pendingDelete)
         delete imp()->texture;
 
@@ -76,22 +101,36 @@ LSurface::~LSurface()
 void LSurface::setPos(const LPoint &newPos)
 {
     imp()->pos = newPos;
+
+    // Views of this surface and its children can't be tracked from here
+    compositor()->imp()->viewCacheEpoch++;
+    compositor()->imp()->viewInputSerial++;
+    imp()->viewsChanged(true);
 }
 
 void LSurface::setPos(Int32 x, Int32 y)
 {
     imp()->pos.setX(x);
     imp()->pos.setY(y);
+    compositor()->imp()->viewCacheEpoch++;
+    compositor()->imp()->viewInputSerial++;
+    imp()->viewsChanged(true);
 }
 
 void LSurface::setX(Int32 x)
 {
     imp()->pos.setX(x);
+    compositor()->imp()->viewCacheEpoch++;
+    compositor()->imp()->viewInputSerial++;
+    imp()->viewsChanged(true);
 }
 
 void LSurface::setY(Int32 y)
 {
     imp()->pos.setY(y);
+    compositor()->imp()->viewCacheEpoch++;
+    compositor()->imp()->viewInputSerial++;
+    imp()->viewsChanged(true);
 }
 
 const LSize &LSurface::sizeB() const
@@ -172,6 +211,28 @@ LTexture *LSurface::texture() const
     return imp()->texture;
 }
 
+const LRGBAF *LSurface::solidColor() const
+{
+    if (imp()->isSolidColor)
+        return &imp()->solidColor;
+
+    return nullptr;
+}
+
+bool LSurface::commitCoalescingEnabled() const
+{
+    return imp()->coalesceCommits;
+}
+
+void LSurface::enableCommitCoalescing(bool enabled)
+{
+    imp()->coalesceCommits = enabled;
+
+    // Only kept if lazy uploads would have deferred it too
+    if (!enabled && imp()->deferredUpload.buffer && !compositor()->imp()->lazyUploads)
+        imp()->flushDeferredUpload(true);
+}
+
 bool LSurface::hasDamage() const
 {
     return imp()->damaged;
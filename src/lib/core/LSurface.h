@@ -248,6 +248,9 @@ public:
 
     /**
      * @brief Opaque region in surface coordinates.
+     *
+     * Region set by the client, extended to the whole surface for XRGB8888 SHM buffers and, if the
+     * **LOUVRE_INFER_OPAQUE_REGION** environment variable is set to 1, to the tiles of ARGB8888 SHM buffers whose pixels are all opaque.
      */
     const LRegion &opaqueRegion() const;
 
@@ -355,11 +358,51 @@ public:
      * @brief OpenGL texture
      *
      * Representation of the surface's buffer as an OpenGL texture.\n
+     * With asynchronous SHM uploads enabled (LOUVRE_ASYNC_SHM_UPLOAD, headless backend only) the surface alternates between two textures,
+     * so the returned texture should not be kept after damageChanged() is triggered.\n
+     * With lazy SHM uploads (LOUVRE_LAZY_SHM_UPLOAD) or commit coalescing enabled, the texture may not contain the last committed buffer yet.
+     * It is uploaded before a visible LSurfaceView of the surface is drawn.\n
+     * The texture of surfaces drawn as a solid color (see solidColor()) is a 1x1 texture of the color, which must be scaled to the surface size.
      *
      * @warning It could return `nullptr` if the surface is not currently mapped.
      */
     LTexture *texture() const;
 
+    /**
+     * @brief Solid color
+     *
+     * Color of the surface buffer if it is a [wp_single_pixel_buffer_v1](https://wayland.app/protocols/single-pixel-buffer-v1)
+     * or, with the **LOUVRE_SOLID_COLOR_DETECTION** environment variable set to 1, a fully damaged SHM buffer whose pixels are all equal.
+     * Such surfaces should be drawn with LPainter::drawColor() instead of using their texture(), as done by LSurfaceView.\n
+     * Like the content of SHM buffers, the RGB components are premultiplied by the alpha component.
+     *
+     * @return The premultiplied color of the surface or `nullptr` if its buffer is not a single color.
+     */
+    const LRGBAF *solidColor() const;
+
+    /**
+     * @brief Check if commit coalescing is enabled.
+     *
+     * @return `true` if SHM buffers are uploaded right before the next output paints; otherwise, `false`.
+     */
+    bool commitCoalescingEnabled() const;
+
+    /**
+     * @brief Enable or disable commit coalescing.
+     *
+     * When enabled, SHM buffers committed by the surface are not uploaded during the commit but right before the next output paints,
+     * so the new content is displayed in the frame it arrived for. If the client commits again before that, the previous buffer is
+     * released without being uploaded and the damage of both commits is uploaded from the new buffer, so clients committing faster than the refresh rate upload at most one buffer per frame. Buffers are released later than without coalescing,
+     * so clients with a single buffer may block until the next frame is painted. Buffers changing the size or format of the surface, buffers
+     * of cursor surfaces and buffers of surfaces being unmapped are always uploaded right away.
+     *
+     * Commit coalescing is opt-in: the default value is `false`, unless the **LOUVRE_COALESCE_SHM_COMMITS** environment variable is set to 1,
+     * in which case it is `true` for every new surface. Calling this method overrides that value for this surface only.
+     *
+     * @param enabled `true` to enable commit coalescing; `false` to disable.
+     */
+    void enableCommitCoalescing(bool enabled);
+
     /**
      * @brief Native [wl_buffer](https://wayland.app/protocols/wayland#wl_buffer) handle
      *
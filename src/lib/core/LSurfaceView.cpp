@@ -1,6 +1,8 @@
 #include <private/LSurfaceViewPrivate.h>
 #include <private/LViewPrivate.h>
 #include <private/LPainterPrivate.h>
+#include <private/LOutputPrivate.h>
+#include <private/LSurfacePrivate.h>
 #include <LSubsurfaceRole.h>
 #include <LSurface.h>
 #include <LOutput.h>
@@ -11,11 +13,16 @@ LSurfaceView::LSurfaceView(LSurface *surface, LView *parent) : LView(LView::Surf
 {
     m_imp = new LSurfaceViewPrivate();
     imp()->surface = surface;
+    surface->imp()->views.push_back(this);
+    imp()->surfaceLink = std::prev(surface->imp()->views.end());
     enableInput(true);
 }
 
 LSurfaceView::~LSurfaceView()
 {
+    if (imp()->surfaceLinked)
+        surface()->imp()->views.erase(imp()->surfaceLink);
+
     if (imp()->customInputRegion)
         delete imp()->customInputRegion;
 
@@ -47,7 +54,11 @@ bool LSurfaceView::customPosEnabled() const
 
 void LSurfaceView::enableCustomPos(bool enable)
 {
+    if (enable == imp()->customPosEnabled)
+        return;
+
     imp()->customPosEnabled = enable;
+    LViewPrivate::invalidateWorld(this, LViewPrivate::WorldPos);
 }
 
 bool LSurfaceView::customInputRegionEnabled() const
@@ -57,10 +68,14 @@ bool LSurfaceView::customInputRegionEnabled() const
 
 void LSurfaceView::enableCustomInputRegion(bool enabled)
 {
-    if (enabled != imp()->customInputRegionEnabled && mapped())
+    if (enabled == imp()->customInputRegionEnabled)
+        return;
+
+    if (mapped())
         repaint();
 
     imp()->customInputRegionEnabled = enabled;
+    LViewPrivate::inputGeometryChanged();
 }
 
 void LSurfaceView::setCustomPos(const LPoint &pos)
@@ -70,11 +85,17 @@ void LSurfaceView::setCustomPos(const LPoint &pos)
 
 void LSurfaceView::setCustomPos(Int32 x, Int32 y)
 {
-    if (customPosEnabled() && (x != imp()->customPos.x() || y != imp()->customPos.y()) && mapped())
+    if (x == imp()->customPos.x() && y == imp()->customPos.y())
+        return;
+
+    if (customPosEnabled() && mapped())
         repaint();
 
     imp()->customPos.setX(x);
     imp()->customPos.setY(y);
+
+    if (customPosEnabled())
+        LViewPrivate::invalidateWorld(this, LViewPrivate::WorldPos);
 }
 
 const LPoint &LSurfaceView::customPos() const
@@ -102,6 +123,8 @@ void LSurfaceView::setCustomInputRegion(const LRegion *region)
             imp()->customInputRegion = nullptr;
         }
     }
+
+    LViewPrivate::inputGeometryChanged();
 }
 
 const LRegion *LSurfaceView::customInputRegion() const
@@ -210,7 +233,7 @@ void LSurfaceView::requestNextFrame(LOutput *output)
     if (forceRequestNextFrameEnabled())
     {
         surface()->requestNextFrame();
-        view->imp()->threadsMap[output->threadId()].lastRenderedDamageId = surface()->damageId();
+        view->imp()->outputData(output->imp()->slot).lastRenderedDamageId = surface()->damageId();
         return;
     }
 
@@ -223,7 +246,7 @@ void LSurfaceView::requestNextFrame(LOutput *output)
     {
         // If the view is visible on another output and has not rendered the new damage
         // prevent clearing the damage immediately
-        if (o != output && (view->imp()->threadsMap[o->threadId()].lastRenderedDamageId < surface()->damageId()))
+        if (o != output && (view->imp()->outputData(o->imp()->slot).lastRenderedDamageId < surface()->damageId()))
         {
             clearDamage = false;
             o->repaint();
@@ -238,7 +261,7 @@ void LSurfaceView::requestNextFrame(LOutput *output)
             surface()->parent()->requestNextFrame(false);
     }
 
-    view->imp()->threadsMap[output->threadId()].lastRenderedDamageId = surface()->damageId();
+    view->imp()->outputData(output->imp()->slot).lastRenderedDamageId = surface()->damageId();
 }
 
 const LRegion *LSurfaceView::damage() const
@@ -275,6 +298,14 @@ void LSurfaceView::paintRect(LPainter *p,
                               Int32 dstX, Int32 dstY, Int32 dstW, Int32 dstH,
                               Float32 scale, Float32 alpha)
 {
+    // Premultiplied like the texture, which is drawn with its alpha multiplied by alpha
+    if (const LRGBAF *color = surface()->solidColor())
+    {
+        p->imp()->drawColor(dstX, dstY, dstW, dstH,
+                            color->r, color->g, color->b, color->a * alpha);
+        return;
+    }
+
     p->imp()->drawTexture(surface()->texture(),
                     srcX, srcY,
                     srcW, srcH,
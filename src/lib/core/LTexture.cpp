@@ -192,6 +192,7 @@ bool LTexture::updateRect(const LRect &rect, UInt32 stride, const void *buffer)
 
     if (initialized() && imp()->sourceType != Framebuffer)
     {
+        compositor()->imp()->waitUnlockedRenders(this);
         imp()->serial++;
         return compositor()->imp()->graphicBackend->updateTextureRect(this, stride, rect, buffer);
     }
@@ -27,11 +27,15 @@ LTextureView::~LTextureView()
 
 void LTextureView::setPos(Int32 x, Int32 y)
 {
-    if (mapped() && (x != imp()->nativePos.x() || y != imp()->nativePos.y()))
+    if (x == imp()->nativePos.x() && y == imp()->nativePos.y())
+        return;
+
+    if (mapped())
         repaint();
 
     imp()->nativePos.setX(x);
     imp()->nativePos.setY(y);
+    LViewPrivate::invalidateWorld(this, LViewPrivate::WorldPos);
 }
 
 void LTextureView::setPos(const LPoint &pos)
@@ -59,6 +63,8 @@ void LTextureView::setInputRegion(const LRegion *region)
             imp()->inputRegion = nullptr;
         }
     }
+
+    LViewPrivate::inputGeometryChanged();
 }
 
 void LTextureView::setTranslucentRegion(const LRegion *region)
@@ -81,6 +87,11 @@ void LTextureView::setTranslucentRegion(const LRegion *region)
             imp()->translucentRegion = nullptr;
         }
     }
+
+    // Scenes do not compare regions
+    LView *view = this;
+    view->imp()->changeSerial++;
+    LViewPrivate::subtreeChanged(this);
 }
 
 void LTextureView::setBufferScale(Int32 scale)
@@ -88,10 +99,14 @@ void LTextureView::setBufferScale(Int32 scale)
     if (scale < 0)
         scale = 0;
 
-    if (mapped() && scale != imp()->bufferScale)
+    if (scale == imp()->bufferScale)
+        return;
+
+    if (mapped())
         repaint();
 
     imp()->bufferScale = scale;
+    LViewPrivate::inputGeometryChanged();
 }
 
 void LTextureView::setTexture(LTexture *texture)
@@ -112,6 +127,11 @@ void LTextureView::setTexture(LTexture *texture)
         LView *nativeView = this;
 
         nativeView->imp()->markAsChangedOrder(false);
+        LViewPrivate::invalidateWorld(this, LViewPrivate::WorldMapped);
+        LViewPrivate::inputGeometryChanged();
+
+        // It may be mapped or unmapped without calling repaint()
+        LViewPrivate::subtreeChanged(this);
 
         if (mapped())
             repaint();
@@ -128,6 +148,7 @@ void LTextureView::enableDstSize(bool enabled)
     if (enabled != imp()->dstSizeEnabled)
     {
         imp()->dstSizeEnabled = enabled;
+        LViewPrivate::inputGeometryChanged();
         repaint();
     }
 }
@@ -145,8 +166,14 @@ void LTextureView::setDstSize(Int32 w, Int32 h)
     if (h < 0)
         h = 0;
 
-    if (imp()->dstSizeEnabled && (w != imp()->dstSize.w() || h != imp()->dstSize.h()))
+    if (w == imp()->dstSize.w() && h == imp()->dstSize.h())
+        return;
+
+    if (imp()->dstSizeEnabled)
+    {
+        LViewPrivate::inputGeometryChanged();
         repaint();
+    }
 
     imp()->dstSize.setW(w);
     imp()->dstSize.setH(h);
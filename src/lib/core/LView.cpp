@@ -21,11 +21,15 @@ LView::LView(UInt32 type, LView *parent)
 
 LView::~LView()
 {
+    imp()->releaseLayer(this);
     setParent(nullptr);
 
     while (!children().empty())
         children().front()->setParent(nullptr);
 
+    if (imp()->pointerOverScene)
+        imp()->pointerOverScene->imp()->pointerOverViews.erase(imp()->pointerOverLink);
+
     compositor()->imp()->views.erase(imp()->compositorLink);
     delete m_imp;
 }
@@ -61,13 +65,19 @@ UInt32 LView::type() const
 
 void LView::repaint()
 {
-    if (imp()->hasFlag(LVS::RepaintCalled))
-        return;
+    imp()->changeSerial++;
+    LViewPrivate::subtreeChanged(this);
 
     for (std::list<LOutput*>::const_iterator it = outputs().cbegin(); it != outputs().cend(); it++)
-        (*it)->repaint();
+    {
+        LViewPrivate::ViewOutputData &data = imp()->outputData((*it)->imp()->slot);
 
-    imp()->addFlag(LVS::RepaintCalled);
+        if (data.repaintCalled)
+            continue;
+
+        data.repaintCalled = true;
+        (*it)->repaint();
+    }
 }
 
 LView *LView::parent() const
@@ -86,7 +96,12 @@ void LView::setParent(LView *view)
         s->imp()->listChanged = true;
 
     if (parent())
+    {
+        // Layers of the previous parents may still contain this view
+        LViewPrivate::invalidateLayers(parent());
+        LViewPrivate::subtreeChanged(parent());
         parent()->imp()->children.erase(imp()->parentLink);
+    }
 
     if (view)
     {
@@ -100,6 +115,8 @@ void LView::setParent(LView *view)
 
     imp()->markAsChangedOrder();
     imp()->parent = view;
+    LViewPrivate::subtreeChanged(this);
+    LViewPrivate::invalidateWorld(this, LViewPrivate::WorldAll);
 }
 
 void LView::insertAfter(LView *prev, bool switchParent)
@@ -123,6 +140,7 @@ void LView::insertAfter(LView *prev, bool switchParent)
         imp()->parentLink = parent()->imp()->children.begin();
 
         imp()->markAsChangedOrder();
+        LViewPrivate::inputGeometryChanged();
 
         repaint();
     }
@@ -139,6 +157,7 @@ void LView::insertAfter(LView *prev, bool switchParent)
         }
 
         imp()->markAsChangedOrder();
+        LViewPrivate::inputGeometryChanged();
 
         repaint();
 
@@ -171,14 +190,26 @@ bool LView::parentOffsetEnabled() const
 
 void LView::enableParentOffset(bool enabled)
 {
-    if (mapped() && enabled != imp()->hasFlag(LVS::ParentOffset))
+    if (enabled == imp()->hasFlag(LVS::ParentOffset))
+        return;
+
+    if (mapped())
         repaint();
 
     imp()->setFlag(LVS::ParentOffset, enabled);
+    LViewPrivate::invalidateWorld(this, LViewPrivate::WorldPos);
 }
 
 const LPoint &LView::pos() const
 {
+    const UInt64 epoch = compositor()->imp()->currentViewCacheEpoch();
+
+    if (epoch && imp()->hasWorld(LViewPrivate::WorldPos, epoch))
+        return imp()->world.pos;
+
+    // Custom views may compute nativePos() from anything, never cache them
+    bool cacheable = epoch && type() <= Scene;
+
     imp()->tmpPoint = nativePos();
 
     if (parent())
@@ -187,10 +218,19 @@ const LPoint &LView::pos() const
             imp()->tmpPoint *= parent()->scalingVector(parent()->type() == Scene);
 
         if (parentOffsetEnabled())
+        {
             imp()->tmpPoint += parent()->pos();
+            cacheable = cacheable && parent()->imp()->hasWorld(LViewPrivate::WorldPos, epoch);
+        }
     }
 
-    return imp()->tmpPoint;
+    if (!cacheable)
+        return imp()->tmpPoint;
+
+    imp()->world.pos = imp()->tmpPoint;
+    imp()->world.posEpoch = epoch;
+    imp()->world.valid |= LViewPrivate::WorldPos;
+    return imp()->world.pos;
 }
 
 const LSize &LView::size() const
@@ -216,6 +256,7 @@ void LView::enableClipping(bool enabled)
     if (imp()->hasFlag(LVS::Clipping) != enabled)
     {
         imp()->setFlag(LVS::Clipping, enabled);
+        LViewPrivate::inputGeometryChanged();
         repaint();
     }
 }
@@ -230,6 +271,7 @@ void LView::setClippingRect(const LRect &rect)
     if (rect != imp()->clippingRect)
     {
         imp()->clippingRect = rect;
+        LViewPrivate::inputGeometryChanged();
         repaint();
     }
 }
@@ -241,10 +283,14 @@ bool LView::parentClippingEnabled() const
 
 void LView::enableParentClipping(bool enabled)
 {
-    if (mapped() && enabled != imp()->hasFlag(LVS::ParentClipping))
+    if (enabled == imp()->hasFlag(LVS::ParentClipping))
+        return;
+
+    if (mapped())
         repaint();
 
     imp()->setFlag(LVS::ParentClipping, enabled);
+    LViewPrivate::inputGeometryChanged();
 }
 
 bool LView::inputEnabled() const
@@ -254,7 +300,11 @@ bool LView::inputEnabled() const
 
 void LView::enableInput(bool enabled)
 {
+    if (enabled == imp()->hasFlag(LVS::Input))
+        return;
+
     imp()->setFlag(LVS::Input, enabled);
+    LViewPrivate::inputGeometryChanged();
 }
 
 bool LView::scalingEnabled() const
@@ -264,10 +314,14 @@ bool LView::scalingEnabled() const
 
 void LView::enableScaling(bool enabled)
 {
-    if (mapped() && enabled != imp()->hasFlag(LVS::Scaling))
+    if (enabled == imp()->hasFlag(LVS::Scaling))
+        return;
+
+    if (mapped())
         repaint();
 
     imp()->setFlag(LVS::Scaling, enabled);
+    LViewPrivate::inputGeometryChanged();
 }
 
 bool LView::parentScalingEnabled() const
@@ -277,10 +331,14 @@ bool LView::parentScalingEnabled() const
 
 void LView::enableParentScaling(bool enabled)
 {
-    if (mapped() && enabled != imp()->hasFlag(LVS::ParentScaling))
+    if (enabled == imp()->hasFlag(LVS::ParentScaling))
+        return;
+
+    if (mapped())
         repaint();
 
-    return imp()->setFlag(LVS::ParentScaling, enabled);
+    imp()->setFlag(LVS::ParentScaling, enabled);
+    LViewPrivate::invalidateWorld(this, LViewPrivate::WorldScaling | LViewPrivate::WorldPos);
 }
 
 const LSizeF &LView::scalingVector(bool forceIgnoreParent) const
@@ -288,20 +346,30 @@ const LSizeF &LView::scalingVector(bool forceIgnoreParent) const
     if (forceIgnoreParent)
         return imp()->scalingVector;
 
-    imp()->tmpPointF = imp()->scalingVector;
+    if (imp()->hasWorld(LViewPrivate::WorldScaling, 0))
+        return imp()->world.scalingVector;
+
+    imp()->world.scalingVector = imp()->scalingVector;
 
     if (parent() && parentScalingEnabled())
-        imp()->tmpPointF *= parent()->scalingVector(parent()->type() == Scene);
+        imp()->world.scalingVector *= parent()->scalingVector(parent()->type() == Scene);
 
-    return imp()->tmpPointF;
+    imp()->world.valid |= LViewPrivate::WorldScaling;
+    return imp()->world.scalingVector;
 }
 
 void LView::setScalingVector(const LSizeF &scalingVector)
 {
-    if (mapped() && scalingVector != imp()->scalingVector)
+    if (scalingVector == imp()->scalingVector)
+        return;
+
+    if (mapped())
         repaint();
 
     imp()->scalingVector = scalingVector;
+
+    // Children positions are scaled by this vector
+    LViewPrivate::invalidateWorld(this, LViewPrivate::WorldScaling | LViewPrivate::WorldPos);
 }
 
 bool LView::visible() const
@@ -311,8 +379,12 @@ bool LView::visible() const
 
 void LView::setVisible(bool visible)
 {
+    if (visible == imp()->hasFlag(LVS::Visible))
+        return;
+
     bool prev = mapped();
     imp()->setFlag(LVS::Visible, visible);
+    LViewPrivate::invalidateWorld(this, LViewPrivate::WorldMapped);
 
     if (prev != mapped())
         repaint();
@@ -320,10 +392,32 @@ void LView::setVisible(bool visible)
 
 bool LView::mapped() const
 {
+    const UInt64 epoch = compositor()->imp()->currentViewCacheEpoch();
+
+    if (epoch && imp()->hasWorld(LViewPrivate::WorldMapped, epoch))
+        return imp()->world.mapped;
+
+    bool cacheable = epoch && type() <= Scene;
+    bool result;
+
     if (type() == Scene && !parent())
-        return visible();
+        result = visible();
+    else if (!visible() || !parent())
+        result = false;
+    else
+    {
+        result = nativeMapped() && parent()->mapped();
+        cacheable = cacheable && parent()->imp()->hasWorld(LViewPrivate::WorldMapped, epoch);
+    }
 
-    return visible() && nativeMapped() && parent() && parent()->mapped();
+    if (cacheable)
+    {
+        imp()->world.mapped = result;
+        imp()->world.mappedEpoch = epoch;
+        imp()->world.valid |= LViewPrivate::WorldMapped;
+    }
+
+    return result;
 }
 
 Float32 LView::opacity(bool forceIgnoreParent) const
@@ -331,10 +425,16 @@ Float32 LView::opacity(bool forceIgnoreParent) const
     if (forceIgnoreParent)
         return imp()->opacity;
 
+    if (imp()->hasWorld(LViewPrivate::WorldOpacity, 0))
+        return imp()->world.opacity;
+
+    imp()->world.opacity = imp()->opacity;
+
     if (parentOpacityEnabled() && parent())
-        return imp()->opacity * parent()->opacity(parent()->type() == Scene);
+        imp()->world.opacity *= parent()->opacity(parent()->type() == Scene);
 
-    return imp()->opacity;
+    imp()->world.valid |= LViewPrivate::WorldOpacity;
+    return imp()->world.opacity;
 }
 
 void LView::setOpacity(Float32 opacity)
@@ -344,10 +444,14 @@ void LView::setOpacity(Float32 opacity)
     else if(opacity > 1.f)
         opacity = 1.f;
 
-    if (mapped() && opacity != imp()->opacity)
+    if (opacity == imp()->opacity)
+        return;
+
+    if (mapped())
         repaint();
 
     imp()->opacity = opacity;
+    LViewPrivate::invalidateWorld(this, LViewPrivate::WorldOpacity);
 }
 
 bool LView::parentOpacityEnabled() const
@@ -357,10 +461,14 @@ bool LView::parentOpacityEnabled() const
 
 void LView::enableParentOpacity(bool enabled)
 {
-    if (mapped() && imp()->hasFlag(LVS::ParentOpacity) != enabled)
+    if (imp()->hasFlag(LVS::ParentOpacity) == enabled)
+        return;
+
+    if (mapped())
         repaint();
 
     imp()->setFlag(LVS::ParentOpacity, enabled);
+    LViewPrivate::invalidateWorld(this, LViewPrivate::WorldOpacity);
 }
 
 bool LView::forceRequestNextFrameEnabled() const
@@ -370,7 +478,31 @@ bool LView::forceRequestNextFrameEnabled() const
 
 void LView::enableForceRequestNextFrame(bool enabled) const
 {
+    if (forceRequestNextFrameEnabled() == enabled)
+        return;
+
     imp()->setFlag(LVS::ForceRequestNextFrame, enabled);
+
+    // Subtrees containing it are never skipped
+    LViewPrivate::subtreeChanged((LView*)this);
+}
+
+bool LView::cachingEnabled() const
+{
+    return imp()->hasFlag(LVS::Caching);
+}
+
+void LView::enableCaching(bool enabled)
+{
+    if (cachingEnabled() == enabled)
+        return;
+
+    imp()->setFlag(LVS::Caching, enabled);
+    imp()->layerStaticFrames = 0;
+    LViewPrivate::subtreeChanged(this);
+
+    if (!enabled)
+        imp()->releaseLayer(this);
 }
 
 void LView::setBlendFunc(GLenum sFactor, GLenum dFactor)
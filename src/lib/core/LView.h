@@ -35,6 +35,10 @@
  * This method is used by the pos() method, which returns the position equal to nativePos(), or transformed
  * if parent offset or parent scaling is enabled.
  *
+ * @note While a scene is rendering or looking for the view under the cursor, the position and mapping state of built-in
+ *       view types are cached, so their nativePos() and nativeMapped() values must not change without calling a setter of the view.
+ *       Views with a custom type() (greater than LView::Scene) are never cached.
+ *
  * ### Size
  *
  * The size of the view in surface coordinates should be implemented in the nativeSize() virtual method.
@@ -92,6 +96,18 @@
  *
  * Scenes can trigger specific input events on views through the pointerEnterEvent(), pointerMoveEvent(), keyEvent(), and other related methods.
  * Implement these virtual methods to listen and respond to those events if needed.
+ *
+ * ## Threads
+ *
+ * Each output is rendered by its own thread. Everything a scene calculates while rendering (rects, damage, opaque and translucent regions, occlusion,
+ * pending repaint() requests and the framebuffer of the LScene view) is stored separately for each output, but the views themselves are shared, so views must only be created, modified or destroyed while holding
+ * the compositor lock, that is, from the main thread (e.g. within Wayland requests, input events, timers or animations) or from LOutput::paintGL().
+ * Scenes rendering different outputs are serialized, since the virtual methods above (and the frame callbacks of surfaces) are not required to be thread-safe.
+ * The cached world position and mapping of views and the layers of views with caching enabled are shared by all outputs, and also rely on the lock.
+ *
+ * If concurrent rendering is enabled (see LScene::handlePaintGL()), once the damage is calculated the frame is drawn without the lock.
+ * Any view can be modified or destroyed meanwhile, changes are drawn in the next frame. Updating or destroying a texture being drawn waits until
+ * the output finishes.
  */
 class Louvre::LView : public LObject
 {
@@ -162,6 +178,9 @@ public:
      *
      * This method triggers a repaint for all outputs where this view is currently visible.\n
      * Outputs are those returned by the LView::outputs() method.
+     *
+     * Scenes skip recalculating the clipping, opaque and translucent regions of built-in views whose rect, opacity, color factor
+     * and damage did not change since they were last drawn. Calling repaint() also tells them that any other state of the view changed.
      */
     void repaint();
 
@@ -395,8 +414,9 @@ public:
      * Setting a value to 1 disables scaling for that axis.
      *
      * @param scalingVector The (width, height) scaling vector for the view's size.
-     * @warning Scaling should be used with moderation, preferably during animations, as damage tracking is disabled due to precision loss caused by scaling.
-     * This means the entire view is repainted if changes occur, which can be inefficient.
+     * @note The damage, opaque and translucent regions of scaled views are scaled and rounded to whole pixels,
+     *       extending the damage and shrinking the opaque region by 1 pixel to account for texture filtering.
+     *       Changing the scaling vector repaints the entire view, and scaled LSceneView instances are always fully repainted.
      */
     void setScalingVector(const LSizeF& scalingVector);
 
@@ -493,6 +513,30 @@ public:
      */
     void enableForceRequestNextFrame(bool enabled) const;
 
+    /**
+     * @brief Check if caching is enabled.
+     *
+     * @return `true` if the view and its children may be cached; otherwise, `false`.
+     */
+    bool cachingEnabled() const;
+
+    /**
+     * @brief Enable or disable caching the view and its children.
+     *
+     * When enabled and neither the view nor any of its children changed during a number of frames
+     * (10 by default, see the **LOUVRE_VIEW_CACHE_FRAMES** environment variable), scene views render them
+     * into a single buffer and draw it instead, until one of them changes again.
+     * This reduces the number of draw calls for complex static subtrees such as panels or decorations.
+     *
+     * Subtrees containing scene views, custom views, views with a custom blend function
+     * (see setBlendFunc()) or less than two renderable views are never cached.
+     *
+     * The default value is `false`.
+     *
+     * @param enabled `true` to enable caching; `false` to disable.
+     */
+    void enableCaching(bool enabled);
+
     /**
      * @brief Set the alpha blending function for the view.
      *
@@ -691,6 +735,10 @@ public:
      * with the specified source and destination surface coordinates, size, scaling, and alpha value.
      *
     * @note Alternatively, you have the option to use your own custom OpenGL shaders/program for rendering, in place of the provided LPainter.
+     *
+     * @note LPainter may batch the rects drawn by LSceneView into a single draw call, so they are not necessarily drawn when
+     *       its draw methods return. Pending rects are submitted before paintRect() is called for views with a custom type(). If you subclass
+     *       one of the built-in views and issue your own OpenGL calls, call LPainter::setViewport() or LPainter::bindProgram() first.
      *
      * @param p The LPainter object to perform the painting.
      * @param srcX The source x-coordinate within the view to copy from.
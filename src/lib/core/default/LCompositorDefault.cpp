@@ -6,6 +6,7 @@
 #include <protocols/XdgDecoration/private/GXdgDecorationManagerPrivate.h>
 #include <protocols/LinuxDMABuf/private/GLinuxDMABufPrivate.h>
 #include <protocols/WpPresentationTime/private/GWpPresentationPrivate.h>
+#include <protocols/WpSinglePixelBuffer/private/GWpSinglePixelBufferManagerPrivate.h>
 #include <LCompositor.h>
 #include <LToplevelRole.h>
 #include <LCursor.h>
@@ -50,6 +51,9 @@ bool LCompositor::createGlobalsRequest()
     wl_global_create(display(), &wp_presentation_interface,
                      LOUVRE_WP_PRESENTATION_VERSION, this, &Protocols::WpPresentationTime::GWpPresentation::GWpPresentationPrivate::bind);
 
+    wl_global_create(display(), &wp_single_pixel_buffer_manager_v1_interface,
+                     LOUVRE_WP_SINGLE_PIXEL_BUFFER_MANAGER_VERSION, this, &Protocols::WpSinglePixelBuffer::GWpSinglePixelBufferManager::GWpSinglePixelBufferManagerPrivate::bind);
+
     wl_display_init_shm(display());
 
     return true;
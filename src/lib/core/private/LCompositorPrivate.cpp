@@ -6,9 +6,11 @@
 #include <private/LPainterPrivate.h>
 #include <private/LCursorPrivate.h>
 #include <private/LAnimationPrivate.h>
+#include <private/LTexturePrivate.h>
 #include <LTime.h>
 #include <LLog.h>
 #include <EGL/egl.h>
+#include <sys/eventfd.h>
 #include <dlfcn.h>
 
 void LCompositor::LCompositorPrivate::processRemovedGlobals()
@@ -254,6 +256,9 @@ bool LCompositor::LCompositorPrivate::initGraphicBackend()
     cursor = new LCursor();
     compositor->cursorInitialized();
 
+    if (asyncUploads)
+        initUploadThread();
+
     return true;
 }
 
@@ -305,6 +310,14 @@ void LCompositor::LCompositorPrivate::unitInputBackend(bool closeLib)
 
 void LCompositor::LCompositorPrivate::unitGraphicBackend(bool closeLib)
 {
+    unitUploadThread();
+
+    while (!layerPool.empty())
+    {
+        delete layerPool.back();
+        layerPool.pop_back();
+    }
+
     if (painter)
     {
         delete painter;
@@ -578,6 +591,74 @@ void LCompositor::LCompositorPrivate::unlock()
     renderMutex.unlock();
 }
 
+LRenderBuffer *LCompositor::LCompositorPrivate::acquireLayerBuffer(const LSize &sizeB)
+{
+    if (layerPool.empty())
+        return new LRenderBuffer(sizeB);
+
+    // Resizing destroys the textures, prefer one with the same size
+    std::vector<LRenderBuffer*>::iterator it = layerPool.begin();
+
+    for (std::vector<LRenderBuffer*>::iterator b = layerPool.begin(); b != layerPool.end(); b++)
+    {
+        if ((*b)->sizeB() == sizeB)
+        {
+            it = b;
+            break;
+        }
+    }
+
+    LRenderBuffer *buffer = *it;
+    layerPool.erase(it);
+    buffer->setSizeB(sizeB);
+    return buffer;
+}
+
+void LCompositor::LCompositorPrivate::releaseLayerBuffer(LRenderBuffer *buffer)
+{
+    if (!buffer)
+        return;
+
+    if (layerPool.size() < LOUVRE_LAYER_POOL_SIZE)
+        layerPool.push_back(buffer);
+    else
+        delete buffer;
+}
+
+void LCompositor::LCompositorPrivate::beginUnlockedRender(const std::vector<const LTexture*> &textures)
+{
+    // The textures can not be destroyed meanwhile, they are alive while the render mutex is held
+    for (const LTexture *texture : textures)
+        texture->imp()->unlockedRenders++;
+
+    unlock();
+}
+
+void LCompositor::LCompositorPrivate::endUnlockedRender(const std::vector<const LTexture*> &textures)
+{
+    /* Must be decremented before locking, the thread holding the mutex may be waiting.
+     * A waiting thread may destroy a texture as soon as it reads 0, so the mutex is held
+     * until none of them is accessed */
+    {
+        std::lock_guard<std::mutex> guard(unlockedRendersMutex);
+
+        for (const LTexture *texture : textures)
+            texture->imp()->unlockedRenders--;
+    }
+
+    unlockedRendersCond.notify_all();
+    lock();
+}
+
+void LCompositor::LCompositorPrivate::waitUnlockedRenders(const LTexture *texture)
+{
+    if (texture->imp()->unlockedRenders.load() == 0)
+        return;
+
+    std::unique_lock<std::mutex> lock(unlockedRendersMutex);
+    unlockedRendersCond.wait(lock, [texture]{ return texture->imp()->unlockedRenders.load() == 0; });
+}
+
 void LCompositor::LCompositorPrivate::unlockPoll()
 {
     if (pollUnlocked)
@@ -600,6 +681,29 @@ void LCompositor::LCompositorPrivate::destroyNativeTextures(std::list<GLuint> &l
     }
 }
 
+thread_local LOutput *LCompositor::LCompositorPrivate::renderingOutput = nullptr;
+
+UInt32 LCompositor::LCompositorPrivate::acquireOutputSlot(LOutput *output)
+{
+    for (UInt32 i = 0; i < outputSlots.size(); i++)
+    {
+        if (!outputSlots[i])
+        {
+            outputSlots[i] = output;
+            return i;
+        }
+    }
+
+    outputSlots.push_back(output);
+    return outputSlots.size() - 1;
+}
+
+void LCompositor::LCompositorPrivate::releaseOutputSlot(UInt32 slot)
+{
+    if (slot < outputSlots.size())
+        outputSlots[slot] = nullptr;
+}
+
 LPainter *LCompositor::LCompositorPrivate::findPainter()
 {
     LPainter *painter = nullptr;
@@ -621,3 +725,275 @@ LPainter *LCompositor::LCompositorPrivate::findPainter()
 
     return painter;
 }
+
+void LCompositor::LCompositorPrivate::initUploadThread()
+{
+    if (!graphicBackend->initializeUploadContext || !graphicBackend->uninitializeUploadContext)
+    {
+        LLog::warning("[LCompositorPrivate::initUploadThread] The graphic backend does not support asynchronous SHM uploads.");
+        return;
+    }
+
+    uploadFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (uploadFd == -1)
+    {
+        LLog::error("[LCompositorPrivate::initUploadThread] Failed to create eventfd.");
+        return;
+    }
+
+    bool initFinished = false;
+    uploadThreadExit = false;
+    uploadThread = std::thread([this, &initFinished]
+    {
+        const bool initialized = graphicBackend->initializeUploadContext();
+
+        {
+            std::lock_guard<std::mutex> lock(uploadMutex);
+            uploadThreadRunning = initialized;
+            initFinished = true;
+        }
+
+        uploadCond.notify_all();
+
+        if (initialized)
+        {
+            uploadThreadLoop();
+            graphicBackend->uninitializeUploadContext();
+        }
+    });
+
+    std::unique_lock<std::mutex> lock(uploadMutex);
+    uploadCond.wait(lock, [&initFinished]{ return initFinished; });
+
+    if (!uploadThreadRunning)
+    {
+        lock.unlock();
+        uploadThread.join();
+        close(uploadFd);
+        uploadFd = -1;
+        LLog::error("[LCompositorPrivate::initUploadThread] Failed to initialize the upload context.");
+        return;
+    }
+
+    uploadEventSource = LCompositor::addFdListener(uploadFd, this, &processUploads);
+    LLog::debug("[LCompositorPrivate::initUploadThread] Asynchronous SHM uploads enabled.");
+}
+
+void LCompositor::LCompositorPrivate::unitUploadThread()
+{
+    if (!uploadThreadRunning)
+        return;
+
+    // The thread finishes the queued jobs before exiting
+    {
+        std::lock_guard<std::mutex> lock(uploadMutex);
+        uploadThreadExit = true;
+    }
+
+    uploadCond.notify_all();
+    uploadThread.join();
+    uploadThreadRunning = false;
+
+    // Surfaces still alive release their buffers
+    processUploads(-1, 0, this);
+
+    LCompositor::removeFdListener(uploadEventSource);
+    uploadEventSource = nullptr;
+    close(uploadFd);
+    uploadFd = -1;
+}
+
+void LCompositor::LCompositorPrivate::planUpload(const LRegion &region, UInt32 pixelSize, std::vector<LRect> &rects) const
+{
+    Int32 n;
+    const LBox *boxes = region.boxes(&n);
+    rects.clear();
+
+    if (n == 0)
+        return;
+
+    // Pixman boxes are sorted in bands of the same height
+    UInt64 boxesArea = 0, bandsArea = 0;
+    UInt32 bands = 0;
+    Int32 bandX1 = 0, bandX2 = 0;
+
+    for (Int32 i = 0; i < n; i++)
+    {
+        const LBox &box = boxes[i];
+        boxesArea += UInt64(box.x2 - box.x1) * UInt64(box.y2 - box.y1);
+
+        if (i == 0 || box.y1 != boxes[i - 1].y1)
+        {
+            bands++;
+            bandX1 = box.x1;
+        }
+
+        bandX2 = box.x2;
+
+        if (i == n - 1 || boxes[i + 1].y1 != box.y1)
+            bandsArea += UInt64(bandX2 - bandX1) * UInt64(box.y2 - box.y1);
+    }
+
+    const LBox &extents = region.extents();
+    const UInt64 extentsArea = UInt64(extents.x2 - extents.x1) * UInt64(extents.y2 - extents.y1);
+    const UInt64 boxesCost = n * UInt64(uploadCallCost) + boxesArea * pixelSize;
+    const UInt64 bandsCost = bands * UInt64(uploadCallCost) + bandsArea * pixelSize;
+    const UInt64 extentsCost = uploadCallCost + extentsArea * pixelSize;
+
+    if (extentsCost <= bandsCost && extentsCost <= boxesCost)
+    {
+        rects.push_back(LRect(extents.x1, extents.y1, extents.x2 - extents.x1, extents.y2 - extents.y1));
+        return;
+    }
+
+    if (bandsCost < boxesCost)
+    {
+        for (Int32 i = 0; i < n; i++)
+        {
+            if (i == 0 || boxes[i].y1 != boxes[i - 1].y1)
+                bandX1 = boxes[i].x1;
+
+            if (i == n - 1 || boxes[i + 1].y1 != boxes[i].y1)
+                rects.push_back(LRect(bandX1, boxes[i].y1, boxes[i].x2 - bandX1, boxes[i].y2 - boxes[i].y1));
+        }
+
+        return;
+    }
+
+    for (Int32 i = 0; i < n; i++)
+        rects.push_back(LRect(boxes[i].x1, boxes[i].y1, boxes[i].x2 - boxes[i].x1, boxes[i].y2 - boxes[i].y1));
+}
+
+void LCompositor::LCompositorPrivate::uploadThreadLoop()
+{
+    std::unique_lock<std::mutex> lock(uploadMutex);
+    std::vector<LRect> rects;
+
+    while (true)
+    {
+        uploadCond.wait(lock, [this]{ return uploadThreadExit || !uploadQueue.empty(); });
+
+        if (uploadQueue.empty())
+            return;
+
+        // Jobs are only modified by the main thread before being queued and after being done
+        UploadJob *job = uploadQueue.front();
+        lock.unlock();
+
+        bool ok = true;
+        LTexture *texture = job->texture;
+        const UInt32 pixelSize = LTexture::formatBytesPerPixel(texture->format());
+
+        wl_shm_buffer_begin_access(job->shmBuffer);
+        const UChar8 *data = (const UChar8*)wl_shm_buffer_get_data(job->shmBuffer);
+
+        if (job->create)
+        {
+            ok = graphicBackend->createTextureFromCPUBuffer(texture, texture->sizeB(), job->stride, texture->format(), data);
+            uploadStats.bytes += UInt64(texture->sizeB().area()) * pixelSize;
+            uploadStats.calls++;
+        }
+        else
+        {
+            planUpload(job->region, pixelSize, rects);
+
+            for (std::vector<LRect>::const_iterator rect = rects.begin(); rect != rects.end() && ok; rect++)
+            {
+                ok = graphicBackend->updateTextureRect(texture,
+                                                       job->stride,
+                                                       *rect,
+                                                       &data[rect->x() * pixelSize + rect->y() * job->stride]);
+                uploadStats.bytes += UInt64(rect->area()) * pixelSize;
+                uploadStats.calls++;
+            }
+        }
+
+        wl_shm_buffer_end_access(job->shmBuffer);
+
+        // The texture is sampled by other contexts once published
+        glFinish();
+
+        lock.lock();
+        uploadQueue.pop_front();
+        job->failed = !ok;
+        job->done = true;
+        uploadsDone.push_back(job);
+        uploadCond.notify_all();
+
+        UInt64 value = 1;
+        ssize_t n = write(uploadFd, &value, sizeof(value));
+        L_UNUSED(n);
+    }
+}
+
+void LCompositor::LCompositorPrivate::queueUpload(UploadJob *job)
+{
+    {
+        std::lock_guard<std::mutex> lock(uploadMutex);
+        uploadQueue.push_back(job);
+    }
+
+    uploadCond.notify_all();
+}
+
+void LCompositor::LCompositorPrivate::waitUpload(UploadJob *job)
+{
+    std::unique_lock<std::mutex> lock(uploadMutex);
+    uploadCond.wait(lock, [job]{ return job->done; });
+}
+
+void LCompositor::LCompositorPrivate::finishUpload(UploadJob *job)
+{
+    std::unique_lock<std::mutex> lock(uploadMutex);
+    uploadCond.wait(lock, [job]{ return job->done; });
+    uploadsDone.remove(job);
+}
+
+Int32 LCompositor::LCompositorPrivate::processUploads(Int32 fd, UInt32 mask, void *data)
+{
+    L_UNUSED(mask);
+    LCompositorPrivate *imp = (LCompositorPrivate*)data;
+
+    // fd is -1 when called from unitUploadThread()
+    if (fd != -1)
+    {
+        UInt64 value;
+        ssize_t n = read(fd, &value, sizeof(value));
+        L_UNUSED(n);
+    }
+
+    // One at a time, surfaces destroyed while publishing remove their jobs from the list
+    while (true)
+    {
+        imp->uploadMutex.lock();
+
+        if (imp->uploadsDone.empty())
+        {
+            imp->uploadMutex.unlock();
+            break;
+        }
+
+        UploadJob *job = imp->uploadsDone.front();
+        imp->uploadsDone.pop_front();
+        imp->uploadMutex.unlock();
+        job->surface->imp()->publishUpload();
+    }
+
+    return 0;
+}
+
+void LCompositor::LCompositorPrivate::flushCoalescedUploads()
+{
+    std::list<LSurface*>::iterator it = deferredUploads.begin();
+
+    // Flushing removes the surface from the list
+    while (it != deferredUploads.end())
+    {
+        LSurface *surface = *it;
+        it++;
+
+        if (surface->imp()->coalesceCommits && surface->mapped())
+            surface->imp()->flushDeferredUpload(true);
+    }
+}
@@ -4,10 +4,14 @@
 #include <LOutput.h>
 #include <private/LRenderBufferPrivate.h>
 #include <LCompositor.h>
+#include <LRegion.h>
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 #include <sys/epoll.h>
+#include <condition_variable>
+#include <atomic>
 #include <map>
+#include <vector>
 #include <unistd.h>
 
 LPRIVATE_CLASS(LCompositor)
@@ -101,9 +105,186 @@ LPRIVATE_CLASS(LCompositor)
     void addRenderBufferToDestroy(std::thread::id thread, LRenderBuffer::LRenderBufferPrivate::ThreadData &data);
     static LPainter *findPainter();
 
+    /* Each output gets a small dense index (slot) when added, views and scene views store
+     * their per-output state in flat arrays indexed by it. Slots of removed outputs are reused */
+    std::vector<LOutput*> outputSlots;
+    UInt32 acquireOutputSlot(LOutput *output);
+    void releaseOutputSlot(UInt32 slot);
+
+    // Output rendered by the calling thread (nullptr if not a rendering thread)
+    static thread_local LOutput *renderingOutput;
+
     std::list<GLuint>nativeTexturesToDestroy;
     static void destroyNativeTextures(std::list<GLuint>&list);
 
+    /* Views reuse their cached pos() and mapped() only while viewCachePasses > 0 (scene
+     * rendering or hit-testing) and only within the same epoch. The epoch is bumped at
+     * the beginning of each pass and when state views can't track changes (e.g. a surface pos).
+     * Passes and the world cache of views may only be touched while holding the compositor lock,
+     * which serializes the traversals of all outputs and the main thread. Both counters are atomic
+     * so that reading them from a rendering thread is never a data race */
+    std::atomic<UInt32> viewCachePasses { 0 };
+    std::atomic<UInt64> viewCacheEpoch { 1 };
+
+    // Bumped when the input bounds of any view may have changed, scenes rebuild their hit-testing grid
+    UInt64 viewInputSerial = 1;
+
+    // Bumped when outputs are added, removed, moved or resized, views check again which outputs they intersect
+    UInt32 outputLayoutSerial = 1;
+
+    // Min time between frame callbacks of occluded views in ms, 0 disables them (LOUVRE_OCCLUDED_FRAME_INTERVAL)
+    UInt32 occludedFrameInterval = 0;
+
+    /* Regions of scenes with more boxes are merged into bounding rects adding at most damageMaxWaste
+     * pixels per rect, see LRegion::coarsen() (LOUVRE_DAMAGE_MAX_BOXES, LOUVRE_DAMAGE_MAX_WASTE) */
+    UInt32 damageMaxBoxes = 32;
+    Float32 damageMaxWaste = 0.25f;
+
+    // Static frames before the views with caching enabled are rendered into a layer (LOUVRE_VIEW_CACHE_FRAMES)
+    UInt32 layerFrames = 10;
+
+    // Render buffers of released view layers, reused by the next layers (see LViewPrivate::layer)
+    std::vector<LRenderBuffer*> layerPool;
+    LRenderBuffer *acquireLayerBuffer(const LSize &sizeB);
+    void releaseLayerBuffer(LRenderBuffer *buffer);
+
+    /* Outputs draw the recorded LScene frame without holding the render mutex (LOUVRE_CONCURRENT_RENDERING).
+     * Textures a recorded frame samples must not be modified or destroyed until it is drawn, so threads
+     * holding the render mutex call waitUnlockedRenders() with the texture first */
+    bool concurrentRendering = false;
+    std::mutex unlockedRendersMutex;
+    std::condition_variable unlockedRendersCond;
+
+    // Marks the textures as sampled (see LTexturePrivate::unlockedRenders) and releases the render mutex
+    void beginUnlockedRender(const std::vector<const LTexture*> &textures);
+
+    // Unmarks the textures and acquires the render mutex again
+    void endUnlockedRender(const std::vector<const LTexture*> &textures);
+
+    // Waits until no recorded frame being drawn samples the texture
+    void waitUnlockedRenders(const LTexture *texture);
+
+    /* Uploads of SHM buffers committed while the surface was not drawn since the previous
+     * commit are deferred until it is (LOUVRE_LAZY_SHM_UPLOAD), see LSurfacePrivate::deferUpload() */
+    bool lazyUploads = false;
+
+    // Default value of LSurface::commitCoalescingEnabled() (LOUVRE_COALESCE_SHM_COMMITS)
+    bool coalesceCommits = false;
+
+    // Surfaces with a deferred SHM upload, see LSurfacePrivate::deferUpload()
+    std::list<LSurface*> deferredUploads;
+
+    /* Uploads the deferred buffers of surfaces with commit coalescing enabled, called
+     * by each output before painting so the newest buffers are drawn in the frame they arrived for */
+    void flushCoalescedUploads();
+
+    // Scans the alpha of damaged ARGB8888 SHM buffer tiles (LOUVRE_INFER_OPAQUE_REGION), see LSurfacePrivate::inferOpaqueRegion()
+    bool inferOpaqueRegions = false;
+
+    // Draws fully damaged uniform SHM buffers as solid colors (LOUVRE_SOLID_COLOR_DETECTION), see LSurfacePrivate::detectSolidColor()
+    bool detectSolidColors = false;
+
+    // SHM upload counters, reported by louvre-bench
+    struct UploadStats
+    {
+        std::atomic<UInt64> commits { 0 };
+
+        // Bytes copied to textures
+        std::atomic<UInt64> bytes { 0 };
+
+        // Texture upload calls
+        std::atomic<UInt64> calls { 0 };
+
+        // Commits whose upload was deferred
+        std::atomic<UInt64> deferred { 0 };
+
+        // Deferred buffers replaced by a newer one before being uploaded
+        std::atomic<UInt64> skipped { 0 };
+
+        // Commits drawn as a solid color without uploading the buffer
+        std::atomic<UInt64> solid { 0 };
+    } uploadStats;
+
+    /* Estimated overhead of each texture upload call in bytes (LOUVRE_SHM_UPLOAD_CALL_COST), used by
+     * planUpload() to decide whether merging damaged boxes is cheaper than uploading them separately */
+    UInt32 uploadCallCost = 32768;
+
+    /* Fills rects with the rects to upload to cover region: its boxes, one rect per row band
+     * or its extents, whichever has the lowest estimated cost */
+    void planUpload(const LRegion &region, UInt32 pixelSize, std::vector<LRect> &rects) const;
+
+    // Reused by threads holding the render mutex to plan uploads
+    std::vector<LRect> uploadRects;
+
+    /* Damaged rects of SHM buffers are copied to textures by the upload thread, using a context sharing
+     * textures with the renderers (LOUVRE_ASYNC_SHM_UPLOAD). Requires the initializeUploadContext() backend
+     * hook, see LSurfacePrivate::queueUpload() */
+    struct UploadJob
+    {
+        LSurface *surface;
+
+        // Set to nullptr if destroyed before the job is published
+        wl_resource *buffer;
+        wl_shm_buffer *shmBuffer;
+        wl_listener bufferDestroyListener;
+
+        // Referenced while queued, so wl_shm_pool.resize can't remap the pool during the copy
+        wl_shm_pool *pool;
+
+        // Back texture of the surface, created from the whole buffer if create is true
+        LTexture *texture;
+        bool create;
+        UInt32 stride;
+
+        // Rects copied to the texture, new damage of the surface and rects the previous texture lacks, in buffer coords
+        LRegion region;
+        LRegion damage;
+        LRegion stale;
+
+        bool done = false;
+        bool failed = false;
+    };
+
+    bool asyncUploads = false;
+    bool uploadThreadRunning = false;
+    bool uploadThreadExit = false;
+    std::thread uploadThread;
+    std::mutex uploadMutex;
+    std::condition_variable uploadCond;
+    std::list<UploadJob*> uploadQueue;
+    std::list<UploadJob*> uploadsDone;
+    Int32 uploadFd = -1;
+    wl_event_source *uploadEventSource = nullptr;
+    void initUploadThread();
+    void unitUploadThread();
+    void uploadThreadLoop();
+    void queueUpload(UploadJob *job);
+
+    // Blocks until the thread is done with the job
+    void waitUpload(UploadJob *job);
+
+    // Same as waitUpload() but the job is then not published by processUploads()
+    void finishUpload(UploadJob *job);
+
+    // Publishes the finished jobs, called from the main thread
+    static Int32 processUploads(Int32 fd, UInt32 mask, void *data);
+
+    inline void beginViewCachePass()
+    {
+        if (viewCachePasses++ == 0)
+            viewCacheEpoch++;
+    }
+
+    inline void endViewCachePass()
+    {
+        viewCachePasses--;
+    }
+
+    inline UInt64 currentViewCacheEpoch() const
+    {
+        return viewCachePasses.load() ? viewCacheEpoch.load() : 0;
+    }
+
     Int32 greatestOutputScale = 1;
 
     inline void updateGreatestOutputScale()
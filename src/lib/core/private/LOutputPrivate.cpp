@@ -13,6 +13,7 @@
 bool LOutput::LOutputPrivate::initialize()
 {
     output->imp()->state = LOutput::PendingInitialize;
+    slot = compositor()->imp()->acquireOutputSlot(output);
     // The backend must call LOutputPrivate::backendInitialized() before initializeGL()
     return compositor()->imp()->graphicBackend->initializeOutput(output);
 }
@@ -20,6 +21,7 @@ bool LOutput::LOutputPrivate::initialize()
 void LOutput::LOutputPrivate::backendInitializeGL()
 {
     threadId = std::this_thread::get_id();
+    compositor()->imp()->renderingOutput = output;
     painter = new LPainter();
     painter->imp()->output = output;
     painter->bindFramebuffer(output->framebuffer());
@@ -70,7 +72,11 @@ void LOutput::LOutputPrivate::backendPaintGL()
 
     compositor()->imp()->processAnimations();
     pendingRepaint = false;
+    updateBufferAge();
+    compositor()->imp()->flushCoalescedUploads();
+    paintGLLocked = callLock;
     output->paintGL();
+    paintGLLocked = false;
     compositor()->flushClients();
     compositor()->imp()->destroyPendingRenderBuffers(&output->imp()->threadId);
     compositor()->imp()->destroyNativeTextures(nativeTexturesToDestroy);
@@ -79,6 +85,32 @@ void LOutput::LOutputPrivate::backendPaintGL()
         compositor()->imp()->unlock();
 }
 
+void LOutput::LOutputPrivate::updateBufferAge()
+{
+    if (compositor()->imp()->graphicBackend->getOutputBufferAge)
+    {
+        bufferAge = compositor()->imp()->graphicBackend->getOutputBufferAge(output);
+        return;
+    }
+
+    const Int32 count = output->buffersCount();
+    const Int32 index = output->currentBuffer();
+
+    if ((Int32)bufferFrames.size() != count)
+        bufferFrames.assign(count, 0);
+
+    bufferFrame++;
+
+    if (index < 0 || index >= count)
+    {
+        bufferAge = 0;
+        return;
+    }
+
+    bufferAge = bufferFrames[index] == 0 ? 0 : bufferFrame - bufferFrames[index];
+    bufferFrames[index] = bufferFrame;
+}
+
 void LOutput::LOutputPrivate::backendResizeGL()
 {
     bool callLock = output->imp()->callLock.load();
@@ -98,6 +130,8 @@ void LOutput::LOutputPrivate::backendResizeGL()
     if (callLock)
         compositor()->imp()->lock();
 
+    // Buffers may have been reallocated
+    bufferFrames.clear();
     output->resizeGL();
 
     if (lastPos != rect.pos())
@@ -171,6 +205,7 @@ void LOutput::LOutputPrivate::updateRect()
     }
 
     rect.setSize(sizeB/outputScale);
+    compositor()->imp()->outputLayoutSerial++;
 }
 
 void LOutput::LOutputPrivate::updateGlobals()
@@ -4,6 +4,7 @@
 #include <LOutput.h>
 #include <private/LRenderBufferPrivate.h>
 #include <atomic>
+#include <vector>
 
 LPRIVATE_CLASS(LOutput)
     LOutputFramebuffer *fb;
@@ -17,6 +18,19 @@ LPRIVATE_CLASS(LOutput)
     std::atomic<bool> callLockACK;
     std::thread::id threadId;
 
+    // True while paintGL() is called holding the render mutex, LScene may release it while drawing
+    bool paintGLLocked = false;
+
+    /* Age of the buffer being rendered, 0 if unknown. Reported by the backend or tracked
+     * from the buffer indices if it doesn't, see LFramebuffer::bufferAge() */
+    Int32 bufferAge = 0;
+    UInt64 bufferFrame = 0;
+    std::vector<UInt64> bufferFrames;
+    void updateBufferAge();
+
+    // Index of the output state in views, see LCompositorPrivate::outputSlots
+    UInt32 slot = 0;
+
     // Painter
     LPainter *painter = nullptr;
 
@@ -3,17 +3,35 @@
 
 #define LPAINTER_TRACK_UNIFORMS 1
 
+// Value of the transform uniform for vertices already in clip space
+#define LPAINTER_TRANSFORM_BATCH 8
+
+// Quads per draw call before the batch is flushed anyway
+#define LPAINTER_BATCH_MAX_QUADS 1024
+
+// Floats per batched quad (2 triangles, XYUV each)
+#define LPAINTER_BATCH_QUAD_FLOATS 24
+
+// First bytes of program binary cache files
+#define LPAINTER_PROGRAM_CACHE_MAGIC "LPB1"
+
 #include <private/LTexturePrivate.h>
 #include <LFramebuffer.h>
 #include <LPainter.h>
 #include <LRect.h>
 #include <GL/gl.h>
 #include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <EGL/egl.h>
+#include <atomic>
+#include <string>
+#include <vector>
 
 using namespace Louvre;
 
 LPRIVATE_CLASS(LPainter)
-    GLuint vertexShader, fragmentShader, fragmentShaderExternal, fragmentShaderScaler, fragmentShaderScalerExternal;
+    GLuint vertexShader = 0;
+    const char *vertexShaderSource = nullptr;
 
     // Square (left for vertex, right for fragment)
     GLfloat square[16] =
@@ -24,22 +42,32 @@ LPRIVATE_CLASS(LPainter)
          1.0f,  1.0f,   1.f, 1.f  // TR
     };
 
+    // Column-major 2x2 matrices applied to the square by the vertex shader, indexed by LFramebuffer::Transform
+    static constexpr GLfloat transformMatrices[9][4] =
+    {
+        { 1.f,  0.f,  0.f,  1.f}, // Normal
+        { 0.f, -1.f,  1.f,  0.f}, // Clock90
+        {-1.f,  0.f,  0.f, -1.f}, // Clock180
+        { 0.f,  1.f, -1.f,  0.f}, // Clock270
+        {-1.f,  0.f,  0.f,  1.f}, // Flipped
+        { 0.f,  1.f,  1.f,  0.f}, // Flipped90
+        { 1.f,  0.f,  0.f, -1.f}, // Flipped180
+        { 0.f, -1.f, -1.f,  0.f}, // Flipped270
+        { 1.f,  0.f,  0.f,  1.f}  // LPAINTER_TRANSFORM_BATCH
+    };
+
     // Uniform variables
     struct Uniforms
     {
-        GLuint
+        GLint
         texSize,
         srcRect,
         activeTexture,
-        mode,
         color,
         colorFactor,
-        colorFactorEnabled,
         alpha,
         transform;
-    } uniforms, uniformsExternal;
-
-    Uniforms *currentUniforms;
+    };
 
     struct UniformsScaler
     {
@@ -79,7 +107,7 @@ LPRIVATE_CLASS(LPainter)
         Int32 w, h;
     };
 
-    union LGLRect
+    struct LGLRect
     {
         Int32 x, y, w, h;
     };
@@ -90,20 +118,65 @@ LPRIVATE_CLASS(LPainter)
         LGLSize texSize;
         LGLRect srcRect;
         GLuint activeTexture;
-        GLint mode;
         LGLColor color;
         LGLVec4F colorFactor;
-        bool colorFactorEnabled = false;
         GLfloat alpha;
         GLint transform;
     };
-
-    ShaderState state, stateExternal;
-    ShaderState *currentState;
 #endif
 
+    /* Fragment shader permutations
+     *
+     * Instead of branching on the mode and color factor for every fragment, a program is
+     * linked for each combination of texture target, mode and color factor, and the right
+     * one is picked before each draw. Solid color programs don't sample, so there is no
+     * external OES variant for them. */
+
+    enum ProgramMode : GLint
+    {
+        ModeTexture = 0,
+        ModeSolidColor = 1,
+        ModeColoredTexture = 2
+    };
+
+    struct Program
+    {
+        GLuint id = 0;
+        Uniforms uniforms;
+
+        // Last painter that used the program, uniform values are shared by all contexts
+        std::atomic<LPainter*> *owner = nullptr;
+
+        #if LPAINTER_TRACK_UNIFORMS == 1
+        ShaderState state;
+        #endif
+    };
+
+    /* Linked programs and uniform locations shared by the painters of a share group
+     * (see acquirePrograms()), indexed like programs */
+    struct ProgramSet
+    {
+        EGLDisplay display = EGL_NO_DISPLAY;
+        UInt32 refs = 0;
+        GLuint ids[2][3][2] = {};
+        Uniforms uniforms[2][3][2];
+        std::atomic<LPainter*> owners[2][3][2];
+        GLuint scaler = 0, scalerExternal = 0;
+        UniformsScaler uniformsScaler, uniformsScalerExternal;
+    };
+
+    ProgramSet *programSet = nullptr;
+
+    // [external][mode][colorFactor]
+    Program programs[2][3][2];
+    Program *current = nullptr;
+
+    // Color factor used to select the next programs
+    LGLVec4F colorFactor = {1.f, 1.f, 1.f, 1.f};
+    bool colorFactorEnabled = false;
+
     // Program
-    GLuint programObject, programObjectExternal, programObjectScaler, programObjectScalerExternal, currentProgram;
+    GLuint programObjectScaler, programObjectScalerExternal, currentProgram = 0;
     LOutput *output = nullptr;
 
     LPainter *painter;
@@ -124,187 +197,204 @@ LPRIVATE_CLASS(LPainter)
     } cpuFormats;
 
     void updateCPUFormats();
-    void setupProgram();
-    void setupProgramScaler();
+    bool acquirePrograms(const char *scalerSource, const char *scalerExternalSource);
+    void releasePrograms();
+    bool createPrograms(const char *scalerSource, const char *scalerExternalSource);
+    void resetProgramState(Program *program);
+    void setupProgramScaler(GLuint program, UniformsScaler *uniforms);
+
+    /* Program binary cache
+     *
+     * Linked programs are stored with GL_OES_get_program_binary in LOUVRE_SHADER_CACHE_DIR
+     * (by default $XDG_CACHE_HOME/Louvre/shaders). Files are named after a hash of the
+     * GL vendor, renderer and version strings and the shader sources. Binaries rejected
+     * by the driver are removed and the program is compiled again. */
+    struct ProgramCache
+    {
+        struct Header
+        {
+            char magic[4];
+            GLenum format;
+            UInt32 size;
+            UInt64 key;
+        };
+
+        bool enabled = false;
+        std::string dir;
+        UInt64 seed;
+        PFNGLGETPROGRAMBINARYOESPROC getProgramBinary = nullptr;
+        PFNGLPROGRAMBINARYOESPROC programBinary = nullptr;
+    } programCache;
+
+    void setupProgramCache();
+    GLuint loadProgramBinary(const char *path, UInt64 key);
+    void saveProgramBinary(GLuint program, const char *path, UInt64 key);
+
+    // Loads the program from the cache or compiles it with the vertex shader
+    GLuint createProgram(const char *fragmentSource);
+    GLuint linkProgram(GLuint fragmentShader);
+
+    // Binds the permutation for the given target and mode
+    inline void useProgram(GLenum target, ProgramMode mode)
+    {
+        Program *program = &programs[target != GL_TEXTURE_2D && mode != ModeSolidColor][mode][colorFactorEnabled];
 
-    // Shader state update
+        if (current != program)
+        {
+            current = program;
+            currentProgram = program->id;
+            glUseProgram(currentProgram);
+        }
+
+        // Uniforms may have been changed by a painter of another context
+        if (program->owner->load(std::memory_order_relaxed) != painter)
+        {
+            program->owner->store(painter, std::memory_order_relaxed);
+            resetProgramState(program);
+        }
+
+        if (!colorFactorEnabled)
+            return;
 
-    inline void shaderSetTransform(GLint transform)
-    {
         #if LPAINTER_TRACK_UNIFORMS == 1
-        if (currentState->transform != transform)
+        if (current->state.colorFactor.x != colorFactor.x ||
+            current->state.colorFactor.y != colorFactor.y ||
+            current->state.colorFactor.w != colorFactor.w ||
+            current->state.colorFactor.h != colorFactor.h)
         {
-            currentState->transform = transform;
-            glUniform1i(currentUniforms->transform, transform);
+            current->state.colorFactor = colorFactor;
+            glUniform4f(current->uniforms.colorFactor, colorFactor.x, colorFactor.y, colorFactor.w, colorFactor.h);
         }
         #else
-        glUniform1i(currentUniforms->transform, transform);
+            glUniform4f(current->uniforms.colorFactor, colorFactor.x, colorFactor.y, colorFactor.w, colorFactor.h);
         #endif
     }
 
-    inline void shaderSetTexSize(Int32 w, Int32 h)
+    // Shader state update
+
+    inline void shaderSetTransform(GLint transform)
     {
         #if LPAINTER_TRACK_UNIFORMS == 1
-        if (currentState->texSize.w != w || currentState->texSize.h != h)
+        if (current->state.transform != transform)
         {
-            currentState->texSize.w = w;
-            currentState->texSize.h = h;
-            glUniform2f(currentUniforms->texSize, w, h);
+            current->state.transform = transform;
+            glUniformMatrix2fv(current->uniforms.transform, 1, GL_FALSE, transformMatrices[transform]);
         }
         #else
-            glUniform2f(currentUniforms->texSize, w, h);
+        glUniformMatrix2fv(current->uniforms.transform, 1, GL_FALSE, transformMatrices[transform]);
         #endif
     }
 
-    inline void shaderSetSrcRect(Int32 x, Int32 y, Int32 w, Int32 h)
+    inline void shaderSetTexSize(Int32 w, Int32 h)
     {
         #if LPAINTER_TRACK_UNIFORMS == 1
-        if (currentState->srcRect.x != x ||
-            currentState->srcRect.y != y ||
-            currentState->srcRect.w != w ||
-            currentState->srcRect.h != h)
+        if (current->state.texSize.w != w || current->state.texSize.h != h)
         {
-            currentState->srcRect.x = x;
-            currentState->srcRect.y = y;
-            currentState->srcRect.w = w;
-            currentState->srcRect.h = h;
-            glUniform4f(currentUniforms->srcRect, x, y, w, h);
+            current->state.texSize.w = w;
+            current->state.texSize.h = h;
+            glUniform2f(current->uniforms.texSize, w, h);
         }
         #else
-            glUniform4f(currentUniforms->srcRect, x, y, w, h);
+            glUniform2f(current->uniforms.texSize, w, h);
         #endif
     }
 
-    inline void shaderSetActiveTexture(GLuint unit)
+    inline void shaderSetSrcRect(Int32 x, Int32 y, Int32 w, Int32 h)
     {
         #if LPAINTER_TRACK_UNIFORMS == 1
-        if (currentState->activeTexture != unit)
+        if (current->state.srcRect.x != x ||
+            current->state.srcRect.y != y ||
+            current->state.srcRect.w != w ||
+            current->state.srcRect.h != h)
         {
-            currentState->activeTexture = unit;
-            glUniform1i(currentUniforms->activeTexture, unit);
+            current->state.srcRect.x = x;
+            current->state.srcRect.y = y;
+            current->state.srcRect.w = w;
+            current->state.srcRect.h = h;
+            glUniform4f(current->uniforms.srcRect, x, y, w, h);
         }
         #else
-            glUniform1i(currentUniforms->activeTexture, unit);
+            glUniform4f(current->uniforms.srcRect, x, y, w, h);
         #endif
     }
 
-    inline void shaderSetMode(GLint mode)
+    inline void shaderSetActiveTexture(GLuint unit)
     {
         #if LPAINTER_TRACK_UNIFORMS == 1
-        if (currentState->mode != mode)
+        if (current->state.activeTexture != unit)
         {
-            currentState->mode = mode;
-            glUniform1i(currentUniforms->mode, mode);
+            current->state.activeTexture = unit;
+            glUniform1i(current->uniforms.activeTexture, unit);
         }
         #else
-            glUniform1i(currentUniforms->mode, mode);
+            glUniform1i(current->uniforms.activeTexture, unit);
         #endif
     }
 
     inline void shaderSetColor(Float32 r, Float32 g, Float32 b)
     {
         #if LPAINTER_TRACK_UNIFORMS == 1
-        if (currentState->color.r != r ||
-            currentState->color.g != g ||
-            currentState->color.b != b)
+        if (current->state.color.r != r ||
+            current->state.color.g != g ||
+            current->state.color.b != b)
         {
-            currentState->color.r = r;
-            currentState->color.g = g;
-            currentState->color.b = b;
-            glUniform3f(currentUniforms->color, r, g, b);
+            current->state.color.r = r;
+            current->state.color.g = g;
+            current->state.color.b = b;
+            glUniform3f(current->uniforms.color, r, g, b);
         }
         #else
-            glUniform3f(currentUniforms->color, r, g, b);
+            glUniform3f(current->uniforms.color, r, g, b);
         #endif
     }
 
+    // Takes effect on the next useProgram() call
     inline void shaderSetColorFactor(Float32 r, Float32 g, Float32 b, Float32 a)
     {
-        #if LPAINTER_TRACK_UNIFORMS == 1
-        if (currentState->colorFactor.x != r ||
-            currentState->colorFactor.y != g ||
-            currentState->colorFactor.w != b ||
-            currentState->colorFactor.h != a)
-        {
-            currentState->colorFactor.x = r;
-            currentState->colorFactor.y = g;
-            currentState->colorFactor.w = b;
-            currentState->colorFactor.h = a;
-            glUniform4f(currentUniforms->colorFactor, r, g, b, a);
-        }
+        const bool enabled = r != 1.f || g != 1.f || b != 1.f || a != 1.f;
 
-        shaderSetColorFactorEnabled(r != 1.f || g != 1.f || b != 1.f || a != 1.f);
-        #else
-            glUniform4f(currentUniforms->colorFactor, r, g, b, a);
-            shaderSetColorFactorEnabled(r != 1.f || g != 1.f || b != 1.f || a != 1.f);
-        #endif
+        if (enabled == colorFactorEnabled &&
+            colorFactor.x == r &&
+            colorFactor.y == g &&
+            colorFactor.w == b &&
+            colorFactor.h == a)
+            return;
+
+        if (!batchVertices.empty())
+            batchFlush();
+
+        colorFactor = {r, g, b, a};
+        colorFactorEnabled = enabled;
     }
 
+    // Takes effect on the next useProgram() call
     inline void shaderSetColorFactorEnabled(bool enabled)
     {
-        #if LPAINTER_TRACK_UNIFORMS == 1
-        if (currentState->colorFactorEnabled != enabled)
-        {
-            currentState->colorFactorEnabled = enabled;
-            glUniform1i(currentUniforms->colorFactorEnabled, enabled);
-        }
-        #else
-            glUniform1i(currentUniforms->colorFactorEnabled, enabled);
-        #endif
+        if (colorFactorEnabled == enabled)
+            return;
+
+        if (!batchVertices.empty())
+            batchFlush();
+
+        colorFactorEnabled = enabled;
     }
 
     inline void shaderSetAlpha(Float32 a)
     {
         #if LPAINTER_TRACK_UNIFORMS == 1
-        if (currentState->alpha != a)
+        if (current->state.alpha != a)
         {
-            currentState->alpha = a;
-            glUniform1f(currentUniforms->alpha, a);
+            current->state.alpha = a;
+            glUniform1f(current->uniforms.alpha, a);
         }
         #else
-            glUniform1f(currentUniforms->alpha, a);
+            glUniform1f(current->uniforms.alpha, a);
         #endif
     }
 
-    inline void switchTarget(GLenum target)
-    {
-        if (lastTarget != target)
-        {
-            if (target == GL_TEXTURE_2D)
-            {
-                currentProgram = programObject;
-                currentUniforms = &uniforms;
-                glUseProgram(currentProgram);
-                #if LPAINTER_TRACK_UNIFORMS == 1
-                currentState = &state;
-                shaderSetColorFactor(stateExternal.colorFactor.x,
-                                     stateExternal.colorFactor.y,
-                                     stateExternal.colorFactor.w,
-                                     stateExternal.colorFactor.h);
-                #endif
-            }
-            else
-            {
-                currentProgram = programObjectExternal;
-                currentUniforms = &uniformsExternal;
-                glUseProgram(currentProgram);
-                #if LPAINTER_TRACK_UNIFORMS == 1
-                currentState = &stateExternal;
-                shaderSetColorFactor(state.colorFactor.x,
-                                     state.colorFactor.y,
-                                     state.colorFactor.w,
-                                     state.colorFactor.h);
-                #endif
-            }
-
-            lastTarget = target;
-        }
-    }
-
-    inline void setViewport(Int32 x, Int32 y, Int32 w, Int32 h)
+    // Maps a rect in compositor coords to a rect in framebuffer pixels
+    inline void fbRectToViewport(Int32 &x, Int32 &y, Int32 &w, Int32 &h)
     {
-        shaderSetTransform(fb->transform());
-
         x -= fb->rect().x();
         y -= fb->rect().y();
 
@@ -400,11 +490,245 @@ LPRIVATE_CLASS(LPainter)
             w *= fbScale;
             h *= fbScale;
         }
+    }
 
+    inline void setViewport(Int32 x, Int32 y, Int32 w, Int32 h)
+    {
+        shaderSetTransform(fb->transform());
+        fbRectToViewport(x, y, w, h);
         glScissor(x, y, w, h);
         glViewport(x, y, w, h);
     }
 
+    /* Batching
+     *
+     * While batching, quads drawn with drawTexture(), drawColorTexture() and drawColor() are not
+     * drawn immediately. Their vertices are transformed to clip space on the CPU (with the texture
+     * coords in the zw components) and appended to batchVertices. Consecutive quads sharing the same
+     * texture and uniforms are then submitted with a single draw call from a streamed vertex buffer,
+     * with the viewport and scissor covering the entire framebuffer.
+     *
+     * Anything that changes the state used by the pending quads must call batchFlush() first,
+     * and raw OpenGL calls must be preceded by batchSuspend().
+     *
+     * While recording (see LScene::handlePaintGL()), flushed batches are appended to frameRecord
+     * instead of being drawn, and are drawn later by recordReplay() without accessing any view,
+     * surface or texture object. Calling batchSuspend() while recording draws what was recorded so
+     * far immediately and stops recording, so custom views keep working. */
+
+    struct BatchState
+    {
+        GLenum target;
+        GLuint texture;
+        ProgramMode mode;
+        GLfloat alpha;
+        LGLColor color;
+    };
+
+    // LOUVRE_PAINTER_BATCHING
+    bool batchingEnabled = true;
+
+    // Set by LSceneView while rendering
+    bool batching = false;
+
+    // Viewport, scissor and vertex buffer bound for batched draws
+    bool batchReady = false;
+
+    GLuint batchVBO = 0;
+    GLsizeiptr batchVBOSize = 0;
+    std::vector<GLfloat> batchVertices;
+    BatchState batchState;
+    Int32 batchViewportW, batchViewportH;
+    GLenum blendS = 0, blendD = 0;
+    bool blendEnabled = true;
+
+    /* Set while rendering view layers (see LViewPrivate::layer), the alpha channel is accumulated
+     * so that the result can be blended with GL_ONE, GL_ONE_MINUS_SRC_ALPHA */
+    bool blendPremultiplied = false;
+
+    void batchBegin();
+    void batchEnd();
+    void batchSetup();
+    void batchSuspend();
+    void batchFlush();
+
+    // Binds the program, uniforms and texture used by the quads of a batch
+    void batchApply(const BatchState &state);
+
+    struct RecordedBatch
+    {
+        BatchState state;
+        LGLVec4F colorFactor;
+        bool colorFactorEnabled;
+        bool blendEnabled;
+        GLenum blendS, blendD;
+
+        // Range of frameRecord.vertices in vertices
+        GLint first;
+        GLsizei count;
+    };
+
+    struct FrameRecord
+    {
+        GLuint fbId = 0;
+        Int32 viewportW = 0, viewportH = 0;
+        std::vector<RecordedBatch> batches;
+        std::vector<GLfloat> vertices;
+
+        // Sampled by the batches, see LCompositorPrivate::beginUnlockedRender()
+        std::vector<const LTexture*> textures;
+    } frameRecord;
+
+    inline void recordTexture(const LTexture *texture)
+    {
+        if (frameRecord.textures.empty() || frameRecord.textures.back() != texture)
+            frameRecord.textures.push_back(texture);
+    }
+
+    // Set by LScene::handlePaintGL(), the next LScene draw pass is recorded
+    bool recordNextFrame = false;
+    bool recording = false;
+
+    void recordBegin();
+    void recordEnd();
+
+    // Draws and clears the recorded batches, can be called without holding the compositor lock
+    void recordReplay();
+
+    inline void setBlendFunc(GLenum sFactor, GLenum dFactor)
+    {
+        if (blendS == sFactor && blendD == dFactor)
+            return;
+
+        if (!batchVertices.empty())
+            batchFlush();
+
+        blendS = sFactor;
+        blendD = dFactor;
+
+        if (recording)
+            return;
+
+        if (blendPremultiplied && sFactor == GL_SRC_ALPHA)
+            glBlendFuncSeparate(sFactor, dFactor, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        else
+            glBlendFunc(sFactor, dFactor);
+    }
+
+    inline void setBlendEnabled(bool enabled)
+    {
+        if (!batchVertices.empty())
+            batchFlush();
+
+        blendEnabled = enabled;
+
+        if (recording)
+            return;
+
+        if (enabled)
+            glEnable(GL_BLEND);
+        else
+            glDisable(GL_BLEND);
+    }
+
+    inline void batchQuad(GLenum target, GLuint texture, ProgramMode mode, GLfloat alpha,
+                          Float32 r, Float32 g, Float32 b,
+                          Int32 srcX, Int32 srcY, Int32 srcW, Int32 srcH,
+                          Int32 texW, Int32 texH,
+                          Int32 dstX, Int32 dstY, Int32 dstW, Int32 dstH)
+    {
+        if (dstW <= 0 || dstH <= 0)
+            return;
+
+        if (!batchVertices.empty())
+        {
+            if (batchState.target != target ||
+                batchState.texture != texture ||
+                batchState.mode != mode ||
+                batchState.alpha != alpha ||
+                (mode != ModeTexture && (batchState.color.r != r || batchState.color.g != g || batchState.color.b != b)) ||
+                batchVertices.size() >= LPAINTER_BATCH_MAX_QUADS * LPAINTER_BATCH_QUAD_FLOATS)
+                batchFlush();
+        }
+
+        if (batchVertices.empty())
+        {
+            if (!batchReady)
+                batchSetup();
+
+            batchState.target = target;
+            batchState.texture = texture;
+            batchState.mode = mode;
+            batchState.alpha = alpha;
+            batchState.color = {r, g, b};
+        }
+
+        // Same rect setViewport() would use, in clip space
+        fbRectToViewport(dstX, dstY, dstW, dstH);
+        const GLfloat x0 = 2.f * dstX / batchViewportW - 1.f;
+        const GLfloat y0 = 2.f * dstY / batchViewportH - 1.f;
+        const GLfloat sx = GLfloat(dstW) / batchViewportW;
+        const GLfloat sy = GLfloat(dstH) / batchViewportH;
+
+        if (fbId != 0)
+        {
+            srcY += srcH;
+            srcH = -srcH;
+        }
+
+        // Corners of the unit square (TL, BL, BR, TR) transformed like the vertex shader does
+        const GLfloat *m = transformMatrices[fb->transform() & 7];
+        const GLfloat c[8] =
+        {
+            -m[0] + m[2], -m[1] + m[3],
+            -m[0] - m[2], -m[1] - m[3],
+             m[0] - m[2],  m[1] - m[3],
+             m[0] + m[2],  m[1] + m[3]
+        };
+
+        GLfloat u0 = 0.f, u1 = 0.f, v0 = 0.f, v1 = 0.f;
+
+        if (mode != ModeSolidColor)
+        {
+            u0 = GLfloat(srcX) / texW;
+            u1 = GLfloat(srcX + srcW) / texW;
+            v0 = GLfloat(srcY + srcH) / texH;
+            v1 = GLfloat(srcY) / texH;
+        }
+
+        const GLfloat quad[16] =
+        {
+            x0 + (c[0] + 1.f) * sx, y0 + (c[1] + 1.f) * sy, u0, v1, // TL
+            x0 + (c[2] + 1.f) * sx, y0 + (c[3] + 1.f) * sy, u0, v0, // BL
+            x0 + (c[4] + 1.f) * sx, y0 + (c[5] + 1.f) * sy, u1, v0, // BR
+            x0 + (c[6] + 1.f) * sx, y0 + (c[7] + 1.f) * sy, u1, v1  // TR
+        };
+
+        // TL, BL, BR + TL, BR, TR
+        batchVertices.insert(batchVertices.end(), quad, quad + 12);
+        batchVertices.insert(batchVertices.end(), quad, quad + 4);
+        batchVertices.insert(batchVertices.end(), quad + 8, quad + 16);
+    }
+
+    inline static void texSizeForScale(const LTexture *texture, Float32 srcScale, Int32 *w, Int32 *h)
+    {
+        if (srcScale == 1.f)
+        {
+            *w = texture->sizeB().w();
+            *h = texture->sizeB().h();
+        }
+        else if (srcScale == 2.f)
+        {
+            *w = texture->sizeB().w() >> 1;
+            *h = texture->sizeB().h() >> 1;
+        }
+        else
+        {
+            *w = texture->sizeB().w()/srcScale;
+            *h = texture->sizeB().h()/srcScale;
+        }
+    }
+
     inline void drawTexture(const LTexture *texture,
                            Int32 srcX,
                            Int32 srcY,
@@ -424,13 +748,27 @@ LPRIVATE_CLASS(LPainter)
             alpha = 0.f;
 
         GLenum target = texture->target();
-        switchTarget(target);
+
+        if (batching)
+        {
+            Int32 texW, texH;
+            texSizeForScale(texture, srcScale, &texW, &texH);
+
+            if (recording)
+                recordTexture(texture);
+
+            batchQuad(target, texture->id(output), ModeTexture, alpha, 0.f, 0.f, 0.f,
+                      srcX, srcY, srcW, srcH, texW, texH,
+                      dstX, dstY, dstW, dstH);
+            return;
+        }
+
+        useProgram(target, ModeTexture);
 
         setViewport(dstX, dstY, dstW, dstH);
         glActiveTexture(GL_TEXTURE0);
 
         shaderSetAlpha(alpha);
-        shaderSetMode(0);
         shaderSetActiveTexture(0);
 
         if (fbId != 0)
@@ -466,14 +804,28 @@ LPRIVATE_CLASS(LPainter)
                                Float32 srcScale, Float32 alpha)
     {
         GLenum target = texture->target();
-        switchTarget(target);
+
+        if (batching)
+        {
+            Int32 texW, texH;
+            texSizeForScale(texture, srcScale, &texW, &texH);
+
+            if (recording)
+                recordTexture(texture);
+
+            batchQuad(target, texture->id(output), ModeColoredTexture, alpha, r, g, b,
+                      srcX, srcY, srcW, srcH, texW, texH,
+                      dstX, dstY, dstW, dstH);
+            return;
+        }
+
+        useProgram(target, ModeColoredTexture);
 
         setViewport(dstX, dstY, dstW, dstH);
         glActiveTexture(GL_TEXTURE0);
 
         shaderSetAlpha(alpha);
         shaderSetColor(r, g, b);
-        shaderSetMode(2);
         shaderSetActiveTexture(0);
 
         if (fbId != 0)
@@ -505,11 +857,18 @@ LPRIVATE_CLASS(LPainter)
     inline void drawColor(Int32 dstX, Int32 dstY, Int32 dstW, Int32 dstH,
                              Float32 r, Float32 g, Float32 b, Float32 a)
     {
-        switchTarget(GL_TEXTURE_2D);
+        if (batching)
+        {
+            batchQuad(GL_TEXTURE_2D, 0, ModeSolidColor, a, r, g, b,
+                      0, 0, 0, 0, 1, 1,
+                      dstX, dstY, dstW, dstH);
+            return;
+        }
+
+        useProgram(GL_TEXTURE_2D, ModeSolidColor);
         setViewport(dstX, dstY, dstW, dstH);
         shaderSetAlpha(a);
         shaderSetColor(r, g, b);
-        shaderSetMode(1);
         glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
     }
 
@@ -517,7 +876,8 @@ LPRIVATE_CLASS(LPainter)
     {
         GLenum target = texture->target();
         GLuint textureId = texture->id(output);
-        switchTarget(target);
+        shaderSetColorFactor(1.f, 1.f, 1.f, 1.f);
+        useProgram(target, ModeTexture);
         glDisable(GL_BLEND);
         glScissor(0,0,64,64);
         glViewport(0,0,64,64);
@@ -527,13 +887,11 @@ LPRIVATE_CLASS(LPainter)
         glViewport(dst.x(),dst.y(),dst.w(),dst.h());
         glActiveTexture(GL_TEXTURE0);
         shaderSetAlpha(1.f);
-        shaderSetMode(0);
         shaderSetActiveTexture(0);
         shaderSetTransform(transform);
         texture->imp()->setTextureParams(textureId, target, GL_REPEAT, GL_REPEAT, GL_LINEAR, GL_LINEAR);
         shaderSetTexSize(texture->sizeB().w(), texture->sizeB().h());
         shaderSetSrcRect(src.x(), src.y(), src.w(), src.h());
-        shaderSetColorFactor(1.f, 1.f, 1.f, 1.f);
         glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
     }
 
@@ -541,17 +899,17 @@ LPRIVATE_CLASS(LPainter)
     {
         GLenum target = texture->target();
         GLuint textureId = texture->id(output);
-        switchTarget(target);
+        shaderSetColorFactor(1.f, 1.f, 1.f, 1.f);
+        useProgram(target, ModeTexture);
         glDisable(GL_BLEND);
         glScissor(0, 0, dst.w(), dst.h());
         glViewport(0, 0, dst.w(), dst.h());
         glActiveTexture(GL_TEXTURE0);
         shaderSetAlpha(1.f);
-        shaderSetMode(0);
         shaderSetActiveTexture(0);
+        shaderSetTransform(LFramebuffer::Normal);
         shaderSetTexSize(texture->sizeB().w(), texture->sizeB().h());
         shaderSetSrcRect(src.x(), src.y() + src.h(), src.w(), -src.h());
-        shaderSetColorFactor(1.f, 1.f, 1.f, 1.f);
         texture->imp()->setTextureParams(textureId, target, GL_REPEAT, GL_REPEAT, GL_LINEAR, GL_LINEAR);
         glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
     }
@@ -559,17 +917,17 @@ LPRIVATE_CLASS(LPainter)
     inline void scaleTexture(GLuint textureId, GLenum textureTarget, GLuint framebufferId, GLint minFilter, const LSize &texSize, const LRect &src, const LSize &dst)
     {
         glBindFramebuffer(GL_FRAMEBUFFER, framebufferId);
-        switchTarget(textureTarget);
+        shaderSetColorFactor(1.f, 1.f, 1.f, 1.f);
+        useProgram(textureTarget, ModeTexture);
         glDisable(GL_BLEND);
         glScissor(0, 0, dst.w(), dst.h());
         glViewport(0, 0, dst.w(), dst.h());
         glActiveTexture(GL_TEXTURE0);
         shaderSetAlpha(1.f);
-        shaderSetMode(0);
         shaderSetActiveTexture(0);
+        shaderSetTransform(LFramebuffer::Normal);
         shaderSetTexSize(texSize.w(), texSize.h());
         shaderSetSrcRect(src.x(), src.y() + src.h(), src.w(), -src.h());
-        shaderSetColorFactor(1.f, 1.f, 1.f, 1.f);
         LTexture::LTexturePrivate::setTextureParams(textureId, textureTarget, GL_REPEAT, GL_REPEAT, minFilter, minFilter);
         glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -577,7 +935,6 @@ LPRIVATE_CLASS(LPainter)
 
     LFramebuffer *fb = nullptr;
     GLuint fbId = 0;
-    GLenum lastTarget = GL_TEXTURE_2D;
 };
 
 #endif // LPAINTERPRIVATE_H
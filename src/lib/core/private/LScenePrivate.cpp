@@ -1,3 +1,4 @@
+#include <private/LCompositorPrivate.h>
 #include <private/LScenePrivate.h>
 #include <private/LViewPrivate.h>
 #include <private/LSceneViewPrivate.h>
@@ -7,64 +8,300 @@
 #include <LSurfaceView.h>
 #include <LFramebuffer.h>
 #include <LLog.h>
+#include <algorithm>
+#include <cmath>
 
 using LVS = LView::LViewPrivate::LViewState;
 
-LView *LScene::LScenePrivate::viewAt(LView *view, const LPoint &pos)
+static inline void intersectBox(LBox &box, const LBox &clip)
 {
-    LView *v = nullptr;
+    if (clip.x1 > box.x1) box.x1 = clip.x1;
+    if (clip.y1 > box.y1) box.y1 = clip.y1;
+    if (clip.x2 < box.x2) box.x2 = clip.x2;
+    if (clip.y2 < box.y2) box.y2 = clip.y2;
+}
 
-    for (std::list<LView*>::const_reverse_iterator it = view->children().crbegin(); it != view->children().crend(); it++)
-    {
-        v = viewAt(*it, pos);
+// Inclusive, as LRect::containsPoint()
+static inline LBox rectBox(const LPoint &pos, const LSize &size)
+{
+    return {pos.x(), pos.y(), pos.x() + size.w(), pos.y() + size.h()};
+}
 
-        if (v)
-            return v;
+static inline Int32 clampCoord(Float64 value)
+{
+    if (value < -1e9)
+        return -1e9;
+
+    if (value > 1e9)
+        return 1e9;
+
+    return value;
+}
+
+// Conservative bounds of the points pointerIsOverView() may accept, ignoring clipping
+static LBox inputBounds(LView *view)
+{
+    if (!view->inputRegion())
+        return rectBox(view->pos(), view->size());
+
+    const LBox &e = view->inputRegion()->extents();
+    const LPoint &pos = view->pos();
+    Float64 sx = 1.0, sy = 1.0;
+
+    if (view->scalingEnabled() || view->parentScalingEnabled())
+    {
+        sx = view->scalingVector().w();
+        sy = view->scalingVector().h();
     }
 
-    if (!view->mapped() || !view->inputEnabled())
-        return nullptr;
+    // Local positions are truncated, so one extra unit is added on each side
+    const Float64 ax = pos.x() + sx * (e.x1 - 1), bx = pos.x() + sx * (e.x2 + 1);
+    const Float64 ay = pos.y() + sy * (e.y1 - 1), by = pos.y() + sy * (e.y2 + 1);
 
-    if (view->clippingEnabled() && !view->clippingRect().containsPoint(pos))
-        return nullptr;
+    return
+    {
+        clampCoord(floor(std::min(ax, bx))),
+        clampCoord(floor(std::min(ay, by))),
+        clampCoord(ceil(std::max(ax, bx))),
+        clampCoord(ceil(std::max(ay, by)))
+    };
+}
 
-    if (pointClippedByParent(view, pos))
-        return nullptr;
+void LScene::LScenePrivate::updateInputGrid()
+{
+    const UInt64 serial = compositor()->imp()->viewInputSerial;
 
-    if (pointClippedByParentScene(view, pos))
-        return nullptr;
+    // The cursor is always within an output, other positions are handled without the grid
+    LBox bounds = {0, 0, -1, -1};
 
-    if ((view->scalingEnabled() || view->parentScalingEnabled()) && view->scalingVector() != LSizeF(1.f,1.f))
+    if (inputGridEnabled && !compositor()->outputs().empty())
     {
-        if (view->scalingVector().area() == 0.f)
-            return nullptr;
+        bounds = rectBox(compositor()->outputs().front()->rect().pos(), compositor()->outputs().front()->rect().size());
 
-        if (view->inputRegion())
-        {
-            if (view->inputRegion()->containsPoint((pos - view->pos())/view->scalingVector()))
-                v = view;
-        }
-        else
+        for (LOutput *o : compositor()->outputs())
         {
-            if (LRect(view->pos(), view->size()).containsPoint((pos - view->pos())/view->scalingVector()))
-                v = view;
+            const LBox b = rectBox(o->rect().pos(), o->rect().size());
+            if (b.x1 < bounds.x1) bounds.x1 = b.x1;
+            if (b.y1 < bounds.y1) bounds.y1 = b.y1;
+            if (b.x2 > bounds.x2) bounds.x2 = b.x2;
+            if (b.y2 > bounds.y2) bounds.y2 = b.y2;
         }
     }
-    else
+
+    if (inputGrid.serial == serial &&
+        inputGrid.bounds.x1 == bounds.x1 && inputGrid.bounds.y1 == bounds.y1 &&
+        inputGrid.bounds.x2 == bounds.x2 && inputGrid.bounds.y2 == bounds.y2)
+        return;
+
+    inputGrid.serial = serial;
+    inputGrid.bounds = bounds;
+    inputGrid.build++;
+    inputGrid.cols = 0;
+    inputGrid.rows = 0;
+
+    for (std::vector<LView*> &cell : inputGrid.cells)
+        cell.clear();
+
+    inputGrid.customViews.clear();
+
+    if (bounds.x2 >= bounds.x1)
     {
-        if (view->inputRegion())
+        inputGrid.cols = (inputGrid.bounds.x2 - inputGrid.bounds.x1) / LSCENE_INPUT_GRID_CELL + 1;
+        inputGrid.rows = (inputGrid.bounds.y2 - inputGrid.bounds.y1) / LSCENE_INPUT_GRID_CELL + 1;
+
+        if (inputGrid.cells.size() < size_t(inputGrid.cols * inputGrid.rows))
+            inputGrid.cells.resize(inputGrid.cols * inputGrid.rows);
+    }
+
+    // Orders are assigned even without grid, they are used to sort pointerOverViews
+    UInt32 order = 0;
+    insertInputGrid(view, inputGrid.bounds, order);
+}
+
+void LScene::LScenePrivate::insertInputGrid(LView *view, const LBox &clip, UInt32 &order)
+{
+    if (!view->children().empty())
+    {
+        LBox childrenClip = clip;
+
+        // Children of nested scenes are clipped to their framebuffer
+        if (view->type() == LView::Scene && !((LSceneView*)view)->isLScene())
+            intersectBox(childrenClip, rectBox(((LSceneView*)view)->imp()->fb->rect().pos(),
+                                               ((LSceneView*)view)->imp()->fb->rect().size()));
+
+        const LBox viewBox = rectBox(view->pos(), view->size());
+        LBox parentClip;
+
+        for (std::list<LView*>::const_reverse_iterator it = view->children().crbegin(); it != view->children().crend(); it++)
         {
-            if (view->inputRegion()->containsPoint(pos - view->pos()))
-                v = view;
+            // The rect of custom views may change without notice
+            if ((*it)->parentClippingEnabled() && view->type() <= LView::Scene)
+            {
+                parentClip = viewBox;
+                intersectBox(parentClip, childrenClip);
+                insertInputGrid(*it, parentClip, order);
+            }
+            else
+                insertInputGrid(*it, childrenClip, order);
         }
+    }
+
+    view->imp()->inputOrder = order++;
+    view->imp()->inputBuild = inputGrid.build;
+
+    if (inputGrid.cols == 0)
+        return;
+
+    if (view->type() > LView::Scene)
+    {
+        inputGrid.customViews.push_back(view);
+        return;
+    }
+
+    if (!view->mapped() || !view->inputEnabled())
+        return;
+
+    LBox box = inputBounds(view);
+
+    if (view->clippingEnabled())
+        intersectBox(box, rectBox(view->clippingRect().pos(), view->clippingRect().size()));
+
+    intersectBox(box, clip);
+
+    if (box.x1 > box.x2 || box.y1 > box.y2)
+        return;
+
+    const Int32 col1 = (box.x1 - inputGrid.bounds.x1) / LSCENE_INPUT_GRID_CELL;
+    const Int32 row1 = (box.y1 - inputGrid.bounds.y1) / LSCENE_INPUT_GRID_CELL;
+    const Int32 col2 = (box.x2 - inputGrid.bounds.x1) / LSCENE_INPUT_GRID_CELL;
+    const Int32 row2 = (box.y2 - inputGrid.bounds.y1) / LSCENE_INPUT_GRID_CELL;
+
+    for (Int32 row = row1; row <= row2; row++)
+        for (Int32 col = col1; col <= col2; col++)
+            inputGrid.cells[row * inputGrid.cols + col].push_back(view);
+}
+
+const std::vector<LView*> *LScene::LScenePrivate::inputGridCell(const LPoint &pos)
+{
+    updateInputGrid();
+
+    if (inputGrid.cols == 0 ||
+        pos.x() < inputGrid.bounds.x1 || pos.x() > inputGrid.bounds.x2 ||
+        pos.y() < inputGrid.bounds.y1 || pos.y() > inputGrid.bounds.y2)
+        return nullptr;
+
+    const std::vector<LView*> &cell = inputGrid.cells[((pos.y() - inputGrid.bounds.y1) / LSCENE_INPUT_GRID_CELL) * inputGrid.cols +
+                                                      (pos.x() - inputGrid.bounds.x1) / LSCENE_INPUT_GRID_CELL];
+
+    if (inputGrid.customViews.empty())
+        return &cell;
+
+    inputGrid.merged.resize(cell.size() + inputGrid.customViews.size());
+    std::merge(cell.cbegin(), cell.cend(), inputGrid.customViews.cbegin(), inputGrid.customViews.cend(), inputGrid.merged.begin(), [](LView *a, LView *b)
+    {
+        return a->imp()->inputOrder < b->imp()->inputOrder;
+    });
+
+    return &inputGrid.merged;
+}
+
+void LScene::LScenePrivate::collectViews(LView *view)
+{
+    for (std::list<LView*>::const_reverse_iterator it = view->children().crbegin(); it != view->children().crend(); it++)
+        collectViews(*it);
+
+    inputCandidates.push_back(view);
+}
+
+void LScene::LScenePrivate::collectInputCandidates(const LPoint &pos)
+{
+    inputCandidates.clear();
+
+    const std::vector<LView*> *cell = inputGridCell(pos);
+
+    if (!cell)
+    {
+        collectViews(view);
+        return;
+    }
+
+    // Views the pointer may be leaving, detached views are skipped as when walking the tree
+    pointerOverCandidates.clear();
+
+    for (LView *v : pointerOverViews)
+        if (v->imp()->inputBuild == inputGrid.build)
+            pointerOverCandidates.push_back(v);
+
+    std::sort(pointerOverCandidates.begin(), pointerOverCandidates.end(), [](LView *a, LView *b)
+    {
+        return a->imp()->inputOrder < b->imp()->inputOrder;
+    });
+
+    std::vector<LView*>::const_iterator a = cell->cbegin();
+    std::vector<LView*>::const_iterator b = pointerOverCandidates.cbegin();
+
+    while (a != cell->cend() || b != pointerOverCandidates.cend())
+    {
+        if (b == pointerOverCandidates.cend() || (a != cell->cend() && (*a)->imp()->inputOrder < (*b)->imp()->inputOrder))
+            inputCandidates.push_back(*a++);
+        else if (a == cell->cend() || (*b)->imp()->inputOrder < (*a)->imp()->inputOrder)
+            inputCandidates.push_back(*b++);
         else
         {
-            if (LRect(view->pos(), view->size()).containsPoint(pos))
-                v = view;
+            inputCandidates.push_back(*a++);
+            b++;
         }
     }
+}
+
+void LScene::LScenePrivate::setPointerIsOver(LView *view, bool isOver)
+{
+    view->imp()->setFlag(LVS::PointerIsOver, isOver);
+
+    if (view->imp()->pointerOverScene)
+    {
+        view->imp()->pointerOverScene->imp()->pointerOverViews.erase(view->imp()->pointerOverLink);
+        view->imp()->pointerOverScene = nullptr;
+    }
+
+    if (isOver)
+    {
+        pointerOverViews.push_back(view);
+        view->imp()->pointerOverLink = std::prev(pointerOverViews.end());
+        view->imp()->pointerOverScene = ((LView*)this->view)->imp()->scene;
+    }
+}
+
+LView *LScene::LScenePrivate::viewAt(const LPoint &pos)
+{
+    const std::vector<LView*> *cell = inputGridCell(pos);
+
+    if (!cell)
+        return viewAt(view, pos);
+
+    for (LView *v : *cell)
+        if (pointerIsOverView(v, pos))
+            return v;
+
+    return nullptr;
+}
+
+LView *LScene::LScenePrivate::viewAt(LView *view, const LPoint &pos)
+{
+    LView *v = nullptr;
+
+    for (std::list<LView*>::const_reverse_iterator it = view->children().crbegin(); it != view->children().crend(); it++)
+    {
+        v = viewAt(*it, pos);
+
+        if (v)
+            return v;
+    }
 
-    return v;
+    if (pointerIsOverView(view, pos))
+        return view;
+
+    return nullptr;
 }
 
 bool LScene::LScenePrivate::pointClippedByParent(LView *view, const LPoint &point)
@@ -123,7 +360,8 @@ bool LScene::LScenePrivate::pointerIsOverView(LView *view, const LPoint &pos)
         }
         else
         {
-            if (LRect(view->pos(), view->size()).containsPoint((pos - view->pos())/view->scalingVector()))
+            // size() is already scaled
+            if (LRect(view->pos(), view->size()).containsPoint(pos))
                 return true;
         }
     }
@@ -144,74 +382,69 @@ bool LScene::LScenePrivate::pointerIsOverView(LView *view, const LPoint &pos)
     return false;
 }
 
-bool LScene::LScenePrivate::handlePointerMove(LView *view, const LPoint &pos, LView **firstViewFound)
+void LScene::LScenePrivate::handlePointerMove(const LPoint &pos, LView **firstViewFound)
 {
-    if (listChanged)
-        goto listChangedErr;
+    // Used instead of a per view flag to avoid walking the tree to clear it
+    pointerMoveSerial++;
 
-    for (std::list<LView*>::const_reverse_iterator it = view->children().crbegin(); it != view->children().crend(); it++)
-        if (!handlePointerMove(*it, pos, firstViewFound))
-            return false;
+    // If a list was modified, start again, serials are used to prevent resend events
+    retry:
+    listChanged = false;
+    pointerIsBlocked = false;
+    *firstViewFound = nullptr;
+
+    /* Only views under the cursor (according to the grid) and views the cursor was
+     * over are visited, the rest would neither receive events nor block the pointer */
+    collectInputCandidates(pos);
+
+    for (LView *v : inputCandidates)
+        if (!dispatchPointerMove(v, pos, firstViewFound))
+            goto retry;
+}
 
+bool LScene::LScenePrivate::dispatchPointerMove(LView *view, const LPoint &pos, LView **firstViewFound)
+{
     if (!pointerIsBlocked && pointerIsOverView(view, pos))
     {
         if (!(*firstViewFound))
             *firstViewFound = view;
 
-        if (!(view->imp()->state & LVS::PointerMoveDone))
+        if (view->imp()->pointerMoveSerial != pointerMoveSerial)
         {
-            view->imp()->state |= LVS::PointerMoveDone;
+            view->imp()->pointerMoveSerial = pointerMoveSerial;
 
             if (view->pointerIsOver())
-            {
                 view->pointerMoveEvent(viewLocalPos(view, pos));
-
-                if (listChanged)
-                    goto listChangedErr;
-            }
             else
             {
-                view->imp()->addFlag(LVS::PointerIsOver);
+                setPointerIsOver(view, true);
                 view->pointerEnterEvent(viewLocalPos(view, pos));
-
-                if (listChanged)
-                    goto listChangedErr;
             }
+
+            if (listChanged)
+                return false;
         }
 
         if (view->blockPointerEnabled())
             pointerIsBlocked = true;
     }
-    else
+    else if (view->imp()->pointerMoveSerial != pointerMoveSerial)
     {
-        if (!(view->imp()->state & LVS::PointerMoveDone))
-        {
-            view->imp()->state |= LVS::PointerMoveDone;
+        view->imp()->pointerMoveSerial = pointerMoveSerial;
 
-            if (view->pointerIsOver())
-            {
-                view->imp()->removeFlag(LVS::PointerIsOver);
-                view->pointerLeaveEvent();
+        if (view->pointerIsOver())
+        {
+            setPointerIsOver(view, false);
+            view->pointerLeaveEvent();
 
-                if (listChanged)
-                    goto listChangedErr;
-            }
+            if (listChanged)
+                return false;
         }
     }
 
-    // Hides unused warning
-    (void)firstViewFound;
-
     return true;
-
-    // If a list was modified, start again, serials are used to prevent resend events
-    listChangedErr:
-    listChanged = false;
-    handlePointerMove(this->view, pos, nullptr);
-    return false;
 }
 
-
 LPoint LScene::LScenePrivate::viewLocalPos(LView *view, const LPoint &pos)
 {
     if ((view->scalingEnabled() || view->parentScalingEnabled()) && view->scalingVector().area() != 0.f)
@@ -2,12 +2,16 @@
 #define LSCENEPRIVATE_H
 
 #include <LScene.h>
-#include <mutex>
+#include <LRect.h>
+#include <vector>
+#include <list>
+
+// Size of the hit-testing grid cells in surface coords
+#define LSCENE_INPUT_GRID_CELL 128
 
 using namespace Louvre;
 
 LPRIVATE_CLASS(LScene)
-    std::mutex mutex;
     LSceneView *view;
     bool handleWaylandPointerEvents = true;
     bool handleWaylandKeyboardEvents = true;
@@ -23,12 +27,51 @@ LPRIVATE_CLASS(LScene)
     bool handlingKeyModifiersEvent = false;
     bool handlingKeyEvent = false;
 
+    /* Uniform grid over the union of all outputs. Each cell lists the mapped and
+     * input-enabled views whose clipped input bounds intersect it, sorted from top
+     * to bottom. It is rebuilt when LCompositorPrivate::viewInputSerial changes */
+    struct InputGrid
+    {
+        UInt64 serial = 0;
+        UInt32 build = 0;
+        LBox bounds = {0, 0, -1, -1};
+        Int32 cols = 0;
+        Int32 rows = 0;
+        std::vector<std::vector<LView*>> cells;
+
+        /* Custom views (type() > LView::Scene) may change their rect, input region or
+         * mapping without notice, so they are tested for any cell, sorted from top to bottom */
+        std::vector<LView*> customViews;
+
+        // A cell merged with customViews, see inputGridCell()
+        std::vector<LView*> merged;
+    };
+    InputGrid inputGrid;
+    bool inputGridEnabled = true;
+
+    // Views with pointerIsOver() == true, so that leave events don't require walking the tree
+    std::list<LView*> pointerOverViews;
+    UInt32 pointerMoveSerial = 0;
+
+    // Views visited by the current pointer move event, from top to bottom
+    std::vector<LView*> inputCandidates;
+    std::vector<LView*> pointerOverCandidates;
+
+    void updateInputGrid();
+    void insertInputGrid(LView *view, const LBox &clip, UInt32 &order);
+    const std::vector<LView*> *inputGridCell(const LPoint &pos);
+    void collectViews(LView *view);
+    void collectInputCandidates(const LPoint &pos);
+    void setPointerIsOver(LView *view, bool isOver);
+
     bool pointClippedByParent(LView *parent, const LPoint &point);
     bool pointClippedByParentScene(LView *view, const LPoint &point);
+    LView *viewAt(const LPoint &pos);
     LView *viewAt(LView *view, const LPoint &pos);
     LPoint viewLocalPos(LView *view, const LPoint &pos);
     bool pointerIsOverView(LView *view, const LPoint &pos);
-    bool handlePointerMove(LView *view, const LPoint &pos, LView **firstViewFound);
+    void handlePointerMove(const LPoint &pos, LView **firstViewFound);
+    bool dispatchPointerMove(LView *view, const LPoint &pos, LView **firstViewFound);
     bool handlePointerButton(LView *view, LPointer::Button button, LPointer::ButtonState state);
     bool handlePointerAxisEvent(LView *view, Float64 axisX, Float64 axisY, Int32 discreteX, Int32 discreteY, UInt32 source);
     bool handleKeyModifiersEvent(LView *view, UInt32 depressed, UInt32 latched, UInt32 locked, UInt32 group);
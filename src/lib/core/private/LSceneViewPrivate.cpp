@@ -1,41 +1,298 @@
 #include <private/LSceneViewPrivate.h>
 #include <private/LViewPrivate.h>
 #include <private/LPainterPrivate.h>
+#include <private/LSurfacePrivate.h>
 #include <LOutput.h>
 #include <LCompositor.h>
 #include <LSurfaceView.h>
 #include <LLog.h>
 #include <LFramebuffer.h>
+#include <LRenderBuffer.h>
+#include <LTime.h>
+#include <cmath>
 
 using LVS = LView::LViewPrivate::LViewState;
 
-void LSceneView::LSceneViewPrivate::calcNewDamage(LView *view)
+/* Rect containing the renderable mapped views of a subtree. Returns false if it contains
+ * views a layer can not reproduce (scene views, custom views or custom blend functions) */
+static bool layerBounds(LView *view, LRect *bounds, UInt32 *renderables)
 {
-    ThreadData *oD = currentThreadData;
+    if (!view->mapped())
+        return true;
 
-    // Children first
-    if (view->type() == Scene)
+    if (view->type() >= LView::Scene ||
+        view->imp()->sFactor != GL_SRC_ALPHA ||
+        view->imp()->dFactor != GL_ONE_MINUS_SRC_ALPHA)
+        return false;
+
+    if (view->isRenderable() && view->size().area() > 0)
     {
-        LSceneView *sceneView = (LSceneView*)view;
-        if (view->imp()->cache.scalingEnabled)
-            sceneView->render(nullptr);
+        const LRect rect(view->pos(), view->size());
+
+        if (*renderables == 0)
+            *bounds = rect;
         else
-            sceneView->render(&oD->opaqueTransposedSum);
+        {
+            const Int32 x1 = std::min(bounds->x(), rect.x());
+            const Int32 y1 = std::min(bounds->y(), rect.y());
+            const Int32 x2 = std::max(bounds->x() + bounds->w(), rect.x() + rect.w());
+            const Int32 y2 = std::max(bounds->y() + bounds->h(), rect.y() + rect.h());
+            *bounds = LRect(x1, y1, x2 - x1, y2 - y1);
+        }
+
+        (*renderables)++;
     }
-    else
+
+    for (LView *child : view->children())
+        if (!layerBounds(child, bounds, renderables))
+            return false;
+
+    return true;
+}
+
+// Layers use the highest scale so that they look sharp on all outputs
+static void updateLayerGeometry(LSceneView *layer, const LRect &bounds)
+{
+    Int32 scale = 1;
+
+    for (LOutput *output : LCompositor::compositor()->outputs())
+        scale = std::max(scale, output->scale());
+
+    LRenderBuffer *rb = (LRenderBuffer*)layer->imp()->fb;
+    rb->setScale(scale);
+    rb->setSizeB(bounds.size() * scale);
+
+    if (layer->imp()->customPos != bounds.pos())
     {
-        for (std::list<LView*>::const_reverse_iterator it = view->children().crbegin(); it != view->children().crend(); it++)
-            calcNewDamage(*it);
+        layer->imp()->customPos = bounds.pos();
+
+        // Layers are not part of any scene, so the input geometry is not affected
+        LView::LViewPrivate::invalidateWorldChildren(layer, LView::LViewPrivate::WorldPos);
     }
+}
 
-    // Quick view cache handle to reduce verbosity
-    LView::LViewPrivate::ViewCache *cache = &view->imp()->cache;
+/* Maps a region in local coords of a scaled view to compositor coords. Rects are rounded outward
+ * and expanded by 1 pixel, since linear filtering also spreads texels to their neighbour pixels */
+static void scaleRegion(LRegion *region, const LPoint &pos, const LSizeF &scalingVector)
+{
+    Int32 n;
+    const LBox *boxes = region->boxes(&n);
+    LRegion scaled;
+
+    for (Int32 i = 0; i < n; i++)
+    {
+        const Int32 x1 = pos.x() + floorf(boxes[i].x1 * scalingVector.x()) - 1;
+        const Int32 y1 = pos.y() + floorf(boxes[i].y1 * scalingVector.y()) - 1;
+        const Int32 x2 = pos.x() + ceilf(boxes[i].x2 * scalingVector.x()) + 1;
+        const Int32 y2 = pos.y() + ceilf(boxes[i].y2 * scalingVector.y()) + 1;
+        scaled.addRect(x1, y1, x2 - x1, y2 - y1);
+    }
+
+    *region = scaled;
+}
+
+// Union of non empty boxes
+static inline void addBounds(LBox &bounds, const LBox &box)
+{
+    if (box.x1 >= box.x2 || box.y1 >= box.y2)
+        return;
+
+    if (bounds.x1 >= bounds.x2 || bounds.y1 >= bounds.y2)
+    {
+        bounds = box;
+        return;
+    }
+
+    bounds.x1 = std::min(bounds.x1, box.x1);
+    bounds.y1 = std::min(bounds.y1, box.y1);
+    bounds.x2 = std::max(bounds.x2, box.x2);
+    bounds.y2 = std::max(bounds.y2, box.y2);
+}
+
+void LSceneView::LSceneViewPrivate::calcNewDamage(OutputData *oD, LView *view, bool parentChanged)
+{
+    LView::LViewPrivate::ViewOutputData *voD = &view->imp()->outputData(oD->slot);
+    voD->subtreeSkipped = false;
+
+    // Views are rendered directly into their own layer
+    if (view->imp()->hasFlag(LVS::Caching) && (!view->imp()->layer || view->imp()->layer->imp() != this))
+    {
+        calcCachedDamage(oD, view, parentChanged);
+        voD->subtreeClean = false;
+        return;
+    }
+
+    // The fast path of calcViewDamage() is as cheap as skipping a single view
+    if (view->children().empty() || view->type() >= Scene)
+    {
+        voD->subtreeClean = calcViewDamage(oD, view, parentChanged);
+        return;
+    }
+
+    if (!parentChanged && skipSubtree(oD, view))
+        return;
+
+    const bool coarsening = oD->c->imp()->damageMaxBoxes != 0;
+    const LBox outerBounds = oD->subtreeBounds;
+    oD->subtreeBounds = {0, 0, 0, 0};
+    voD->subtreeSerial = view->imp()->subtreeSerial;
+    voD->subtreeFb = oD->fb;
+    voD->subtreeCoarsening = coarsening;
+    voD->entryOpaque = oD->opaqueTransposedSum;
 
-    view->imp()->removeFlag(LVS::RepaintCalled);
+    if (coarsening)
+        voD->entryTranslucent = oD->translucentOverlaySum;
 
+    voD->subtreeClean = calcViewDamage(oD, view, parentChanged);
+
+    if (voD->subtreeClean)
+    {
+        voD->exitOpaque = oD->opaqueTransposedSum;
+
+        if (coarsening)
+            voD->exitTranslucent = oD->translucentOverlaySum;
+
+        voD->exitCovered = oD->covered;
+    }
+
+    voD->subtreeBounds = oD->subtreeBounds;
+    oD->subtreeBounds = outerBounds;
+    addBounds(oD->subtreeBounds, voD->subtreeBounds);
+}
+
+bool LSceneView::LSceneViewPrivate::skipSubtree(OutputData *oD, LView *view)
+{
+    LView::LViewPrivate::ViewOutputData *voD = &view->imp()->outputData(oD->slot);
+    const bool coarsening = oD->c->imp()->damageMaxBoxes != 0;
+
+    if (!voD->subtreeClean ||
+        oD->covered ||
+        voD->subtreeSerial != view->imp()->subtreeSerial ||
+        voD->subtreeFb != oD->fb ||
+        voD->subtreeCoarsening != coarsening ||
+        voD->outputLayoutSerial != compositor()->imp()->outputLayoutSerial ||
+        !pixman_region32_equal(&voD->entryOpaque.m_region, &oD->opaqueTransposedSum.m_region) ||
+        (coarsening && !pixman_region32_equal(&voD->entryTranslucent.m_region, &oD->translucentOverlaySum.m_region)))
+        return false;
+
+    oD->opaqueTransposedSum = voD->exitOpaque;
+
+    if (coarsening)
+        oD->translucentOverlaySum = voD->exitTranslucent;
+
+    oD->covered = voD->exitCovered;
+    addBounds(oD->subtreeBounds, voD->subtreeBounds);
+    voD->subtreeSkipped = true;
+    return true;
+}
+
+bool LSceneView::LSceneViewPrivate::restoreSubtree(OutputData *oD, LView *view)
+{
+    const LBox &bounds = view->imp()->outputData(oD->slot).subtreeBounds;
+
+    if (bounds.x1 >= bounds.x2 || bounds.y1 >= bounds.y2)
+        return false;
+
+    const pixman_box32_t box { bounds.x1, bounds.y1, bounds.x2, bounds.y2 };
+
+    if (pixman_region32_contains_rectangle(&oD->newDamage.m_region, &box) == PIXMAN_REGION_OUT)
+        return false;
+
+    restoreViewCaches(oD, view);
+    return true;
+}
+
+void LSceneView::LSceneViewPrivate::restoreViewCaches(OutputData *oD, LView *view)
+{
+    LView::LViewPrivate::ViewOutputData *voD = &view->imp()->outputData(oD->slot);
+    voD->subtreeSkipped = false;
+
+    for (LView *child : view->children())
+        restoreViewCaches(oD, child);
+
+    LView::LViewPrivate::ViewCache *cache = &voD->cache;
+
+    if (!view->isRenderable() || !cache->mapped)
+        return;
+
+    // Same as the fast path of calcViewDamage(), the views above did not change
+    cache->damage.clear();
+    cache->opaque = voD->opaque;
+    cache->translucent = voD->translucent;
+
+    LRegion visibleClipping = voD->prevClipping;
+    visibleClipping.subtractRegion(cache->opaqueOverlay);
+    cache->occluded = visibleClipping.empty();
+}
+
+/* Views with caching enabled are rendered directly until they and their children did not change
+ * for LCompositorPrivate::layerFrames frames. Then they are rendered into a layer, which is drawn
+ * instead until something changes again */
+void LSceneView::LSceneViewPrivate::calcCachedDamage(OutputData *oD, LView *view, bool parentChanged)
+{
+    LView::LViewPrivate *imp = view->imp();
+    LView::LViewPrivate::ViewOutputData *voD = &imp->outputData(oD->slot);
+    LRect bounds;
+    UInt32 renderables = 0;
+
+    voD->layered = false;
+
+    if (imp->layer && (imp->layerInvalid || oD->covered || !layerBounds(view, &bounds, &renderables) || renderables < 2))
+        imp->releaseLayer(view);
+
+    if (!imp->layer)
+    {
+        const bool prevChanged = oD->changed;
+        oD->changed = false;
+        calcViewDamage(oD, view, parentChanged);
+
+        if (oD->changed || oD->covered)
+            imp->layerStaticFrames = 0;
+        else if (++imp->layerStaticFrames >= compositor()->imp()->layerFrames)
+        {
+            // Checked again after layerFrames frames if the subtree can't be cached
+            imp->layerStaticFrames = 0;
+            renderables = 0;
+
+            if (layerBounds(view, &bounds, &renderables) && renderables >= 2)
+            {
+                // Used from the next frame
+                imp->layer = new LSceneView((LFramebuffer*)compositor()->imp()->acquireLayerBuffer(bounds.size() * oD->o->scale()), nullptr);
+                imp->layer->imp()->layerRoots.push_back(view);
+                imp->layer->setBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+                updateLayerGeometry(imp->layer, bounds);
+            }
+        }
+
+        oD->changed = oD->changed || prevChanged;
+        return;
+    }
+
+    updateLayerGeometry(imp->layer, bounds);
+
+    const bool initialized = imp->layer->imp()->outputData(oD->slot).p != nullptr;
+    voD->layered = true;
+    calcViewDamage(oD, imp->layer, parentChanged);
+
+    // The layer is still drawn in this frame, the views are drawn directly in the next ones
+    if (initialized && !imp->layer->imp()->outputData(oD->slot).newDamage.empty())
+    {
+        imp->layerInvalid = true;
+        oD->changed = true;
+    }
+}
+
+bool LSceneView::LSceneViewPrivate::calcViewDamage(OutputData *oD, LView *view, bool parentChanged)
+{
     // Quick output data handle
-    cache->voD = &view->imp()->threadsMap[std::this_thread::get_id()];
-    cache->voD->o = oD->o;
+    LView::LViewPrivate::ViewOutputData *voD = &view->imp()->outputData(oD->slot);
+    voD->o = oD->o;
+
+    // Quick view cache handle to reduce verbosity
+    LView::LViewPrivate::ViewCache *cache = &voD->cache;
+    cache->voD = voD;
+
+    voD->repaintCalled = false;
 
     // Cache mapped call
     cache->mapped = view->mapped();
@@ -47,29 +304,105 @@ void LSceneView::LSceneViewPrivate::calcNewDamage(LView *view)
     cache->scalingVector = view->scalingVector();
     cache->scalingEnabled = (view->scalingEnabled() || view->parentScalingEnabled()) && cache->scalingVector != LSizeF(1.f, 1.f);
 
-    LRegion vRegion;
-    vRegion.addRect(cache->rect);
+    /* The clipping and intersected outputs of a view only depend on its rect, its
+     * clipping settings (which call repaint()), the rects of its parents and the outputs layout.
+     * Custom views are always recalculated */
+    const bool geometryChanged = parentChanged ||
+                                 view->type() > Scene ||
+                                 cache->voD->changeSerial != view->imp()->changeSerial ||
+                                 cache->voD->outputsRect != cache->rect;
 
-    if (view->clippingEnabled())
-        vRegion.clip(view->clippingRect());
+    // Whether the children can be skipped by their parent in the next frames
+    bool childrenClean = true;
 
-    if (view->parent() && view->parentClippingEnabled())
-        vRegion.clip(view->parent()->pos(), view->parent()->size());
+    // Children first
+    if (view->type() == Scene)
+    {
+        LSceneView *sceneView = (LSceneView*)view;
+        childrenClean = false;
+
+        /* A covered scene view is not rendered, its children are only visited for their outputs.
+         * Its framebuffer content becomes stale so it is fully damaged for the next time it is visible */
+        if (oD->covered)
+        {
+            sceneView->damageAll(oD->o);
+
+            for (std::list<LView*>::const_reverse_iterator it = view->children().crbegin(); it != view->children().crend(); it++)
+                calcNewDamage(oD, *it, geometryChanged);
+        }
+        else
+        {
+            sceneView->imp()->outputData(oD->slot).parentChanged = geometryChanged;
+
+            // Layers must contain the occluded parts too, they are reused while the views above change
+            if (cache->scalingEnabled || !sceneView->imp()->layerRoots.empty())
+                sceneView->render(nullptr);
+            else
+                sceneView->render(&oD->opaqueTransposedSum);
+        }
+    }
+    else
+    {
+        // Mapping the parent maps the children without calling their repaint()
+        const bool childrenChanged = geometryChanged || cache->mapped != cache->voD->prevMapped;
+
+        for (std::list<LView*>::const_reverse_iterator it = view->children().crbegin(); it != view->children().crend(); it++)
+        {
+            calcNewDamage(oD, *it, childrenChanged);
+            childrenClean = childrenClean && (*it)->imp()->outputData(oD->slot).subtreeClean;
+        }
+    }
+
+    // Scene views recalculate their regions on each render
+    const bool regionsValid = cache->voD->regionsValid && !geometryChanged && view->type() != Scene;
+    cache->voD->regionsValid = false;
+    cache->voD->changeSerial = view->imp()->changeSerial;
+    cache->voD->outputsRect = cache->rect;
 
     // Update view intersected outputs
-    for (std::list<LOutput*>::const_iterator it = compositor()->outputs().cbegin(); it != compositor()->outputs().cend(); it++)
+    if (geometryChanged || cache->voD->outputLayoutSerial != compositor()->imp()->outputLayoutSerial)
     {
-        LRegion r = vRegion;
-        r.clip((*it)->rect());
+        cache->voD->outputLayoutSerial = compositor()->imp()->outputLayoutSerial;
 
-        if (!r.empty())
-            view->enteredOutput(*it);
-        else
-           view->leftOutput(*it);
+        LRegion vRegion;
+        vRegion.addRect(cache->rect);
+
+        if (view->clippingEnabled())
+            vRegion.clip(view->clippingRect());
+
+        if (view->parent() && view->parentClippingEnabled())
+            vRegion.clip(view->parent()->pos(), view->parent()->size());
+
+        for (std::list<LOutput*>::const_iterator it = compositor()->outputs().cbegin(); it != compositor()->outputs().cend(); it++)
+        {
+            LRegion r = vRegion;
+            r.clip((*it)->rect());
+
+            if (!r.empty())
+                view->enteredOutput(*it);
+            else
+               view->leftOutput(*it);
+        }
     }
 
     if (!view->isRenderable())
-        return;
+        return childrenClean && !geometryChanged;
+
+    /* Views above already cover the entire framebuffer, skip the region calculations.
+     * The damage state of the view is left untouched, so it will be recalculated once
+     * it is visible again, and the views above that stop covering it add the exposed damage */
+    if (oD->covered)
+    {
+        cache->occluded = true;
+        cache->voD->regionsValid = false;
+
+        if (cache->mapped)
+            requestNextFrame(oD, view);
+        else if (oD->o && view->forceRequestNextFrameEnabled())
+            view->requestNextFrame(oD->o);
+
+        return false;
+    }
 
     cache->opacity = view->opacity();
 
@@ -82,15 +415,21 @@ void LSceneView::LSceneViewPrivate::calcNewDamage(LView *view)
     {
         if (view->forceRequestNextFrameEnabled())
             view->requestNextFrame(oD->o);
-        return;
+        return childrenClean && !geometryChanged && !view->forceRequestNextFrameEnabled();
     }
 
     bool opacityChanged = cache->opacity != cache->voD->prevOpacity;
 
-    cache->localRect = LRect(cache->rect.pos() - fb->rect().pos(), cache->rect.size());
+    cache->localRect = LRect(cache->rect.pos() - oD->fb->rect().pos(), cache->rect.size());
 
     bool rectChanged = cache->localRect != cache->voD->prevLocalRect;
 
+    const LSizeF scalingVector = cache->scalingEnabled ? cache->scalingVector : LSizeF(1.f, 1.f);
+    const bool scalingChanged = scalingVector != cache->voD->prevScalingVector;
+
+    // Scaled scene views are always fully damaged and translucent
+    const bool sceneScaled = cache->scalingEnabled && view->type() == Scene;
+
     bool colorFactorChanged = cache->voD->prevColorFactorEnabled != view->imp()->hasFlag(LVS::ColorFactor);
 
     if (!colorFactorChanged && view->imp()->hasFlag(LVS::ColorFactor))
@@ -101,8 +440,43 @@ void LSceneView::LSceneViewPrivate::calcNewDamage(LView *view)
                               cache->voD->prevColorFactor.a != view->imp()->colorFactor.a;
     }
 
+    // Nothing changed since the view was drawn on this output, only its occlusion needs to be updated
+    if (regionsValid &&
+        !mappingChanged &&
+        !rectChanged &&
+        !opacityChanged &&
+        !colorFactorChanged &&
+        !scalingChanged &&
+        !cache->voD->changedOrder &&
+        (!view->damage() || view->damage()->empty()) &&
+        (view->type() != Surface || cache->voD->surfaceCommitSerial == ((LSurfaceView*)view)->surface()->imp()->commitSerial))
+    {
+        cache->voD->regionsValid = true;
+        cache->damage.clear();
+        cache->opaque = cache->voD->opaque;
+        cache->translucent = cache->voD->translucent;
+
+        LRegion visibleClipping = cache->voD->prevClipping;
+        visibleClipping.subtractRegion(oD->opaqueTransposedSum);
+        cache->occluded = visibleClipping.empty();
+
+        requestNextFrame(oD, view);
+        requestTexture(oD, view);
+        addOverlays(oD, view);
+
+        // Views waiting for frames or drawn into a layer are visited on each frame
+        return childrenClean &&
+               !view->forceRequestNextFrameEnabled() &&
+               !view->imp()->hasFlag(LVS::Caching) &&
+               view->type() < Scene &&
+               !cache->voD->layered &&
+               (view->type() != Surface || ((LSurfaceView*)view)->surface()->imp()->frameCallbacks.empty());
+    }
+
+    oD->changed = true;
+
     // If rect or order changed (set current rect and prev rect as damage)
-    if (mappingChanged || rectChanged || cache->voD->changedOrder || opacityChanged || cache->scalingEnabled || colorFactorChanged)
+    if (mappingChanged || rectChanged || cache->voD->changedOrder || opacityChanged || scalingChanged || sceneScaled || colorFactorChanged)
     {
         cache->damage.addRect(cache->rect);
 
@@ -121,6 +495,9 @@ void LSceneView::LSceneViewPrivate::calcNewDamage(LView *view)
         if (opacityChanged)
             cache->voD->prevOpacity = cache->opacity;
 
+        if (scalingChanged)
+            cache->voD->prevScalingVector = scalingVector;
+
         if (colorFactorChanged)
         {
             cache->voD->prevColorFactorEnabled = view->imp()->hasFlag(LVS::ColorFactor);
@@ -130,7 +507,7 @@ void LSceneView::LSceneViewPrivate::calcNewDamage(LView *view)
         if (!cache->mapped)
         {
             oD->newDamage.addRegion(cache->voD->prevClipping);
-            return;
+            return false;
         }
     }
     else if (view->damage())
@@ -138,7 +515,9 @@ void LSceneView::LSceneViewPrivate::calcNewDamage(LView *view)
         cache->damage = *view->damage();
 
         // Scene views already have their damage transposed
-        if (view->type() != Scene)
+        if (cache->scalingEnabled)
+            scaleRegion(&cache->damage, cache->rect.pos(), cache->scalingVector);
+        else if (view->type() != Scene)
             cache->damage.offset(cache->rect.pos());
     }
     else
@@ -178,7 +557,7 @@ void LSceneView::LSceneViewPrivate::calcNewDamage(LView *view)
     // Add clipped damage to new damage
     oD->newDamage.addRegion(cache->damage);
 
-    if (cache->opacity < 1.f || cache->scalingEnabled || view->colorFactor().a < 1.f)
+    if (cache->opacity < 1.f || sceneScaled || view->colorFactor().a < 1.f)
     {
         cache->translucent.clear();
         cache->translucent.addRect(cache->rect);
@@ -191,7 +570,12 @@ void LSceneView::LSceneViewPrivate::calcNewDamage(LView *view)
         {
             cache->translucent = *view->translucentRegion();
 
-            if (view->type() != Scene)
+            if (cache->scalingEnabled)
+            {
+                scaleRegion(&cache->translucent, cache->rect.pos(), cache->scalingVector);
+                cache->translucent.clip(cache->rect);
+            }
+            else if (view->type() != Scene)
                 cache->translucent.offset(cache->rect.pos());
         }
         else
@@ -201,7 +585,17 @@ void LSceneView::LSceneViewPrivate::calcNewDamage(LView *view)
         }
 
         // Store tansposed opaque region
-        if (view->opaqueRegion())
+        if (view->opaqueRegion() && cache->scalingEnabled)
+        {
+            /* Scaled outward the non opaque region, so that the opaque one shrinks instead
+             * and pixels sampling translucent texels are not drawn without blending */
+            cache->opaque.clear();
+            cache->opaque.addRect(LRect(LPoint(), view->nativeSize()));
+            cache->opaque.subtractRegion(*view->opaqueRegion());
+            scaleRegion(&cache->opaque, cache->rect.pos(), cache->scalingVector);
+            cache->opaque.inverse(cache->rect);
+        }
+        else if (view->opaqueRegion())
         {
             cache->opaque = *view->opaqueRegion();
 
@@ -219,29 +613,101 @@ void LSceneView::LSceneViewPrivate::calcNewDamage(LView *view)
     cache->opaque.intersectRegion(currentClipping);
     cache->translucent.intersectRegion(currentClipping);
 
+    // Saved for the next frames, drawOpaqueDamage() and drawTranslucentDamage() modify them
+    cache->voD->opaque = cache->opaque;
+    cache->voD->translucent = cache->translucent;
+    cache->voD->regionsValid = true;
+
+    if (view->type() == Surface)
+        cache->voD->surfaceCommitSerial = ((LSurfaceView*)view)->surface()->imp()->commitSerial;
+
     // Check if view is ocludded
     currentClipping.subtractRegion(oD->opaqueTransposedSum);
 
     cache->occluded = currentClipping.empty();
 
-    if (oD->o && (!cache->occluded || view->forceRequestNextFrameEnabled()))
-        view->requestNextFrame(oD->o);
+    requestNextFrame(oD, view);
+    requestTexture(oD, view);
 
     // Store sum of previus opaque regions (this will later be clipped when painting opaque and translucent regions)
+    addOverlays(oD, view);
+    return false;
+}
+
+void LSceneView::LSceneViewPrivate::requestNextFrame(OutputData *oD, LView *view)
+{
+    LView::LViewPrivate::ViewCache *cache = &view->imp()->outputData(oD->slot).cache;
+
+    if (!oD->o)
+        return;
+
+    if (!cache->occluded || view->forceRequestNextFrameEnabled())
+    {
+        cache->voD->lastFrameRequestMs = oD->frameMs;
+        view->requestNextFrame(oD->o);
+        return;
+    }
+
+    // Occluded views get throttled frame callbacks if LOUVRE_OCCLUDED_FRAME_INTERVAL is set
+    const UInt32 interval = compositor()->imp()->occludedFrameInterval;
+
+    if (interval && oD->frameMs - cache->voD->lastFrameRequestMs >= interval)
+    {
+        cache->voD->lastFrameRequestMs = oD->frameMs;
+        view->requestNextFrame(oD->o);
+    }
+}
+
+void LSceneView::LSceneViewPrivate::requestTexture(OutputData *oD, LView *view)
+{
+    if (view->type() != Surface || view->imp()->outputData(oD->slot).cache.occluded)
+        return;
+
+    LSurface::LSurfacePrivate *surface = ((LSurfaceView*)view)->surface()->imp();
+
+    // Uploaded directly while the surface keeps being drawn
+    surface->textureRequested = true;
+
+    // Its damage was published when committed, so the new content is drawn in this frame
+    if (surface->deferredUpload.buffer)
+        surface->flushDeferredUpload(true);
+}
+
+void LSceneView::LSceneViewPrivate::addOverlays(OutputData *oD, LView *view)
+{
+    LView::LViewPrivate::ViewCache *cache = &view->imp()->outputData(oD->slot).cache;
+
     cache->opaqueOverlay = oD->opaqueTransposedSum;
     oD->opaqueTransposedSum.addRegion(cache->opaque);
+
+    if (oD->c->imp()->damageMaxBoxes != 0)
+    {
+        cache->translucentOverlay = oD->translucentOverlaySum;
+        oD->translucentOverlaySum.addRegion(cache->translucent);
+    }
+
+    addBounds(oD->subtreeBounds, cache->voD->prevClipping.extents());
+    checkCovered(oD, cache->opaque);
 }
 
-void LSceneView::LSceneViewPrivate::drawOpaqueDamage(LView *view)
+void LSceneView::LSceneViewPrivate::drawOpaqueDamage(OutputData *oD, LView *view)
 {
-    ThreadData *oD = currentThreadData;
+    if (view->imp()->outputData(oD->slot).layered && view->imp()->layer && view->imp()->layer->imp() != this)
+    {
+        drawOpaqueDamage(oD, view->imp()->layer);
+        return;
+    }
+
+    // Skipped by calcNewDamage(), nothing to draw unless the views below damaged it
+    if (view->imp()->outputData(oD->slot).subtreeSkipped && !restoreSubtree(oD, view))
+        return;
 
     // Children first
     if (view->type() != Scene)
         for (std::list<LView*>::const_reverse_iterator it = view->children().crbegin(); it != view->children().crend(); it++)
-            drawOpaqueDamage(*it);
+            drawOpaqueDamage(oD, *it);
 
-    LView::LViewPrivate::ViewCache *cache = &view->imp()->cache;
+    LView::LViewPrivate::ViewCache *cache = &view->imp()->outputData(oD->slot).cache;
 
     if (!view->isRenderable() || !cache->mapped || cache->occluded || cache->opacity < 1.f || view->imp()->colorFactor.a < 1.f)
         return;
@@ -251,6 +717,20 @@ void LSceneView::LSceneViewPrivate::drawOpaqueDamage(LView *view)
 
     oD->boxes = cache->opaque.boxes(&oD->n);
 
+    /* Pixels of the opaque region outside the damage not covered by any view above already contain
+     * the same content, so they can be drawn again. Pixels under translucent views can't, these are
+     * only blended again inside the damage */
+    if (oD->n > (Int32)oD->c->imp()->damageMaxBoxes && oD->c->imp()->damageMaxBoxes != 0)
+    {
+        LRegion bounds = cache->voD->opaque;
+        bounds.subtractRegion(cache->opaqueOverlay);
+        bounds.subtractRegion(cache->translucentOverlay);
+        oD->coarsening.opaqueBoxesIn += oD->n;
+        oD->coarsening.addedArea += cache->opaque.coarsen(oD->c->imp()->damageMaxBoxes, oD->c->imp()->damageMaxWaste, &bounds);
+        oD->boxes = cache->opaque.boxes(&oD->n);
+        oD->coarsening.opaqueBoxesOut += oD->n;
+    }
+
     if (view->imp()->hasFlag(LVS::ColorFactor))
     {
         oD->p->imp()->shaderSetColorFactor(view->imp()->colorFactor.r,
@@ -261,6 +741,10 @@ void LSceneView::LSceneViewPrivate::drawOpaqueDamage(LView *view)
     else
         oD->p->imp()->shaderSetColorFactorEnabled(0);
 
+    // Custom views may issue their own OpenGL calls
+    if (view->type() > Scene)
+        oD->p->imp()->batchSuspend();
+
     if (cache->scalingEnabled)
     {
         for (Int32 i = 0; i < oD->n; i++)
@@ -309,9 +793,8 @@ void LSceneView::LSceneViewPrivate::drawOpaqueDamage(LView *view)
     }
 }
 
-void LSceneView::LSceneViewPrivate::drawBackground(bool addToOpaqueSum)
+void LSceneView::LSceneViewPrivate::drawBackground(OutputData *oD, bool addToOpaqueSum)
 {
-    ThreadData *oD = currentThreadData;
     LRegion backgroundDamage = oD->newDamage;
     backgroundDamage.subtractRegion(oD->opaqueTransposedSum);
     oD->boxes = backgroundDamage.boxes(&oD->n);
@@ -333,15 +816,23 @@ void LSceneView::LSceneViewPrivate::drawBackground(bool addToOpaqueSum)
         oD->opaqueTransposedSum.addRegion(backgroundDamage);
 }
 
-void LSceneView::LSceneViewPrivate::drawTranslucentDamage(LView *view)
+void LSceneView::LSceneViewPrivate::drawTranslucentDamage(OutputData *oD, LView *view)
 {
-    ThreadData *oD = currentThreadData;
-    LView::LViewPrivate::ViewCache *cache = &view->imp()->cache;
+    if (view->imp()->outputData(oD->slot).layered && view->imp()->layer && view->imp()->layer->imp() != this)
+    {
+        drawTranslucentDamage(oD, view->imp()->layer);
+        return;
+    }
+
+    if (view->imp()->outputData(oD->slot).subtreeSkipped && !restoreSubtree(oD, view))
+        return;
+
+    LView::LViewPrivate::ViewCache *cache = &view->imp()->outputData(oD->slot).cache;
 
     if (!view->isRenderable() || !cache->mapped || cache->occluded)
         goto drawChildrenOnly;
 
-    glBlendFunc(view->imp()->sFactor, view->imp()->dFactor);
+    oD->p->imp()->setBlendFunc(view->imp()->sFactor, view->imp()->dFactor);
 
     if (view->imp()->hasFlag(LVS::ColorFactor))
     {
@@ -353,6 +844,10 @@ void LSceneView::LSceneViewPrivate::drawTranslucentDamage(LView *view)
     else
         oD->p->imp()->shaderSetColorFactorEnabled(0);
 
+    // Custom views may issue their own OpenGL calls
+    if (view->type() > Scene)
+        oD->p->imp()->batchSuspend();
+
     cache->occluded = true;
     cache->translucent.intersectRegion(oD->newDamage);
     cache->translucent.subtractRegion(cache->opaqueOverlay);
@@ -409,7 +904,7 @@ void LSceneView::LSceneViewPrivate::drawTranslucentDamage(LView *view)
     drawChildrenOnly:
     if (view->type() != Scene)
         for (std::list<LView*>::const_iterator it = view->children().cbegin(); it != view->children().cend(); it++)
-            drawTranslucentDamage(*it);
+            drawTranslucentDamage(oD, *it);
 }
 
 void LSceneView::LSceneViewPrivate::parentClipping(LView *parent, LRegion *region)
@@ -1,11 +1,13 @@
 #ifndef LSCENEVIEWPRIVATE_H
 #define LSCENEVIEWPRIVATE_H
 
+#include <private/LCompositorPrivate.h>
+#include <private/LOutputPrivate.h>
 #include <LFramebuffer.h>
+#include <LTime.h>
 #include <LSceneView.h>
 #include <LRegion.h>
-#include <map>
-#include <thread>
+#include <vector>
 
 using namespace Louvre;
 
@@ -16,10 +18,28 @@ LPRIVATE_CLASS(LSceneView)
     std::list<LOutput*>outputs;
     LRegion input;
 
-    struct ThreadData
+    // Per frame stats of LRegion::coarsen(), see LCompositorPrivate::damageMaxBoxes
+    struct CoarseningStats
     {
-        // List of new damage calculated in prev frames
-        std::list<LRegion*>prevDamageList;
+        // Boxes of newDamage before and after coarsening it
+        UInt32 damageBoxesIn = 0;
+        UInt32 damageBoxesOut = 0;
+
+        // Boxes of the opaque regions drawn, before and after coarsening them
+        UInt32 opaqueBoxesIn = 0;
+        UInt32 opaqueBoxesOut = 0;
+
+        // Pixels (in compositor coords) drawn in addition
+        UInt64 addedArea = 0;
+    };
+
+    struct OutputData
+    {
+        /* New damage of the last frames, the one of frame N is stored at N % LOUVRE_DAMAGE_HISTORY.
+         * Frames older than the age of the framebuffer are added to the current damage, see LFramebuffer::bufferAge() */
+        LRegion damageHistory[LOUVRE_DAMAGE_HISTORY];
+        UInt32 damageHistoryFrame = 0;
+        UInt32 damageHistorySize = 0;
 
         // New damage calculated on this frame
         LRegion newDamage;
@@ -28,50 +48,162 @@ LPRIVATE_CLASS(LSceneView)
         LRegion manuallyAddedDamage;
 
         LRect prevRect;
+        LRect prevFbRect;
+
+        // Framebuffer being rendered, the LScene view uses the framebuffer of each output
+        LFramebuffer *fb = nullptr;
+
+        // Set by the parent scene when the geometry of this view changed, see calcNewDamage()
+        bool parentChanged = true;
+
+        // Set once opaqueTransposedSum contains the whole framebuffer, all remaining views are occluded
+        bool covered;
+
+        // Set by calcViewDamage() when the regions of a view had to be recalculated, see calcCachedDamage()
+        bool changed;
+
+        // Time of the current frame (ms)
+        UInt32 frameMs;
+        UInt32 changeSerial = 0;
         LCompositor *c;
         LPainter *p;
         LOutput *o = nullptr;
+        UInt32 slot = 0;
         Int32 n, w, h;
         LBox *boxes;
         LRegion opaqueTransposedSum;
         LRegion prevExternalExclude;
 
+        // Sum of the translucent regions of the views calculated so far, see ViewCache::translucentOverlay
+        LRegion translucentOverlaySum;
+
+        // Extents of the clipping of the views calculated so far in the current subtree, see calcNewDamage()
+        LBox subtreeBounds;
+
+        CoarseningStats coarsening;
+
         // Only for non LScene
         LRegion translucentTransposedSum;
     };
 
     LRGBAF clearColor = {0,0,0,0};
-    std::map<std::thread::id, ThreadData> threadsMap;
 
-    // Quck handle to current output data
-    ThreadData *currentThreadData;
+    // Only for view layers (see LViewPrivate::layer), rendered instead of the children
+    std::list<LView*> layerRoots;
+
+    // Indexed by LOutputPrivate::slot, see LViewPrivate::outputData()
+    std::vector<OutputData> outputsData;
+
+    inline OutputData &outputData(UInt32 slot)
+    {
+        if (slot >= outputsData.size())
+            outputsData.resize(std::max((size_t)slot + 1, LCompositor::compositor()->imp()->outputSlots.size()));
+
+        return outputsData[slot];
+    }
+
+    inline void resetOutputData(UInt32 slot)
+    {
+        if (slot >= outputsData.size())
+            return;
+
+        outputsData[slot] = OutputData();
+    }
+
+    /* The LScene view is shared by all outputs, rendering threads see the framebuffer of their
+     * own output and other threads the one of an initialized output (see LScene::handleInitializeGL()) */
+    inline const LFramebuffer *sceneFramebuffer(const LSceneView *view) const
+    {
+        LOutput *output = LCompositor::LCompositorPrivate::renderingOutput;
+
+        if (output && view->isLScene())
+            return output->framebuffer();
+
+        return fb;
+    }
+
+    /* Data of the output rendered by the calling thread, used by the LView methods
+     * the parent scene calls while rendering (e.g. damage()) */
+    inline OutputData &currentOutputData()
+    {
+        LOutput *output = LCompositor::LCompositorPrivate::renderingOutput;
+        return outputData(output ? output->imp()->slot : 0);
+    }
+
+    /* These only modify the state of the given output, the view caches of the same output
+     * (see LViewPrivate::ViewCache) and the painter of the calling thread */
+    void calcNewDamage(OutputData *oD, LView *view, bool parentChanged);
+
+    // Returns true if the view and its children did not change and need nothing from the scene on each frame
+    bool calcViewDamage(OutputData *oD, LView *view, bool parentChanged);
+    void calcCachedDamage(OutputData *oD, LView *view, bool parentChanged);
+    void requestNextFrame(OutputData *oD, LView *view);
 
-    void calcNewDamage(LView *view);
-    void drawOpaqueDamage(LView *view);
-    void drawBackground(bool addToOpaqueSum);
-    void drawTranslucentDamage(LView *view);
+    /* Uploads the deferred SHM buffer of a visible surface view before it is drawn,
+     * see LSurfacePrivate::deferUpload(). Unlike the functions above, it modifies the surface */
+    void requestTexture(OutputData *oD, LView *view);
+
+    /* Called once the regions of a view are calculated, the views calculated later are below it.
+     * The opaque regions of the views above are not drawn, the translucent ones bound the
+     * coarsening of the opaque damage, see drawOpaqueDamage() */
+    void addOverlays(OutputData *oD, LView *view);
+
+    /* A subtree whose views, descendants and the views above did not change since it was last calculated on this
+     * output ends with the same opaque and translucent sums, so they are replaced at once instead of visiting it */
+    bool skipSubtree(OutputData *oD, LView *view);
+
+    /* Skipped subtrees outside the new damage are not drawn. Otherwise, the caches its views had after the fast
+     * path of calcViewDamage() are restored first. Returns false if it is not drawn */
+    bool restoreSubtree(OutputData *oD, LView *view);
+    void restoreViewCaches(OutputData *oD, LView *view);
+
+    void drawOpaqueDamage(OutputData *oD, LView *view);
+    void drawBackground(OutputData *oD, bool addToOpaqueSum);
+    void drawTranslucentDamage(OutputData *oD, LView *view);
 
     void parentClipping(LView *parent, LRegion *region);
 
-    inline void clearTmpVariables(ThreadData *oD)
+    inline void clearTmpVariables(OutputData *oD)
     {
         oD->newDamage.clear();
         oD->opaqueTransposedSum.clear();
+        oD->translucentOverlaySum.clear();
+        oD->subtreeBounds = {0, 0, 0, 0};
+        oD->covered = false;
+        oD->changed = false;
+        oD->coarsening = CoarseningStats();
+        oD->frameMs = LTime::ms();
+    }
+
+    // Called after adding an opaque region to opaqueTransposedSum
+    inline void checkCovered(OutputData *oD, const LRegion &added)
+    {
+        if (oD->covered || added.empty())
+            return;
+
+        const pixman_box32_t box
+        {
+            oD->fb->rect().x(),
+            oD->fb->rect().y(),
+            oD->fb->rect().x() + oD->fb->rect().w(),
+            oD->fb->rect().y() + oD->fb->rect().h()
+        };
+
+        oD->covered = pixman_region32_contains_rectangle(&oD->opaqueTransposedSum.m_region, &box) == PIXMAN_REGION_IN;
     }
 
-    inline void damageAll(ThreadData *oD)
+    inline void damageAll(OutputData *oD)
     {
         oD->newDamage.clear();
-        oD->newDamage.addRect(fb->rect());
-        oD->newDamage.addRect(fb->rect());
+        oD->newDamage.addRect(oD->fb->rect());
     }
 
-    inline void checkRectChange(ThreadData *oD)
+    inline void checkRectChange(OutputData *oD)
     {
-        if (oD->prevRect.size() != fb->rect().size())
+        if (oD->prevRect.size() != oD->fb->rect().size())
         {
             damageAll(oD);
-            oD->prevRect.setSize(fb->rect().size());
+            oD->prevRect.setSize(oD->fb->rect().size());
         }
     }
 };
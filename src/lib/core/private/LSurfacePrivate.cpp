@@ -1,6 +1,7 @@
 #include <protocols/WpPresentationTime/private/RWpPresentationFeedbackPrivate.h>
 #include <protocols/WpPresentationTime/presentation-time.h>
 #include <protocols/LinuxDMABuf/private/LDMABufferPrivate.h>
+#include <protocols/WpSinglePixelBuffer/RWpSinglePixelBuffer.h>
 #include <protocols/Wayland/private/RSurfacePrivate.h>
 #include <protocols/Wayland/private/GOutputPrivate.h>
 #include <private/LCompositorPrivate.h>
@@ -8,9 +9,20 @@
 #include <private/LTexturePrivate.h>
 #include <private/LOutputPrivate.h>
 #include <private/LKeyboardPrivate.h>
+#include <private/LViewPrivate.h>
+#include <LSurfaceView.h>
 #include <LOutputMode.h>
 #include <LLog.h>
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Size in buffer pixels of the tiles whose alpha is scanned to infer the opaque region
+#define LOUVRE_OPAQUE_TILE_SIZE 32
+
 static PFNEGLQUERYWAYLANDBUFFERWL eglQueryWaylandBufferWL = NULL;
 
 void LSurface::LSurfacePrivate::getEGLFunctions()
@@ -74,7 +86,13 @@ void LSurface::LSurfacePrivate::setMapped(bool state)
 
     if (mapped != state)
     {
+        // Not drawn anymore, so it would never be flushed
+        if (!state && deferredUpload.buffer)
+            flushDeferredUpload(true);
+
         mapped = state;
+        compositor()->imp()->viewInputSerial++;
+        viewsChanged(false);
 
         surface->mappingChanged();
 
@@ -143,13 +161,48 @@ void LSurface::LSurfacePrivate::applyPendingChildren()
     }
 }
 
+static void setTextureData(LTexture *texture, const LSize &sizeB, UInt32 stride, UInt32 format, const UChar8 *data)
+{
+    LCompositor::LCompositorPrivate *compositorImp = LCompositor::compositor()->imp();
+    texture->setDataB(sizeB, stride, format, data);
+    compositorImp->uploadStats.bytes += UInt64(sizeB.area()) * LTexture::formatBytesPerPixel(format);
+    compositorImp->uploadStats.calls++;
+}
+
+static void updateTextureRegion(LTexture *texture, const LRegion &region, UInt32 stride, const UChar8 *data)
+{
+    LCompositor::LCompositorPrivate *compositorImp = LCompositor::compositor()->imp();
+    const UInt32 pixelSize = LTexture::formatBytesPerPixel(texture->format());
+    std::vector<LRect> &rects = compositorImp->uploadRects;
+    UInt64 bytes = 0;
+
+    compositorImp->planUpload(region, pixelSize, rects);
+
+    for (const LRect &rect : rects)
+    {
+        texture->updateRect(rect, stride, &data[rect.x()*pixelSize + rect.y()*stride]);
+        bytes += UInt64(rect.area()) * pixelSize;
+    }
+
+    compositorImp->uploadStats.bytes += bytes;
+    compositorImp->uploadStats.calls += rects.size();
+}
+
 bool LSurface::LSurfacePrivate::bufferToTexture()
 {
     GLint texture_format;
     Int32 width, height;
     bool bufferScaleChanged = false;
     LSurface *surface = surfaceResource->surface();
-    LSize prevSize = texture->sizeB();
+
+    // The copy of a previous commit may still be in flight
+    if (uploadJob)
+    {
+        compositor()->imp()->finishUpload(uploadJob);
+        publishUpload();
+    }
+
+    LSize prevSize = currentSizeB;
 
     /***********************************
      *********** BUFFER SCALE ***********
@@ -162,6 +215,22 @@ bool LSurface::LSurfacePrivate::bufferToTexture()
         surface->bufferScaleChanged();
     }
 
+    // Replaced by a buffer of another type
+    if (!wl_shm_buffer_get(current.buffer))
+    {
+        if (!isSinglePixelBuffer(current.buffer))
+        {
+            clearInferredOpaqueRegion();
+            clearSolidColor();
+        }
+
+        if (deferredUpload.buffer)
+        {
+            compositor()->imp()->uploadStats.skipped++;
+            releaseDeferredBuffer(true);
+        }
+    }
+
     // SHM
     if (wl_shm_buffer_get(current.buffer))
     {
@@ -170,29 +239,29 @@ bool LSurface::LSurfacePrivate::bufferToTexture()
 
         texture = textureBackup;
         wl_shm_buffer *shm_buffer = wl_shm_buffer_get(current.buffer);
-        wl_shm_buffer_begin_access(shm_buffer);
         width = wl_shm_buffer_get_width(shm_buffer);
         height = wl_shm_buffer_get_height(shm_buffer);
-        void *data = wl_shm_buffer_get_data(shm_buffer);
         UInt32 format =  LTexture::waylandFormatToDRM(wl_shm_buffer_get_format(shm_buffer));
         Int32 stride = wl_shm_buffer_get_stride(shm_buffer);
         LSize newSize = LSize(width, height);
+        LRegion onlyPending;
+        bool fullDamage = false;
 
-        if (texture->sizeB() != newSize)
+        compositor()->imp()->uploadStats.commits++;
+
+        // The texture may not contain the last committed buffer yet, see deferUpload()
+        if (currentSizeB != newSize)
             bufferSizeChanged = true;
 
         if (!texture->initialized() || bufferSizeChanged || bufferScaleChanged)
         {
-            currentDamageB.clear();
-            currentDamageB.addRect(LRect(0, newSize));
-            currentDamage.clear();
-            currentDamage.addRect(LRect(0, newSize / current.bufferScale));
-            texture->setDataB(newSize, stride, format, data);
+            fullDamage = true;
+            onlyPending.addRect(LRect(0, newSize));
+            pendingDamageB.clear();
+            pendingDamage.clear();
         }
         else if (!pendingDamageB.empty() || !pendingDamage.empty())
         {
-            LRegion onlyPending;
-
             if (current.bufferScale == 1)
             {
                 if (compositor()->imp()->greatestOutputScale == 1)
@@ -268,37 +337,106 @@ bool LSurface::LSurfacePrivate::bufferToTexture()
                 }
             }
 
-            onlyPending.clip(0, texture->sizeB());
+            onlyPending.clip(0, newSize);
+        }
+        else if (!deferredUpload.buffer)
+            return true;
+
+        const bool uniform = !onlyPending.empty() && detectSolidColor(shm_buffer, format, newSize, onlyPending);
+
+        // Uniform buffers with opaque alpha are fully opaque
+        if (uniform && solidColor.a == 1.f)
+            inferOpaqueRegion(shm_buffer, DRM_FORMAT_XRGB8888, newSize, onlyPending);
+        else if (!onlyPending.empty())
+            inferOpaqueRegion(shm_buffer, format, newSize, onlyPending);
+
+        // Rects the texture lacks
+        LRegion uploadRegion = onlyPending;
+
+        // The new buffer also contains the content of the replaced one
+        if (deferredUpload.buffer)
+        {
+            uploadRegion.addRegion(deferredUpload.region);
 
-            UInt32 pixelSize = LTexture::formatBytesPerPixel(format);
-            UChar8 *buff = (UChar8 *)data;
+            if (deferredUpload.buffer != current.buffer)
+                compositor()->imp()->uploadStats.skipped++;
 
-            Int32 n, w, h;
-            LBox *boxes = onlyPending.boxes(&n);
-            for (Int32 i = 0; i < n; i++)
+            releaseDeferredBuffer(deferredUpload.buffer != current.buffer);
+        }
+
+        const bool fullUpload = !texture->initialized() || texture->sizeB() != newSize || texture->format() != format;
+
+        // Drawn as a solid color, see setSolidColor()
+        if (uniform)
+            releaseUploadTexture();
+        // Full uploads are never deferred, so views never draw a texture of another size or format
+        else if (!fullUpload && (coalesceCommits || (compositor()->imp()->lazyUploads && !textureRequested)) && !surface->cursorRole())
+        {
+            uploadStale.addRegion(uploadRegion);
+            deferUpload(uploadRegion);
+        }
+        else if (!fullUpload && queueUpload(shm_buffer, format, stride, onlyPending, uploadRegion))
+        {
+            // Released and published by publishUpload()
+            bufferReleased = true;
+            textureRequested = false;
+            return true;
+        }
+        else
+        {
+            wl_shm_buffer_begin_access(shm_buffer);
+            const UChar8 *data = (const UChar8*)wl_shm_buffer_get_data(shm_buffer);
+
+            if (fullUpload)
+            {
+                releaseUploadTexture();
+                setTextureData(texture, newSize, stride, format, data);
+            }
+            else
             {
-                w = boxes->x2 - boxes->x1;
-                h = boxes->y2 - boxes->y1;
-                texture->updateRect(LRect(boxes->x1,
-                                          boxes->y1,
-                                          w,
-                                          h),
-                                    stride,
-                                    &buff[boxes->x1*pixelSize + boxes->y1*stride]);
-
-                currentDamageB.addRect(boxes->x1, boxes->y1, w, h);
-                boxes++;
+                uploadStale.addRegion(uploadRegion);
+                updateTextureRegion(texture, uploadRegion, stride, data);
             }
 
-            LRegion::multiply(&currentDamage, &currentDamageB, 1.f/Float32(current.bufferScale));
+            wl_shm_buffer_end_access(shm_buffer);
+        }
+
+        if (fullDamage)
+        {
+            currentDamageB.clear();
+            currentDamageB.addRect(LRect(0, newSize));
+            currentDamage.clear();
+            currentDamage.addRect(LRect(0, newSize / current.bufferScale));
         }
         else
         {
-            wl_shm_buffer_end_access(shm_buffer);
-            return true;
+            currentDamageB.addRegion(onlyPending);
+            LRegion::multiply(&currentDamage, &currentDamageB, 1.f/Float32(current.bufferScale));
         }
 
-        wl_shm_buffer_end_access(shm_buffer);
+        currentSizeB = newSize;
+    }
+    // Single pixel buffers are always drawn as a solid color
+    else if (isSinglePixelBuffer(current.buffer))
+    {
+        if (texture && texture != textureBackup && texture->imp()->pendingDelete)
+            delete texture;
+
+        texture = textureBackup;
+        RWpSinglePixelBuffer *singlePixelBuffer = (RWpSinglePixelBuffer*)wl_resource_get_user_data(current.buffer);
+        damageNormal(1, 1, prevSize, bufferScaleChanged);
+        releaseUploadTexture();
+        setSolidColor(singlePixelBuffer->pixel(), DRM_FORMAT_ARGB8888);
+
+        // Keep the full precision of the protocol
+        solidColor = singlePixelBuffer->color();
+
+        if (solidColor.a == 1.f)
+            inferOpaqueRegion(nullptr, DRM_FORMAT_XRGB8888, LSize(1, 1), currentDamageB);
+        else
+            clearInferredOpaqueRegion();
+
+        currentSizeB = LSize(1, 1);
     }
     // WL_DRM
     else if (eglQueryWaylandBufferWL(LCompositor::eglDisplay(), current.buffer, EGL_TEXTURE_FORMAT, &texture_format))
@@ -310,6 +448,7 @@ bool LSurface::LSurfacePrivate::bufferToTexture()
         eglQueryWaylandBufferWL(LCompositor::eglDisplay(), current.buffer, EGL_WIDTH, &width);
         eglQueryWaylandBufferWL(LCompositor::eglDisplay(), current.buffer, EGL_HEIGHT, &height);
         damageNormal(width, height, prevSize, bufferScaleChanged);
+        releaseUploadTexture();
         texture->setData(current.buffer);
     }
     else if (isDMABuffer(current.buffer))
@@ -325,6 +464,7 @@ bool LSurface::LSurfacePrivate::bufferToTexture()
         }
 
         damageNormal(width, height, prevSize, bufferScaleChanged);
+        releaseUploadTexture();
 
         if (texture && texture != textureBackup && texture->imp()->pendingDelete)
             delete texture;
@@ -338,8 +478,11 @@ bool LSurface::LSurfacePrivate::bufferToTexture()
         return false;
     }
 
-    currentSizeB = texture->sizeB();
-    currentSize = texture->sizeB()/current.bufferScale;
+    // The texture of solid color surfaces is 1x1, see setSolidColor()
+    if (!isSolidColor)
+        currentSizeB = texture->sizeB();
+
+    currentSize = currentSizeB/current.bufferScale;
 
     if (bufferSizeChanged)
         surface->bufferSizeChanged();
@@ -347,8 +490,12 @@ bool LSurface::LSurfacePrivate::bufferToTexture()
     pendingDamageB.clear();
     pendingDamage.clear();
 
-    wl_buffer_send_release(current.buffer);
+    // Deferred buffers are released by flushDeferredUpload()
+    if (deferredUpload.buffer != current.buffer)
+        wl_buffer_send_release(current.buffer);
+
     bufferReleased = true;
+    textureRequested = false;
 
     damageId = LCompositor::nextSerial();
 
@@ -357,6 +504,480 @@ bool LSurface::LSurfacePrivate::bufferToTexture()
     return true;
 }
 
+// Checks if the alpha of all the ARGB8888 pixels of a row is 0xFF
+static bool opaqueRow(const UInt32 *pixels, Int32 count)
+{
+    Int32 i = 0;
+
+#if defined(__AVX2__)
+    __m256i acc = _mm256_set1_epi32(-1);
+
+    for (; i + 8 <= count; i += 8)
+        acc = _mm256_and_si256(acc, _mm256_loadu_si256((const __m256i*)&pixels[i]));
+
+    acc = _mm256_or_si256(acc, _mm256_set1_epi32(0x00FFFFFF));
+
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(acc, _mm256_set1_epi32(-1))) != -1)
+        return false;
+#elif defined(__SSE2__)
+    __m128i acc = _mm_set1_epi32(-1);
+
+    for (; i + 4 <= count; i += 4)
+        acc = _mm_and_si128(acc, _mm_loadu_si128((const __m128i*)&pixels[i]));
+
+    acc = _mm_or_si128(acc, _mm_set1_epi32(0x00FFFFFF));
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(acc, _mm_set1_epi32(-1))) != 0xFFFF)
+        return false;
+#elif defined(__ARM_NEON)
+    uint32x4_t acc = vdupq_n_u32(0xFFFFFFFF);
+
+    for (; i + 4 <= count; i += 4)
+        acc = vandq_u32(acc, vld1q_u32(&pixels[i]));
+
+    const uint32x2_t half = vand_u32(vget_low_u32(acc), vget_high_u32(acc));
+
+    if (((vget_lane_u32(half, 0) & vget_lane_u32(half, 1)) >> 24) != 0xFF)
+        return false;
+#endif
+
+    UInt32 rest = 0xFFFFFFFF;
+
+    for (; i < count; i++)
+        rest &= pixels[i];
+
+    return (rest >> 24) == 0xFF;
+}
+
+void LSurface::LSurfacePrivate::inferOpaqueRegion(wl_shm_buffer *shmBuffer, UInt32 format, const LSize &sizeB, const LRegion &damage)
+{
+    if (format == DRM_FORMAT_XRGB8888)
+    {
+        Int32 n;
+        const LBox *box = inferredOpaqueRegionB.boxes(&n);
+
+        if (!opaqueTiles.empty() || n != 1 || box->x1 != 0 || box->y1 != 0 || box->x2 != sizeB.w() || box->y2 != sizeB.h())
+        {
+            opaqueTiles.clear();
+            inferredOpaqueRegionB.clear();
+            inferredOpaqueRegionB.addRect(LRect(0, sizeB));
+            inferredOpaqueRegionChanged = true;
+        }
+
+        return;
+    }
+
+    if (format != DRM_FORMAT_ARGB8888 || !compositor()->imp()->inferOpaqueRegions)
+    {
+        clearInferredOpaqueRegion();
+        return;
+    }
+
+    const Int32 T = LOUVRE_OPAQUE_TILE_SIZE;
+    const LSize tiles((sizeB.w() + T - 1) / T, (sizeB.h() + T - 1) / T);
+    LRegion scan;
+
+    /* Only the tiles touched by the damage are scanned again. A new map starts without opaque tiles,
+     * so the region is always rebuilt, replacing the one of the previous size or format */
+    const bool reallocated = opaqueTilesSizeB != sizeB || opaqueTiles.size() != (size_t)tiles.area();
+
+    if (reallocated)
+    {
+        opaqueTiles.assign(tiles.area(), false);
+        opaqueTilesSizeB = sizeB;
+        scan.addRect(LRect(0, tiles));
+    }
+    else
+    {
+        Int32 n;
+        const LBox *box = damage.boxes(&n);
+
+        for (Int32 i = 0; i < n; i++, box++)
+            scan.addRect(box->x1 / T, box->y1 / T, (box->x2 + T - 1) / T - box->x1 / T, (box->y2 + T - 1) / T - box->y1 / T);
+
+        scan.clip(LRect(0, tiles));
+    }
+
+    Int32 n;
+    const LBox *box = scan.boxes(&n);
+    const UInt32 stride = wl_shm_buffer_get_stride(shmBuffer);
+    bool changed = reallocated;
+
+    wl_shm_buffer_begin_access(shmBuffer);
+    const UChar8 *data = (const UChar8*)wl_shm_buffer_get_data(shmBuffer);
+
+    for (Int32 i = 0; i < n; i++, box++)
+    {
+        for (Int32 ty = box->y1; ty < box->y2; ty++)
+        {
+            const Int32 y1 = ty * T;
+            const Int32 y2 = std::min(y1 + T, sizeB.h());
+
+            for (Int32 tx = box->x1; tx < box->x2; tx++)
+            {
+                const Int32 x1 = tx * T;
+                const Int32 w = std::min(x1 + T, sizeB.w()) - x1;
+                bool opaque = true;
+
+                for (Int32 y = y1; y < y2 && opaque; y++)
+                    opaque = opaqueRow((const UInt32*)&data[y * stride + x1 * 4], w);
+
+                if (opaqueTiles[ty * tiles.w() + tx] != opaque)
+                {
+                    opaqueTiles[ty * tiles.w() + tx] = opaque;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    wl_shm_buffer_end_access(shmBuffer);
+
+    if (!changed)
+        return;
+
+    // Runs of opaque tiles of each row
+    inferredOpaqueRegionB.clear();
+
+    for (Int32 ty = 0; ty < tiles.h(); ty++)
+    {
+        Int32 tx = 0;
+
+        while (tx < tiles.w())
+        {
+            if (!opaqueTiles[ty * tiles.w() + tx])
+            {
+                tx++;
+                continue;
+            }
+
+            const Int32 start = tx;
+
+            while (tx < tiles.w() && opaqueTiles[ty * tiles.w() + tx])
+                tx++;
+
+            inferredOpaqueRegionB.addRect(start * T, ty * T, (tx - start) * T, T);
+        }
+    }
+
+    inferredOpaqueRegionB.clip(LRect(0, sizeB));
+    inferredOpaqueRegionChanged = true;
+}
+
+void LSurface::LSurfacePrivate::clearInferredOpaqueRegion()
+{
+    opaqueTiles.clear();
+    opaqueTilesSizeB = LSize();
+
+    if (inferredOpaqueRegionB.empty())
+        return;
+
+    inferredOpaqueRegionB.clear();
+    inferredOpaqueRegionChanged = true;
+}
+
+// Checks if the masked pixels of a row are equal to value, stops at the first 8 pixels containing a different one
+static bool uniformRow(const UInt32 *pixels, Int32 count, UInt32 value, UInt32 mask)
+{
+    Int32 i = 0;
+    value &= mask;
+
+#if defined(__AVX2__)
+    const __m256i vValue = _mm256_set1_epi32(value);
+    const __m256i vMask = _mm256_set1_epi32(mask);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i px = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)&pixels[i]), vMask);
+
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(px, vValue)) != -1)
+            return false;
+    }
+#elif defined(__SSE2__)
+    const __m128i vValue = _mm_set1_epi32(value);
+    const __m128i vMask = _mm_set1_epi32(mask);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i px0 = _mm_and_si128(_mm_loadu_si128((const __m128i*)&pixels[i]), vMask);
+        const __m128i px1 = _mm_and_si128(_mm_loadu_si128((const __m128i*)&pixels[i + 4]), vMask);
+
+        if (_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi32(px0, vValue), _mm_cmpeq_epi32(px1, vValue))) != 0xFFFF)
+            return false;
+    }
+#elif defined(__ARM_NEON)
+    const uint32x4_t vValue = vdupq_n_u32(value);
+    const uint32x4_t vMask = vdupq_n_u32(mask);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        const uint32x4_t eq = vandq_u32(vceqq_u32(vandq_u32(vld1q_u32(&pixels[i]), vMask), vValue),
+                                        vceqq_u32(vandq_u32(vld1q_u32(&pixels[i + 4]), vMask), vValue));
+        const uint32x2_t half = vand_u32(vget_low_u32(eq), vget_high_u32(eq));
+
+        if ((vget_lane_u32(half, 0) & vget_lane_u32(half, 1)) != 0xFFFFFFFF)
+            return false;
+    }
+#endif
+
+    for (; i < count; i++)
+        if ((pixels[i] & mask) != value)
+            return false;
+
+    return true;
+}
+
+bool LSurface::LSurfacePrivate::detectSolidColor(wl_shm_buffer *shmBuffer, UInt32 format, const LSize &sizeB, const LRegion &damage)
+{
+    // LCursor keeps the texture of cursor surfaces
+    if (!compositor()->imp()->detectSolidColors ||
+        (format != DRM_FORMAT_ARGB8888 && format != DRM_FORMAT_XRGB8888) ||
+        surfaceResource->surface()->cursorRole())
+    {
+        clearSolidColor();
+        return false;
+    }
+
+    Int32 n;
+    const LBox *box = damage.boxes(&n);
+    const UInt32 stride = wl_shm_buffer_get_stride(shmBuffer);
+    const UInt32 mask = format == DRM_FORMAT_XRGB8888 ? 0x00FFFFFF : 0xFFFFFFFF;
+
+    // Only the damage needs to match the current color
+    const bool sameColor = isSolidColor && solidFormat == format && currentSizeB == sizeB;
+    bool uniform = true;
+    UInt32 pixel = solidPixel;
+
+    // Otherwise the whole buffer must be scanned, which is only worth it if it was fully damaged
+    if (!sameColor)
+    {
+        Int32 damagedArea = 0;
+
+        for (Int32 i = 0; i < n; i++)
+            damagedArea += (box[i].x2 - box[i].x1) * (box[i].y2 - box[i].y1);
+
+        if (damagedArea != sizeB.area())
+        {
+            clearSolidColor();
+            return false;
+        }
+    }
+
+    wl_shm_buffer_begin_access(shmBuffer);
+    const UChar8 *data = (const UChar8*)wl_shm_buffer_get_data(shmBuffer);
+
+    if (!sameColor)
+        pixel = *(const UInt32*)data;
+
+    for (Int32 i = 0; i < n && uniform; i++, box++)
+        for (Int32 y = box->y1; y < box->y2 && uniform; y++)
+            uniform = uniformRow((const UInt32*)&data[y*stride + box->x1*4], box->x2 - box->x1, pixel, mask);
+
+    wl_shm_buffer_end_access(shmBuffer);
+
+    if (!uniform)
+    {
+        clearSolidColor();
+        return false;
+    }
+
+    setSolidColor(format == DRM_FORMAT_XRGB8888 ? pixel | 0xFF000000 : pixel, format);
+    compositor()->imp()->uploadStats.solid++;
+    return true;
+}
+
+void LSurface::LSurfacePrivate::setSolidColor(UInt32 pixel, UInt32 format)
+{
+    // Replaces the texture with a single pixel of the color, scaled by whoever draws it
+    if (!isSolidColor || solidPixel != pixel || solidFormat != format || !textureBackup->initialized())
+        setTextureData(textureBackup, LSize(1, 1), 4, format, (const UChar8*)&pixel);
+
+    isSolidColor = true;
+    solidPixel = pixel;
+    solidFormat = format;
+    solidColor.a = Float32(pixel >> 24) / 255.f;
+    solidColor.r = Float32((pixel >> 16) & 0xFF) / 255.f;
+    solidColor.g = Float32((pixel >> 8) & 0xFF) / 255.f;
+    solidColor.b = Float32(pixel & 0xFF) / 255.f;
+}
+
+void LSurface::LSurfacePrivate::clearSolidColor()
+{
+    isSolidColor = false;
+}
+
+static void deferredBufferDestroyed(wl_listener *listener, void *data)
+{
+    L_UNUSED(data);
+    LSurface::LSurfacePrivate::DeferredUpload *deferred = wl_container_of(listener, deferred, bufferDestroyListener);
+
+    // Last chance to read its content
+    deferred->surface->imp()->flushDeferredUpload(false);
+}
+
+void LSurface::LSurfacePrivate::deferUpload(const LRegion &region)
+{
+    deferredUpload.surface = surfaceResource->surface();
+    deferredUpload.buffer = current.buffer;
+    deferredUpload.region = region;
+    deferredUpload.bufferDestroyListener.notify = &deferredBufferDestroyed;
+    wl_resource_add_destroy_listener(current.buffer, &deferredUpload.bufferDestroyListener);
+    compositor()->imp()->deferredUploads.push_back(deferredUpload.surface);
+    deferredUpload.compositorLink = std::prev(compositor()->imp()->deferredUploads.end());
+    compositor()->imp()->uploadStats.deferred++;
+}
+
+void LSurface::LSurfacePrivate::flushDeferredUpload(bool releaseBuffer)
+{
+    wl_shm_buffer *shmBuffer = wl_shm_buffer_get(deferredUpload.buffer);
+    const LSize sizeB(wl_shm_buffer_get_width(shmBuffer), wl_shm_buffer_get_height(shmBuffer));
+    const UInt32 format = LTexture::waylandFormatToDRM(wl_shm_buffer_get_format(shmBuffer));
+    const UInt32 stride = wl_shm_buffer_get_stride(shmBuffer);
+
+    wl_shm_buffer_begin_access(shmBuffer);
+    const UChar8 *data = (const UChar8*)wl_shm_buffer_get_data(shmBuffer);
+
+    if (!textureBackup->initialized() || textureBackup->sizeB() != sizeB || textureBackup->format() != format)
+        setTextureData(textureBackup, sizeB, stride, format, data);
+    else
+        updateTextureRegion(textureBackup, deferredUpload.region, stride, data);
+
+    wl_shm_buffer_end_access(shmBuffer);
+
+    // Its damage was already published during the commit
+    releaseDeferredBuffer(releaseBuffer);
+}
+
+void LSurface::LSurfacePrivate::releaseDeferredBuffer(bool releaseBuffer)
+{
+    wl_list_remove(&deferredUpload.bufferDestroyListener.link);
+    compositor()->imp()->deferredUploads.erase(deferredUpload.compositorLink);
+
+    if (releaseBuffer)
+        wl_buffer_send_release(deferredUpload.buffer);
+
+    deferredUpload.buffer = nullptr;
+    deferredUpload.region.clear();
+}
+
+static void uploadBufferDestroyed(wl_listener *listener, void *data)
+{
+    L_UNUSED(data);
+    LCompositor::LCompositorPrivate::UploadJob *job = wl_container_of(listener, job, bufferDestroyListener);
+
+    // The upload thread may still be reading it
+    LCompositor::compositor()->imp()->waitUpload(job);
+    wl_list_remove(&listener->link);
+    job->buffer = nullptr;
+}
+
+bool LSurface::LSurfacePrivate::queueUpload(wl_shm_buffer *shmBuffer, UInt32 format, UInt32 stride, const LRegion &damage, const LRegion &region)
+{
+    LCompositor::LCompositorPrivate *compositorImp = compositor()->imp();
+    LSurface *surface = surfaceResource->surface();
+
+    // LCursor keeps the texture of cursor surfaces
+    if (!compositorImp->uploadThreadRunning || surface->cursorRole())
+        return false;
+
+    const LSize &sizeB = textureBackup->sizeB();
+    const bool create = !uploadTexture ||
+                        !uploadTexture->initialized() ||
+                        uploadTexture->sizeB() != sizeB ||
+                        uploadTexture->format() != format;
+
+    if (create)
+    {
+        releaseUploadTexture();
+        uploadTexture = new LTexture();
+        uploadTexture->imp()->sizeB = sizeB;
+        uploadTexture->imp()->format = format;
+        uploadTexture->imp()->sourceType = LTexture::CPU;
+    }
+    else
+    {
+        // Frames sampling its content through textureBackup were waited by publishUpload()
+        uploadTexture->imp()->serial++;
+    }
+
+    LCompositor::LCompositorPrivate::UploadJob *job = new LCompositor::LCompositorPrivate::UploadJob();
+    job->surface = surface;
+    job->buffer = current.buffer;
+    job->shmBuffer = shmBuffer;
+    job->pool = wl_shm_buffer_ref_pool(shmBuffer);
+    job->texture = uploadTexture;
+    job->create = create;
+    job->stride = stride;
+    job->damage = damage;
+    job->stale = region;
+
+    if (!create)
+    {
+        job->region = region;
+        job->region.addRegion(uploadStale);
+        job->region.clip(LRect(0, sizeB));
+    }
+
+    job->bufferDestroyListener.notify = &uploadBufferDestroyed;
+    wl_resource_add_destroy_listener(current.buffer, &job->bufferDestroyListener);
+    uploadStale.clear();
+    uploadJob = job;
+    compositorImp->queueUpload(job);
+    return true;
+}
+
+void LSurface::LSurfacePrivate::publishUpload()
+{
+    LCompositor::LCompositorPrivate::UploadJob *job = uploadJob;
+    uploadJob = nullptr;
+    wl_shm_pool_unref(job->pool);
+
+    if (job->buffer)
+    {
+        wl_list_remove(&job->bufferDestroyListener.link);
+        wl_buffer_send_release(job->buffer);
+    }
+
+    if (job->failed)
+    {
+        LLog::error("[LSurfacePrivate::publishUpload] Failed to upload SHM buffer.");
+        releaseUploadTexture();
+        delete job;
+        return;
+    }
+
+    /* The previous content lacks the new damage. Only the backend data is swapped, so the
+     * LTexture returned by LSurface::texture() is kept and never partially written */
+    compositor()->imp()->waitUnlockedRenders(textureBackup);
+    LTexture::LTexturePrivate *backupImp = textureBackup->imp();
+    LTexture::LTexturePrivate *uploadImp = uploadTexture->imp();
+    std::swap(backupImp->graphicBackendData, uploadImp->graphicBackendData);
+    std::swap(backupImp->sizeB, uploadImp->sizeB);
+    std::swap(backupImp->format, uploadImp->format);
+    backupImp->serial++;
+    texture = textureBackup;
+    uploadStale = job->stale;
+
+    currentDamageB.addRegion(job->damage);
+    LRegion::multiply(&currentDamage, &currentDamageB, 1.f/Float32(current.bufferScale));
+    damageId = LCompositor::nextSerial();
+    damaged = true;
+    delete job;
+    viewsChanged(false);
+    surfaceResource->surface()->damageChanged();
+}
+
+void LSurface::LSurfacePrivate::releaseUploadTexture()
+{
+    if (uploadTexture)
+    {
+        delete uploadTexture;
+        uploadTexture = nullptr;
+    }
+
+    uploadStale.clear();
+}
+
 void LSurface::LSurfacePrivate::sendPresentationFeedback(LOutput *output, timespec &ns)
 {
     if (wpPresentationFeedbackResources.empty())
@@ -480,3 +1101,13 @@ void LSurface::LSurfacePrivate::setKeyboardGrabToParent()
         }
     }
 }
+
+void LSurface::LSurfacePrivate::viewsChanged(bool children)
+{
+    for (LSurfaceView *view : views)
+        LView::LViewPrivate::subtreeChanged(view);
+
+    if (children)
+        for (LSurface *child : this->children)
+            child->imp()->viewsChanged(true);
+}
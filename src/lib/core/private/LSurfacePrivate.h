@@ -58,7 +58,54 @@ LPRIVATE_CLASS(LSurface)
     Wayland::RSurface *surfaceResource = nullptr;
     LSurfaceView *lastPointerEventView = nullptr;
 
+    // Views of the surface, see viewsChanged()
+    std::list<LSurfaceView*> views;
+
     LTexture *textureBackup;
+
+    /* With asynchronous SHM uploads, damaged rects are copied into uploadTexture by the upload thread
+     * and then its backend data is swapped with the one of textureBackup. uploadStale contains the rects it lacks since the last swap */
+    LTexture *uploadTexture                             = nullptr;
+    LRegion uploadStale;
+    LCompositor::LCompositorPrivate::UploadJob *uploadJob = nullptr;
+
+    /* SHM buffer committed while the surface was not drawn since the previous commit (LOUVRE_LAZY_SHM_UPLOAD)
+     * or with commit coalescing enabled. It is uploaded once a scene finds an LSurfaceView of the surface visible,
+     * before drawing it. It is released once uploaded, replaced by a newer buffer or when the surface is unmapped */
+    struct DeferredUpload
+    {
+        wl_listener bufferDestroyListener;
+        LSurface *surface                               = nullptr;
+        wl_resource *buffer                             = nullptr;
+
+        // Rects the texture lacks, in buffer coords
+        LRegion region;
+
+        // In LCompositorPrivate::deferredUploads
+        std::list<LSurface*>::iterator compositorLink;
+    } deferredUpload;
+
+    // Set when a scene finds an LSurfaceView of the surface visible, cleared on each commit
+    bool textureRequested                               = false;
+
+    // Defers every partial SHM upload until the surface is drawn, see LSurface::enableCommitCoalescing()
+    bool coalesceCommits                                = false;
+
+    /* Opaque region inferred from the content of SHM buffers, in buffer coords. XRGB8888 buffers are fully opaque,
+     * while ARGB8888 buffers are divided into tiles whose alpha is scanned when damaged (LOUVRE_INFER_OPAQUE_REGION).
+     * It is added to the client opaque region on commit. opaqueTilesSizeB is the buffer size the tiles were scanned for */
+    LRegion inferredOpaqueRegionB;
+    std::vector<bool> opaqueTiles;
+    LSize opaqueTilesSizeB;
+    bool inferredOpaqueRegionChanged                    = false;
+
+    /* Surfaces whose buffer is a wp_single_pixel_buffer_v1 or a uniform SHM buffer (LOUVRE_SOLID_COLOR_DETECTION) are drawn
+     * as a solid color and their texture is replaced with a 1x1 texture of the color from the main thread, see setSolidColor().
+     * solidPixel is the pixel in solidFormat and solidColor its premultiplied value */
+    bool isSolidColor                                   = false;
+    UInt32 solidPixel                                   = 0;
+    UInt32 solidFormat                                  = 0;
+    LRGBAF solidColor;
     LSurface *parent                                    = nullptr;
     LSurface *pendingParent                             = nullptr;
     std::list<LSurface*> children;
@@ -67,6 +114,9 @@ LPRIVATE_CLASS(LSurface)
     std::list<LSurface*>::iterator pendingParentLink;
     std::list<Wayland::RCallback*>frameCallbacks;
     UInt32 damageId;
+
+    // Incremented on each applied commit
+    UInt32 commitSerial = 0;
     std::list<LSurface*>::iterator compositorLink, clientLink;
     Int32 lastSentPreferredBufferScale = -1;
     std::list<LOutput*> outputs;
@@ -83,7 +133,22 @@ LPRIVATE_CLASS(LSurface)
     void applyPendingRole();
     void applyPendingChildren();
     bool bufferToTexture();
+    bool queueUpload(wl_shm_buffer *shmBuffer, UInt32 format, UInt32 stride, const LRegion &damage, const LRegion &region);
+    void publishUpload();
+    void releaseUploadTexture();
+    void deferUpload(const LRegion &region);
+    void flushDeferredUpload(bool releaseBuffer);
+    void releaseDeferredBuffer(bool releaseBuffer);
+    void inferOpaqueRegion(wl_shm_buffer *shmBuffer, UInt32 format, const LSize &sizeB, const LRegion &damage);
+    void clearInferredOpaqueRegion();
+    bool detectSolidColor(wl_shm_buffer *shmBuffer, UInt32 format, const LSize &sizeB, const LRegion &damage);
+    void setSolidColor(UInt32 pixel, UInt32 format);
+    void clearSolidColor();
     void notifyPosUpdateToChildren(LSurface *surface);
+
+    /* Called when the views may be drawn differently without LView::repaint() being called (e.g. after a commit),
+     * so scenes don't skip them (see LSceneViewPrivate::skipSubtree()). Children are included when the surface moves */
+    void viewsChanged(bool children);
     void sendPreferredScale();
     bool isInChildrenOrPendingChildren(LSurface *child);
     bool hasRoleOrPendingRole();
@@ -8,6 +8,10 @@ using namespace Louvre;
 
 LPRIVATE_CLASS(LSurfaceView)
     LSurface *surface;
+
+    // In LSurfacePrivate::views, unlinked when the surface is destroyed first
+    std::list<LSurfaceView*>::iterator surfaceLink;
+    bool surfaceLinked = true;
     LRegion *customInputRegion = nullptr;
     LRegion *customTranslucentRegion = nullptr;
     LPoint customPos;
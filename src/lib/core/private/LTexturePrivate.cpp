@@ -2,6 +2,8 @@
 #include <private/LCompositorPrivate.h>
 #include <private/LCursorPrivate.h>
 #include <private/LOutputPrivate.h>
+#include <private/LViewPrivate.h>
+#include <LTextureView.h>
 
 void LTexture::LTexturePrivate::deleteTexture()
 {
@@ -13,9 +15,19 @@ void LTexture::LTexturePrivate::deleteTexture()
 
     serial++;
 
+    // The size of texture views may change
+    if (!textureViews.empty())
+        compositor()->imp()->viewInputSerial++;
+
+    for (LTextureView *view : textureViews)
+        LView::LViewPrivate::subtreeChanged(view);
+
     if (texture->sourceType() == Framebuffer)
         return;
 
+    // Outputs may be sampling it
+    compositor()->imp()->waitUnlockedRenders(texture);
+
     if (texture->sourceType() == Native)
     {
         if (nativeOutput)
@@ -4,6 +4,7 @@
 #include <GL/gl.h>
 #include <LTexture.h>
 #include <LSize.h>
+#include <atomic>
 
 using namespace Louvre;
 
@@ -18,6 +19,10 @@ LPRIVATE_CLASS(LTexture)
 
     // Increases each time the texture is modified
     UInt32 serial                                       = 0;
+
+    /* Number of recorded LScene frames sampling it being drawn without the render mutex,
+     * see LCompositorPrivate::waitUnlockedRenders() */
+    std::atomic<UInt32> unlockedRenders                 { 0 };
     bool pendingDelete = false;
 
     std::list<LTexture*>::iterator compositorLink;
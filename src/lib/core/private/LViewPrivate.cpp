@@ -1,33 +1,48 @@
 #include <private/LViewPrivate.h>
 #include <private/LScenePrivate.h>
 #include <private/LSceneViewPrivate.h>
+#include <private/LOutputPrivate.h>
 
-void LView::LViewPrivate::removeThread(LView *view, std::thread::id thread)
+void LView::LViewPrivate::removeOutput(LView *view, LOutput *output)
 {
-    auto it = threadsMap.find(thread);
+    const UInt32 slot = output->imp()->slot;
 
-    if (it != threadsMap.end())
+    if (slot < outputsData.size())
     {
-        if (it->second.o)
-            view->leftOutput(it->second.o);
-        threadsMap.erase(it);
+        if (outputsData[slot].o)
+            view->leftOutput(outputsData[slot].o);
+
+        outputsData[slot] = ViewOutputData();
     }
 
     if (view->type() != Scene)
         return;
 
     LSceneView *sceneView = (LSceneView*)view;
+    sceneView->imp()->resetOutputData(slot);
+}
+
+void LView::LViewPrivate::releaseLayer(LView *view)
+{
+    if (!layer)
+        return;
 
-    auto sit = sceneView->imp()->threadsMap.find(thread);
+    compositor()->imp()->releaseLayerBuffer((LRenderBuffer*)layer->imp()->fb);
+    layer->imp()->fb = nullptr;
+    delete layer;
+    layer = nullptr;
+    layerInvalid = false;
+    layerStaticFrames = 0;
 
-    if (sit != sceneView->imp()->threadsMap.end())
-        sceneView->imp()->threadsMap.erase(sit);
+    // The views were last drawn into the layer, draw them again directly
+    view->imp()->markAsChangedOrder();
+    subtreeChanged(view);
 }
 
 void LView::LViewPrivate::markAsChangedOrder(bool includeChildren)
 {
-    for (auto &pair : threadsMap)
-        pair.second.changedOrder = true;
+    for (ViewOutputData &data : outputsData)
+        data.changedOrder = true;
 
     if (includeChildren)
         for (LView *child : children)
@@ -38,13 +53,13 @@ void LView::LViewPrivate::damageScene(LSceneView *s)
 {
     if (s)
     {
-        for (auto &pair : threadsMap)
+        for (const ViewOutputData &data : outputsData)
         {
-            if (!pair.second.prevMapped)
+            if (!data.prevMapped)
                 continue;
 
-            if (pair.second.o)
-                s->addDamage(pair.second.o, pair.second.prevClipping);
+            if (data.o)
+                s->addDamage(data.o, data.prevClipping);
         }
 
         for (LView *child : children)
@@ -1,11 +1,11 @@
 #ifndef LVIEWPRIVATE_H
 #define LVIEWPRIVATE_H
 
+#include <private/LCompositorPrivate.h>
 #include <LRegion.h>
 #include <LView.h>
 #include <LRect.h>
-#include <map>
-#include <thread>
+#include <vector>
 #include <LPainter.h>
 #include <GL/gl.h>
 
@@ -17,14 +17,12 @@ LPRIVATE_CLASS(LView)
     {
         /* Sometimes view ordering can change while a scene is emitting an event,
          * in such cases it must start again. These flags are for preventing re-sending
-         * the event to the same view */
-        PointerMoveDone         = 1 << 0,
+         * the event to the same view (pointer move events use pointerMoveSerial) */
         PointerButtonDone       = 1 << 2,
         PointerAxisDone         = 1 << 3,
         KeyModifiersDone        = 1 << 4,
         KeyDone                 = 1 << 5,
 
-        RepaintCalled           = 1 << 6,
         ColorFactor             = 1 << 7,
         Visible                 = 1 << 8,
         Input                   = 1 << 9,
@@ -36,43 +34,123 @@ LPRIVATE_CLASS(LView)
         ParentOpacity           = 1 << 15,
         ForceRequestNextFrame   = 1 << 16,
         PointerIsOver           = 1 << 17,
-        BlockPointer            = 1 << 18
+        BlockPointer            = 1 << 18,
+        Caching                 = 1 << 19
+    };
+
+    struct ViewOutputData;
+
+    /* Values calculated by a scene while rendering an output, used to prevent invoking heavy methods.
+     * Each output has its own, so scenes don't share any state between outputs while rendering */
+    struct ViewCache
+    {
+        ViewOutputData *voD;
+        LRect rect;
+        LRect localRect;
+        LRegion damage;
+        LRegion translucent;
+        LRegion opaque;
+        LRegion opaqueOverlay;
+
+        // Translucent regions of the views above, only calculated while damage coarsening is enabled
+        LRegion translucentOverlay;
+        Float32 opacity;
+        LSizeF scalingVector;
+        bool mapped = false;
+        bool occluded = false;
+        bool scalingEnabled;
+        bool isFullyTrans;
     };
 
     // This is used for detecting changes on a view since the last time it was drawn on a specific output
-    struct ViewThreadData
+    struct ViewOutputData
     {
+        ViewCache cache;
         LOutput *o = nullptr;
         Float32 prevOpacity = 1.f;
         UInt32 lastRenderedDamageId = 0;
         LRect prevRect;
         LRect prevLocalRect;
         bool changedOrder = true;
+
+        // Set by repaint() once the output was asked to repaint, cleared when the output draws the view
+        bool repaintCalled = false;
         bool prevMapped = false;
         LRegion prevClipping;
         LRGBAF prevColorFactor;
         bool prevColorFactorEnabled = false;
+
+        // Effective scaling vector, (1,1) if scaling is disabled
+        LSizeF prevScalingVector {1.f, 1.f};
+
+        /* State used to skip the region calculations of views that did not change
+         * since they were last drawn on this output, see LSceneViewPrivate::calcNewDamage() */
+        UInt32 changeSerial = 0;
+        UInt32 outputLayoutSerial = 0;
+        UInt32 surfaceCommitSerial = 0;
+        LRect outputsRect;
+        bool regionsValid = false;
+
+        // Last time requestNextFrame() was called for this output (ms)
+        UInt32 lastFrameRequestMs = 0;
+
+        // Opaque and translucent regions clipped to prevClipping
+        LRegion opaque;
+        LRegion translucent;
+
+        // Drawn from its layer in the current frame, see LSceneViewPrivate::calcCachedDamage()
+        bool layered = false;
+
+        /* State used to skip the whole subtree of views with children while neither they, their
+         * descendants nor the views above changed, see LSceneViewPrivate::skipSubtree() */
+        UInt32 subtreeSerial = 0;
+        const LFramebuffer *subtreeFb = nullptr;
+        bool subtreeClean = false;
+        bool subtreeCoarsening = false;
+        LRegion entryOpaque, exitOpaque;
+        LRegion entryTranslucent, exitTranslucent;
+        bool exitCovered = false;
+
+        // Extents of the clipping of the views in the subtree drawn in the last full calculation
+        LBox subtreeBounds = {0, 0, 0, 0};
+
+        // Skipped in the current frame, its caches are restored before drawing, see LSceneViewPrivate::restoreSubtree()
+        bool subtreeSkipped = false;
     };
 
-    // This is used to prevent invoking heavy methods
-    struct ViewCache
+    UInt32 state = Visible | ParentOffset | ParentOpacity | BlockPointer;
+
+    // Incremented by repaint() and setters of state scenes can't compare by value (e.g. clipping or regions)
+    UInt32 changeSerial = 1;
+
+    // Incremented by subtreeChanged() when the view or any of its descendants changed
+    UInt32 subtreeSerial = 1;
+
+    /* Values derived from the parent chain, cached to avoid walking it on every call.
+     * Setters clear the matching bits on the view and its descendants.
+     * Pos and mapped also depend on the virtual native*() methods (e.g. the role pos of
+     * a surface), so they are only reused within the same scene pass epoch
+     * (see LCompositorPrivate::viewCacheEpoch). Only read or written while holding the compositor lock */
+    enum LViewWorldBits : UChar8
     {
-        ViewThreadData *voD;
-        LRect rect;
-        LRect localRect;
-        LRegion damage;
-        LRegion translucent;
-        LRegion opaque;
-        LRegion opaqueOverlay;
-        Float32 opacity;
+        WorldScaling            = 1 << 0,
+        WorldOpacity            = 1 << 1,
+        WorldPos                = 1 << 2,
+        WorldMapped             = 1 << 3,
+        WorldAll                = WorldScaling | WorldOpacity | WorldPos | WorldMapped
+    };
+
+    struct WorldCache
+    {
+        UChar8 valid = 0;
+        UInt64 posEpoch = 0;
+        UInt64 mappedEpoch = 0;
+        LPoint pos;
         LSizeF scalingVector;
+        Float32 opacity = 1.f;
         bool mapped = false;
-        bool occluded = false;
-        bool scalingEnabled;
-        bool isFullyTrans;
     };
-    UInt32 state = Visible | ParentOffset | ParentOpacity | BlockPointer;
-    ViewCache cache;
+    WorldCache world;
 
     UInt32 type;
     LView *parent = nullptr;
@@ -85,17 +163,51 @@ LPRIVATE_CLASS(LView)
     LRect clippingRect;
     LPoint tmpPoint;
     LSize tmpSize;
-    LPointF tmpPointF;
 
-    std::map<std::thread::id,ViewThreadData>threadsMap;
+    // Hit-testing, see LScenePrivate::inputGrid
+    UInt32 inputOrder = 0;
+    UInt32 inputBuild = 0;
+    UInt32 pointerMoveSerial = 0;
+    LScene *pointerOverScene = nullptr;
+    std::list<LView*>::iterator pointerOverLink;
+
+    // Indexed by LOutputPrivate::slot
+    std::vector<ViewOutputData>outputsData;
+
+    /* Hidden scene view the view and its children are rendered into while caching is enabled
+     * and they did not change for a while, see LSceneViewPrivate::calcCachedDamage() */
+    LSceneView *layer = nullptr;
+    UInt32 layerStaticFrames = 0;
+
+    // Set when a child is removed, the layer may contain it
+    bool layerInvalid = false;
+
+    void releaseLayer(LView *view);
+
+    inline static void invalidateLayers(LView *view)
+    {
+        for (; view; view = view->imp()->parent)
+            if (view->imp()->layer)
+                view->imp()->layerInvalid = true;
+    }
     LScene *scene = nullptr;
     std::list<LView*>::iterator parentLink;
     std::list<LView*>::iterator compositorLink;
 
-    void removeThread(Louvre::LView *view, std::thread::id thread);
+    void removeOutput(Louvre::LView *view, LOutput *output);
     void markAsChangedOrder(bool includeChildren = true);
     void damageScene(LSceneView *s);
 
+    /* Grows the array to the number of slots at once, so it is only reallocated
+     * when an output is added and pointers to its elements remain valid while rendering */
+    inline ViewOutputData &outputData(UInt32 slot)
+    {
+        if (slot >= outputsData.size())
+            outputsData.resize(std::max((size_t)slot + 1, LCompositor::compositor()->imp()->outputSlots.size()));
+
+        return outputsData[slot];
+    }
+
     inline void removeFlag(UInt32 flag)
     {
         state &= ~flag;
@@ -119,6 +231,52 @@ LPRIVATE_CLASS(LView)
             removeFlag(flag);
     }
 
+    inline bool hasWorld(UChar8 bit, UInt64 epoch) const
+    {
+        if (!(world.valid & bit))
+            return false;
+
+        if (bit == WorldPos)
+            return world.posEpoch == epoch;
+
+        if (bit == WorldMapped)
+            return world.mappedEpoch == epoch;
+
+        return true;
+    }
+
+    /* Children only keep a bit while their parent keeps it, or when they depend
+     * on raw properties of the parent, which are invalidated from here */
+    inline static void invalidateWorld(LView *view, UChar8 bits)
+    {
+        if (bits & (WorldPos | WorldMapped | WorldScaling))
+            inputGeometryChanged();
+
+        invalidateWorldChildren(view, bits);
+    }
+
+    inline static void invalidateWorldChildren(LView *view, UChar8 bits)
+    {
+        view->imp()->world.valid &= ~bits;
+
+        for (LView *child : view->imp()->children)
+            if (child->imp()->world.valid & bits)
+                invalidateWorldChildren(child, bits);
+    }
+
+    // Called when the input bounds or z-order of a view may have changed, see LScenePrivate::inputGrid
+    inline static void inputGeometryChanged()
+    {
+        LCompositor::compositor()->imp()->viewInputSerial++;
+    }
+
+    // Called when a view may be drawn differently, scenes stop skipping the subtrees containing it
+    inline static void subtreeChanged(LView *view)
+    {
+        for (; view; view = view->imp()->parent)
+            view->imp()->subtreeSerial++;
+    }
+
     inline static void removeFlagWithChildren(LView *view, UInt32 flag)
     {
         view->imp()->removeFlag(flag);
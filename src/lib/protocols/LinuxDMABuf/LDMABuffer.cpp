@@ -36,7 +36,7 @@ LDMABuffer::~LDMABuffer()
     if (texture())
     {
         for (LSurface *s : compositor()->surfaces())
-            if (s->texture() == texture())
+            if (s->imp()->texture == texture())
             {
                 texture()->imp()->pendingDelete = true;
                 goto skipDeleteTexture;
@@ -80,6 +80,10 @@ RSurface::~RSurface()
     // Notify from client
     compositor()->destroySurfaceRequest(lSurface);
 
+    // Not worth uploading, setMapped() would flush it
+    if (lSurface->imp()->deferredUpload.buffer)
+        lSurface->imp()->releaseDeferredBuffer(true);
+
     // Unmap
     lSurface->imp()->setMapped(false);
 
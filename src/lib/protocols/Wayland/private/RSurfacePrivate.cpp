@@ -1,6 +1,7 @@
 #include <protocols/Wayland/private/RSurfacePrivate.h>
 #include <protocols/Wayland/RRegion.h>
 #include <protocols/Wayland/RCallback.h>
+#include <private/LCompositorPrivate.h>
 #include <private/LSurfacePrivate.h>
 #include <LBaseSurfaceRole.h>
 #include <LCompositor.h>
@@ -70,6 +71,15 @@ void RSurface::RSurfacePrivate::apply_commit(LSurface *surface, CommitOrigin ori
     if (surface->role() && !surface->role()->acceptCommitRequest(origin))
          return;
 
+    // Size, role pos and input region of its views, the input grid is only rebuilt if they change
+    const LSize prevSize = surface->size();
+    const LPoint prevRolePos = surface->rolePos();
+    bool inputChanged = false;
+
+    // Translucent and opaque regions may change, see LSceneViewPrivate::calcNewDamage()
+    surface->imp()->commitSerial++;
+    surface->imp()->viewsChanged(false);
+
     surface->imp()->bufferSizeChanged = false;
 
     /**************************************
@@ -94,6 +104,10 @@ void RSurface::RSurfacePrivate::apply_commit(LSurface *surface, CommitOrigin ori
         if (surface->imp()->current.buffer)
             surface->imp()->bufferReleased = false;
 
+        // Committed a null buffer, the deferred one would never be released
+        else if (surface->imp()->deferredUpload.buffer)
+            surface->imp()->flushDeferredUpload(true);
+
         surface->imp()->attached = false;
     }
 
@@ -137,6 +151,7 @@ void RSurface::RSurfacePrivate::apply_commit(LSurface *surface, CommitOrigin ori
             {
                 surface->imp()->currentInputRegion.clear();
                 surface->imp()->currentInputRegion.addRect(LRect(0, surface->size()));
+                inputChanged = true;
             }
         }
         else if (surface->imp()->inputRegionChanged || surface->imp()->bufferSizeChanged)
@@ -146,6 +161,7 @@ void RSurface::RSurfacePrivate::apply_commit(LSurface *surface, CommitOrigin ori
                                            0, 0, surface->size().w(), surface->size().h());
             surface->inputRegionChanged();
             surface->imp()->inputRegionChanged = false;
+            inputChanged = true;
         }
     }
     else
@@ -153,18 +169,44 @@ void RSurface::RSurfacePrivate::apply_commit(LSurface *surface, CommitOrigin ori
         /******************************************
          *********** CLEAR INPUT REGION ***********
          ******************************************/
+        inputChanged = !surface->imp()->currentInputRegion.empty();
         surface->imp()->currentInputRegion.clear();
     }
 
     /************************************
      ********** OPAQUE REGION ***********
      ************************************/
-    if (surface->imp()->opaqueRegionChanged || surface->imp()->bufferSizeChanged)
+    if (surface->imp()->opaqueRegionChanged || surface->imp()->bufferSizeChanged || surface->imp()->inferredOpaqueRegionChanged)
     {
         pixman_region32_intersect_rect(&surface->imp()->currentOpaqueRegion.m_region,
                                        &surface->imp()->pendingOpaqueRegion.m_region,
                                        0, 0, surface->size().w(), surface->size().h());
         surface->imp()->opaqueRegionChanged = false;
+        surface->imp()->inferredOpaqueRegionChanged = false;
+
+        /*****************************************
+         ******** INFERRED OPAQUE REGION *********
+         *****************************************/
+        if (!surface->imp()->inferredOpaqueRegionB.empty())
+        {
+            // Only surface pixels fully covered by opaque buffer pixels
+            const Int32 scale = surface->bufferScale();
+            Int32 n;
+            const LBox *box = surface->imp()->inferredOpaqueRegionB.boxes(&n);
+
+            for (Int32 i = 0; i < n; i++, box++)
+            {
+                const Int32 x1 = (box->x1 + scale - 1) / scale;
+                const Int32 y1 = (box->y1 + scale - 1) / scale;
+                const Int32 x2 = box->x2 / scale;
+                const Int32 y2 = box->y2 / scale;
+
+                if (x2 > x1 && y2 > y1)
+                    surface->imp()->currentOpaqueRegion.addRect(x1, y1, x2 - x1, y2 - y1);
+            }
+
+            surface->imp()->currentOpaqueRegion.clip(LRect(0, surface->size()));
+        }
 
         /*****************************************
          ********** TRANSLUCENT REGION ***********
@@ -184,6 +226,13 @@ void RSurface::RSurfacePrivate::apply_commit(LSurface *surface, CommitOrigin ori
         surface->imp()->pending.role->handleSurfaceCommit(origin);
     }
 
+    // Children move along with the surface
+    if (prevRolePos != surface->rolePos())
+        surface->imp()->viewsChanged(true);
+
+    if (inputChanged || prevSize != surface->size() || prevRolePos != surface->rolePos())
+        LCompositor::compositor()->imp()->viewInputSerial++;
+
     surface->imp()->bufferSizeChanged = false;
 }
 
@@ -0,0 +1,34 @@
+#include <protocols/WpSinglePixelBuffer/private/GWpSinglePixelBufferManagerPrivate.h>
+#include <private/LClientPrivate.h>
+
+using namespace Louvre::Protocols::WpSinglePixelBuffer;
+
+GWpSinglePixelBufferManager::GWpSinglePixelBufferManager
+(
+    wl_client *client,
+    const wl_interface *interface,
+    Int32 version,
+    UInt32 id,
+    const void *implementation,
+    wl_resource_destroy_func_t destroy
+)
+    :LResource
+    (
+        client,
+        interface,
+        version,
+        id,
+        implementation,
+        destroy
+    )
+{
+    m_imp = new GWpSinglePixelBufferManagerPrivate();
+    this->client()->imp()->wpSinglePixelBufferManagerGlobals.push_back(this);
+    imp()->clientLink = std::prev(this->client()->imp()->wpSinglePixelBufferManagerGlobals.end());
+}
+
+GWpSinglePixelBufferManager::~GWpSinglePixelBufferManager()
+{
+    client()->imp()->wpSinglePixelBufferManagerGlobals.erase(imp()->clientLink);
+    delete m_imp;
+}
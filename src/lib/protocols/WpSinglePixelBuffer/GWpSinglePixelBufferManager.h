@@ -0,0 +1,21 @@
+#ifndef GWPSINGLEPIXELBUFFERMANAGER_H
+#define GWPSINGLEPIXELBUFFERMANAGER_H
+
+#include <LResource.h>
+
+class Louvre::Protocols::WpSinglePixelBuffer::GWpSinglePixelBufferManager : public LResource
+{
+public:
+    GWpSinglePixelBufferManager(wl_client *client,
+                                const wl_interface *interface,
+                                Int32 version,
+                                UInt32 id,
+                                const void *implementation,
+                                wl_resource_destroy_func_t destroy);
+
+    ~GWpSinglePixelBufferManager();
+
+    LPRIVATE_IMP(GWpSinglePixelBufferManager)
+};
+
+#endif // GWPSINGLEPIXELBUFFERMANAGER_H
@@ -0,0 +1,56 @@
+#include <protocols/WpSinglePixelBuffer/private/RWpSinglePixelBufferPrivate.h>
+#include <protocols/WpSinglePixelBuffer/GWpSinglePixelBufferManager.h>
+
+using namespace Louvre;
+
+static struct wl_buffer_interface wl_single_pixel_buffer_implementation
+{
+    .destroy = &RWpSinglePixelBuffer::RWpSinglePixelBufferPrivate::destroy
+};
+
+bool isSinglePixelBuffer(wl_resource *buffer)
+{
+    return wl_resource_instance_of(buffer, &wl_buffer_interface, &wl_single_pixel_buffer_implementation);
+}
+
+RWpSinglePixelBuffer::RWpSinglePixelBuffer
+(
+    GWpSinglePixelBufferManager *gWpSinglePixelBufferManager,
+    UInt32 id,
+    UInt32 r,
+    UInt32 g,
+    UInt32 b,
+    UInt32 a
+)
+    :LResource
+    (
+        gWpSinglePixelBufferManager->client(),
+        &wl_buffer_interface,
+        1,
+        id,
+        &wl_single_pixel_buffer_implementation,
+        &RWpSinglePixelBuffer::RWpSinglePixelBufferPrivate::resource_destroy
+    )
+{
+    m_imp = new RWpSinglePixelBufferPrivate();
+    imp()->color.r = Float32(r) / Float32(UINT32_MAX);
+    imp()->color.g = Float32(g) / Float32(UINT32_MAX);
+    imp()->color.b = Float32(b) / Float32(UINT32_MAX);
+    imp()->color.a = Float32(a) / Float32(UINT32_MAX);
+    imp()->pixel = ((a >> 24) << 24) | ((r >> 24) << 16) | ((g >> 24) << 8) | (b >> 24);
+}
+
+RWpSinglePixelBuffer::~RWpSinglePixelBuffer()
+{
+    delete m_imp;
+}
+
+const LRGBAF &RWpSinglePixelBuffer::color() const
+{
+    return imp()->color;
+}
+
+UInt32 RWpSinglePixelBuffer::pixel() const
+{
+    return imp()->pixel;
+}
@@ -0,0 +1,31 @@
+#ifndef RWPSINGLEPIXELBUFFER_H
+#define RWPSINGLEPIXELBUFFER_H
+
+#include <LResource.h>
+
+using namespace Louvre::Protocols::WpSinglePixelBuffer;
+
+bool isSinglePixelBuffer(wl_resource *buffer);
+
+class Louvre::Protocols::WpSinglePixelBuffer::RWpSinglePixelBuffer : public LResource
+{
+public:
+    RWpSinglePixelBuffer(GWpSinglePixelBufferManager *gWpSinglePixelBufferManager,
+                         UInt32 id,
+                         UInt32 r,
+                         UInt32 g,
+                         UInt32 b,
+                         UInt32 a);
+
+    ~RWpSinglePixelBuffer();
+
+    // Premultiplied color
+    const LRGBAF &color() const;
+
+    // The color as a DRM_FORMAT_ARGB8888 pixel
+    UInt32 pixel() const;
+
+    LPRIVATE_IMP(RWpSinglePixelBuffer)
+};
+
+#endif // RWPSINGLEPIXELBUFFER_H
@@ -0,0 +1,39 @@
+#include <protocols/WpSinglePixelBuffer/private/GWpSinglePixelBufferManagerPrivate.h>
+#include <protocols/WpSinglePixelBuffer/RWpSinglePixelBuffer.h>
+#include <protocols/WpSinglePixelBuffer/single-pixel-buffer-v1.h>
+
+struct wp_single_pixel_buffer_manager_v1_interface single_pixel_buffer_manager_implementation =
+{
+    .destroy = &GWpSinglePixelBufferManager::GWpSinglePixelBufferManagerPrivate::destroy,
+    .create_u32_rgba_buffer = &GWpSinglePixelBufferManager::GWpSinglePixelBufferManagerPrivate::create_u32_rgba_buffer
+};
+
+void GWpSinglePixelBufferManager::GWpSinglePixelBufferManagerPrivate::bind(wl_client *client, void *data, UInt32 version, UInt32 id)
+{
+    L_UNUSED(data);
+    new GWpSinglePixelBufferManager(client,
+                                    &wp_single_pixel_buffer_manager_v1_interface,
+                                    version,
+                                    id,
+                                    &single_pixel_buffer_manager_implementation,
+                                    &GWpSinglePixelBufferManager::GWpSinglePixelBufferManagerPrivate::resource_destroy);
+}
+
+void GWpSinglePixelBufferManager::GWpSinglePixelBufferManagerPrivate::resource_destroy(wl_resource *resource)
+{
+    GWpSinglePixelBufferManager *gWpSinglePixelBufferManager = (GWpSinglePixelBufferManager*)wl_resource_get_user_data(resource);
+    delete gWpSinglePixelBufferManager;
+}
+
+void GWpSinglePixelBufferManager::GWpSinglePixelBufferManagerPrivate::destroy(wl_client *client, wl_resource *resource)
+{
+    L_UNUSED(client);
+    wl_resource_destroy(resource);
+}
+
+void GWpSinglePixelBufferManager::GWpSinglePixelBufferManagerPrivate::create_u32_rgba_buffer(wl_client *client, wl_resource *resource, UInt32 id, UInt32 r, UInt32 g, UInt32 b, UInt32 a)
+{
+    L_UNUSED(client);
+    GWpSinglePixelBufferManager *gWpSinglePixelBufferManager = (GWpSinglePixelBufferManager*)wl_resource_get_user_data(resource);
+    new RWpSinglePixelBuffer(gWpSinglePixelBufferManager, id, r, g, b, a);
+}
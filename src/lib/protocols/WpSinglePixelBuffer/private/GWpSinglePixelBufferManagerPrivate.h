@@ -0,0 +1,19 @@
+#ifndef GWPSINGLEPIXELBUFFERMANAGERPRIVATE_H
+#define GWPSINGLEPIXELBUFFERMANAGERPRIVATE_H
+
+#include <protocols/WpSinglePixelBuffer/GWpSinglePixelBufferManager.h>
+#include <protocols/WpSinglePixelBuffer/single-pixel-buffer-v1.h>
+
+using namespace Louvre::Protocols::WpSinglePixelBuffer;
+using namespace std;
+
+LPRIVATE_CLASS(GWpSinglePixelBufferManager)
+    static void bind(wl_client *client, void *data, UInt32 version, UInt32 id);
+    static void resource_destroy(wl_resource *resource);
+    static void destroy(wl_client *client, wl_resource *resource);
+    static void create_u32_rgba_buffer(wl_client *client, wl_resource *resource, UInt32 id, UInt32 r, UInt32 g, UInt32 b, UInt32 a);
+
+    list<GWpSinglePixelBufferManager*>::iterator clientLink;
+};
+
+#endif // GWPSINGLEPIXELBUFFERMANAGERPRIVATE_H
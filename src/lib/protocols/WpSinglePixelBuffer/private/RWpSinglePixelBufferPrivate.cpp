@@ -0,0 +1,13 @@
+#include <protocols/WpSinglePixelBuffer/private/RWpSinglePixelBufferPrivate.h>
+
+void RWpSinglePixelBuffer::RWpSinglePixelBufferPrivate::resource_destroy(wl_resource *resource)
+{
+    RWpSinglePixelBuffer *rWpSinglePixelBuffer = (RWpSinglePixelBuffer*)wl_resource_get_user_data(resource);
+    delete rWpSinglePixelBuffer;
+}
+
+void RWpSinglePixelBuffer::RWpSinglePixelBufferPrivate::destroy(wl_client *client, wl_resource *resource)
+{
+    L_UNUSED(client);
+    wl_resource_destroy(resource);
+}
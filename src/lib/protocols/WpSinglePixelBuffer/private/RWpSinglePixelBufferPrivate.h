@@ -0,0 +1,16 @@
+#ifndef RWPSINGLEPIXELBUFFERPRIVATE_H
+#define RWPSINGLEPIXELBUFFERPRIVATE_H
+
+#include <protocols/WpSinglePixelBuffer/RWpSinglePixelBuffer.h>
+
+using namespace Louvre::Protocols::WpSinglePixelBuffer;
+
+LPRIVATE_CLASS(RWpSinglePixelBuffer)
+    static void resource_destroy(wl_resource *resource);
+    static void destroy(wl_client *client, wl_resource *resource);
+
+    LRGBAF color;
+    UInt32 pixel = 0;
+};
+
+#endif // RWPSINGLEPIXELBUFFERPRIVATE_H